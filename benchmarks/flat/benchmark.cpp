@@ -0,0 +1,71 @@
+// measures how FlatIndex scales with threads
+//
+// run with
+// build/benchmark [rows] [dimensions] [queries]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/flat.hpp>
+#include <pgvector/vector.hpp>
+
+pgvector::VectorBatch<float> random_batch(size_t rows, size_t dimensions, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_real_distribution<float> dist{0, 1};
+
+    pgvector::VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows * dimensions; i++) {
+        batch.data()[i] = dist(prng);
+    }
+    return batch;
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t dimensions = argc > 2 ? std::stoul(argv[2]) : 128;
+    size_t num_queries = argc > 3 ? std::stoul(argv[3]) : 1000;
+    size_t k = 10;
+    size_t max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    pgvector::VectorBatch<float> embeddings = random_batch(rows, dimensions, 1);
+    pgvector::VectorBatch<float> queries = random_batch(num_queries, dimensions, 2);
+    std::vector<int64_t> ids;
+    ids.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        ids.push_back(static_cast<int64_t>(i));
+    }
+
+    std::vector<size_t> thread_counts;
+    for (size_t t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    std::cout << "threads,qps,speedup" << std::endl;
+    double base = 0;
+    for (auto threads : thread_counts) {
+        pgvector::FlatIndex<pgvector::Vector> index{dimensions, {.threads = threads}};
+        index.add(ids, embeddings);
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = index.search(queries, k);
+        double elapsed =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double qps = static_cast<double>(num_queries) / elapsed;
+        if (base == 0) {
+            base = qps;
+        }
+        std::cout << threads << "," << qps << "," << qps / base << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+// compares HnswIndex with brute force search
+//
+// run with
+// build/benchmark [rows] [dimensions] [queries]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/distance.hpp>
+#include <pgvector/hnsw.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/vector.hpp>
+
+std::vector<std::vector<float>> random_embeddings(size_t rows, size_t dimensions, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_real_distribution<float> dist{0, 1};
+
+    std::vector<std::vector<float>> embeddings;
+    embeddings.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        std::vector<float> embedding;
+        embedding.reserve(dimensions);
+        for (size_t j = 0; j < dimensions; j++) {
+            embedding.push_back(dist(prng));
+        }
+        embeddings.push_back(embedding);
+    }
+    return embeddings;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t dimensions = argc > 2 ? std::stoul(argv[2]) : 128;
+    size_t num_queries = argc > 3 ? std::stoul(argv[3]) : 1000;
+    size_t k = 10;
+    size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::vector<std::vector<float>> embeddings = random_embeddings(rows, dimensions, 1);
+    std::vector<std::vector<float>> queries = random_embeddings(num_queries, dimensions, 2);
+
+    // brute force
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<pgvector::Neighbor>> expected;
+    expected.reserve(queries.size());
+    for (const auto& query : queries) {
+        pgvector::TopK top{k};
+        for (size_t i = 0; i < embeddings.size(); i++) {
+            top.push(static_cast<int64_t>(i), pgvector::l2_distance(query, embeddings[i]));
+        }
+        expected.push_back(top.sorted());
+    }
+    double brute_force_time = seconds_since(start);
+    std::cout << "brute force: " << static_cast<double>(queries.size()) / brute_force_time << " QPS" << std::endl;
+
+    // build with all threads
+    start = std::chrono::steady_clock::now();
+    pgvector::HnswIndex<pgvector::Vector> index{dimensions, rows};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            for (size_t i = t; i < embeddings.size(); i += threads) {
+                index.add(static_cast<int64_t>(i), embeddings[i]);
+            }
+        });
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    double build_time = seconds_since(start);
+    std::cout << "build: " << build_time << " s with " << threads << " threads ("
+              << static_cast<double>(rows) / build_time << " rows/s)" << std::endl;
+
+    std::vector<std::unordered_set<int64_t>> expected_ids(queries.size());
+    for (size_t i = 0; i < queries.size(); i++) {
+        for (const auto& v : expected[i]) {
+            expected_ids[i].insert(v.id);
+        }
+    }
+
+    std::cout << "ef_search,recall@" << k << ",qps,speedup" << std::endl;
+    std::vector<std::vector<pgvector::Neighbor>> results(queries.size());
+    for (size_t ef_search : {10, 20, 40, 80, 160, 320}) {
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.size(); i++) {
+            results[i] = index.search(queries[i], k, ef_search);
+        }
+        double search_time = seconds_since(start);
+
+        size_t found = 0;
+        for (size_t i = 0; i < queries.size(); i++) {
+            for (const auto& v : results[i]) {
+                found += expected_ids[i].count(v.id);
+            }
+        }
+        double recall = static_cast<double>(found) / static_cast<double>(queries.size() * k);
+        std::cout << ef_search << "," << recall << "," << static_cast<double>(queries.size()) / search_time << ","
+                  << brute_force_time / search_time << std::endl;
+    }
+
+    return 0;
+}
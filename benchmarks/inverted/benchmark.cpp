@@ -0,0 +1,118 @@
+// measures InvertedIndex against brute-force sparse inner products
+//
+// run with
+// build/benchmark [rows] [queries]
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/flat.hpp>
+#include <pgvector/inverted.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/sparsevec.hpp>
+
+const int dimensions = 30522;
+
+// term ids follow a power law and weights are log-normal, like learned sparse encoders
+std::vector<pgvector::SparseVector> random_documents(size_t rows, size_t terms, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_real_distribution<double> uniform{0, 1};
+    std::lognormal_distribution<float> weight{-1, 0.8f};
+
+    std::vector<pgvector::SparseVector> documents;
+    documents.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        pgvector::SparseVectorBuilder builder{dimensions};
+        std::unordered_set<int> seen;
+        while (seen.size() < terms) {
+            int term = static_cast<int>(std::pow(dimensions, uniform(prng))) - 1;
+            if (seen.insert(term).second) {
+                builder.push_back(term, weight(prng));
+            }
+        }
+        documents.push_back(builder.build());
+    }
+    return documents;
+}
+
+// takes terms from a document so each query has relevant results
+std::vector<pgvector::SparseVector> random_queries(
+    const std::vector<pgvector::SparseVector>& documents,
+    size_t rows,
+    size_t terms,
+    uint64_t seed
+) {
+    std::mt19937_64 prng{seed};
+    std::uniform_int_distribution<size_t> pick{0, documents.size() - 1};
+    std::uniform_real_distribution<float> noise{0.5f, 1.5f};
+
+    std::vector<pgvector::SparseVector> queries;
+    queries.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        const pgvector::SparseVector& document = documents[pick(prng)];
+        pgvector::SparseVectorBuilder builder{dimensions};
+        for (size_t j = 0; j < document.indices().size(); j += document.indices().size() / terms) {
+            builder.push_back(document.indices()[j], document.values()[j] * noise(prng));
+        }
+        queries.push_back(builder.build());
+    }
+    return queries;
+}
+
+template<typename F>
+double seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t num_queries = argc > 2 ? std::stoul(argv[2]) : 200;
+    size_t k = 10;
+
+    std::vector<pgvector::SparseVector> documents = random_documents(rows, 120, 1);
+    std::vector<pgvector::SparseVector> queries = random_queries(documents, num_queries, 20, 2);
+
+    // one search thread so the comparison is per core
+    pgvector::FlatIndex<pgvector::SparseVector> flat{
+        dimensions, {.metric = pgvector::Metric::InnerProduct, .threads = 1}
+    };
+    flat.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        flat.add(static_cast<int64_t>(i), documents[i]);
+    }
+    std::vector<std::vector<pgvector::Neighbor>> expected;
+    double flat_time = seconds([&] { expected = flat.search(queries, k); });
+    double flat_qps = static_cast<double>(num_queries) / flat_time;
+
+    std::cout << "method,block_size,build_seconds,qps,speedup,exact" << std::endl;
+    std::cout << "flat,," << 0 << "," << flat_qps << "," << 1 << "," << 1 << std::endl;
+    for (size_t block_size : {32, 64, 128, 256}) {
+        pgvector::InvertedIndex index{dimensions, {.block_size = block_size}};
+        index.reserve(rows);
+        for (size_t i = 0; i < rows; i++) {
+            index.add(static_cast<int64_t>(i), documents[i]);
+        }
+        double build_time = seconds([&] { index.build(); });
+
+        std::vector<std::vector<pgvector::Neighbor>> actual(queries.size());
+        double search_time = seconds([&] {
+            for (size_t i = 0; i < queries.size(); i++) {
+                actual[i] = index.search(queries[i], k);
+            }
+        });
+        double qps = static_cast<double>(num_queries) / search_time;
+
+        std::cout << "inverted," << block_size << "," << build_time << "," << qps << ","
+                  << qps / flat_qps << "," << (actual == expected) << std::endl;
+    }
+    return 0;
+}
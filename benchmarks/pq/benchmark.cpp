@@ -0,0 +1,129 @@
+// measures compression, recall, and scan throughput of PqIndex against exact search
+//
+// run with
+// build/benchmark [rows] [queries] [dimensions]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/flat.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/pq.hpp>
+#include <pgvector/vector.hpp>
+
+// vectors around random centers, so neighbors are more meaningful than with uniform data
+pgvector::VectorBatch<float> random_data(size_t rows, size_t dimensions, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::normal_distribution<float> dist;
+    pgvector::VectorBatch<float> centers{dimensions, 1000};
+    for (size_t i = 0; i < centers.rows(); i++) {
+        for (auto& v : centers[i]) {
+            v = dist(prng);
+        }
+    }
+    std::uniform_int_distribution<size_t> pick{0, centers.rows() - 1};
+    pgvector::VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows; i++) {
+        std::span<const float> center = centers[pick(prng)];
+        for (size_t j = 0; j < dimensions; j++) {
+            batch[i][j] = center[j] + 0.5f * dist(prng);
+        }
+    }
+    return batch;
+}
+
+template<typename F>
+double seconds(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double recall(
+    const std::vector<std::vector<pgvector::Neighbor>>& actual,
+    const std::vector<std::vector<pgvector::Neighbor>>& expected
+) {
+    size_t found = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        std::unordered_set<int64_t> ids;
+        for (const auto& v : expected[i]) {
+            ids.insert(v.id);
+        }
+        for (const auto& v : actual[i]) {
+            found += ids.count(v.id);
+        }
+        total += expected[i].size();
+    }
+    return static_cast<double>(found) / static_cast<double>(total);
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 200000;
+    size_t num_queries = argc > 2 ? std::stoul(argv[2]) : 100;
+    size_t dimensions = argc > 3 ? std::stoul(argv[3]) : 128;
+    size_t k = 10;
+
+    pgvector::VectorBatch<float> data = random_data(rows, dimensions, 1);
+    pgvector::VectorBatch<float> queries = random_data(num_queries, dimensions, 2);
+    std::vector<int64_t> ids(rows);
+    for (size_t i = 0; i < rows; i++) {
+        ids[i] = static_cast<int64_t>(i);
+    }
+
+    // one search thread so throughput is per core
+    pgvector::FlatIndex<pgvector::Vector> flat{dimensions, {.threads = 1}};
+    flat.add(ids, data);
+    std::vector<std::vector<pgvector::Neighbor>> expected;
+    double flat_time = seconds([&] { expected = flat.search(queries, k); });
+    double flat_rate = static_cast<double>(rows * num_queries) / flat_time;
+
+    std::cout << "method,subvectors,bits,code_bytes,compression,train_seconds,"
+                 "recall,vectors_per_second,speedup"
+              << std::endl;
+    std::cout << "flat,,," << dimensions * sizeof(float) << ",1,0,1," << flat_rate << ",1"
+              << std::endl;
+
+    // train on a sample like the server does for IVFFlat
+    pgvector::VectorBatch<float> sample{dimensions};
+    for (size_t i = 0; i < std::min(rows, size_t{25000}); i++) {
+        sample.push_back(data[i]);
+    }
+
+    for (size_t bits : {4, 8}) {
+        for (size_t subvectors : {dimensions / 8, dimensions / 4, dimensions / 2}) {
+            pgvector::ProductQuantizer quantizer{
+                dimensions, {.subvectors = subvectors, .bits = bits}
+            };
+            double train_time = seconds([&] { quantizer.train(sample); });
+
+            pgvector::PqOptions options = quantizer.options();
+            options.threads = 1;
+            pgvector::PqIndex index{
+                pgvector::ProductQuantizer{dimensions, quantizer.centroids(), options}
+            };
+            index.add(ids, data);
+
+            std::vector<std::vector<pgvector::Neighbor>> actual;
+            double search_time = seconds([&] { actual = index.search(queries, k); });
+            double rate = static_cast<double>(rows * num_queries) / search_time;
+
+            size_t code_size = quantizer.code_size();
+            double compression =
+                static_cast<double>(dimensions * sizeof(float)) / static_cast<double>(code_size);
+            std::cout << "pq," << subvectors << "," << bits << "," << code_size << ","
+                      << compression << "," << train_time << "," << recall(actual, expected) << "," << rate
+                      << "," << rate / flat_rate << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+// measures text conversion for each type without a database
+//
+// run with
+// build/benchmark [--save=baseline.csv] [--compare=baseline.csv] [--threshold=10]
+//
+// --compare exits with status 1 if any case is slower than the baseline by more than
+// --threshold percent
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pgvector/halfvec.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+struct Result {
+    std::string name;
+    std::string op;
+    double ns_per_vector;
+    double bytes_per_second;
+};
+
+// runs f on every item until at least min_time has passed
+template<typename T, typename F>
+std::pair<double, double> measure(const std::vector<T>& items, F&& f) {
+    constexpr double min_time = 0.2;
+    size_t calls = 0;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        for (const auto& item : items) {
+            bytes += f(item);
+        }
+        calls += items.size();
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < min_time);
+    return {
+        elapsed * 1e9 / static_cast<double>(calls), static_cast<double>(bytes) / elapsed
+    };
+}
+
+template<typename T>
+void run_case(const std::string& name, const std::vector<T>& values, std::vector<Result>& results) {
+    std::vector<char> buf;
+    auto encode = measure(values, [&](const T& v) {
+        buf.resize(pqxx::size_buffer(v));
+        return pqxx::into_buf(std::span<char>{buf}, v);
+    });
+    results.push_back({name, "encode", encode.first, encode.second});
+
+    std::vector<std::string> texts;
+    texts.reserve(values.size());
+    for (const auto& v : values) {
+        texts.push_back(pqxx::to_string(v));
+    }
+    size_t checksum = 0;
+    auto decode = measure(texts, [&](const std::string& text) {
+        checksum += pqxx::from_string<T>(text) == values.front();
+        return text.size();
+    });
+    results.push_back({name, "decode", decode.first, decode.second});
+    if (checksum == static_cast<size_t>(-1)) {
+        std::cerr << checksum << std::endl;
+    }
+}
+
+std::vector<std::vector<float>> random_values(
+    size_t count,
+    size_t dimensions,
+    std::mt19937_64& prng
+) {
+    std::uniform_real_distribution<float> dist{-1, 1};
+    std::vector<std::vector<float>> values(count, std::vector<float>(dimensions));
+    for (auto& v : values) {
+        for (auto& x : v) {
+            x = dist(prng);
+        }
+    }
+    return values;
+}
+
+std::vector<Result> run_all() {
+    std::vector<Result> results;
+    std::mt19937_64 prng{1};
+    size_t count = 100;
+
+    for (size_t dimensions : {3, 128, 768, 1536}) {
+        auto values = random_values(count, dimensions, prng);
+
+        std::vector<pgvector::Vector> vectors;
+        std::vector<pgvector::HalfVector> half_vectors;
+        for (const auto& v : values) {
+            vectors.emplace_back(v);
+            std::vector<pgvector::Half> h;
+            for (auto x : v) {
+                h.push_back(static_cast<pgvector::Half>(x));
+            }
+            half_vectors.emplace_back(std::move(h));
+        }
+
+        run_case("vector(" + std::to_string(dimensions) + ")", vectors, results);
+        run_case("halfvec(" + std::to_string(dimensions) + ")", half_vectors, results);
+    }
+
+    int dimensions = 30522;
+    for (size_t nnz : {10, 100, 1000}) {
+        std::uniform_int_distribution<int> index_dist{0, dimensions - 1};
+        std::uniform_real_distribution<float> value_dist{0, 1};
+        std::vector<pgvector::SparseVector> vectors;
+        for (size_t i = 0; i < count; i++) {
+            std::unordered_map<int, float> map;
+            while (map.size() < nnz) {
+                map.insert({index_dist(prng), value_dist(prng)});
+            }
+            vectors.emplace_back(map, dimensions);
+        }
+        run_case(
+            "sparsevec(" + std::to_string(dimensions) + ") nnz=" + std::to_string(nnz), vectors,
+            results
+        );
+    }
+
+    return results;
+}
+
+std::string key(const std::string& name, const std::string& op) {
+    return name + "/" + op;
+}
+
+void save(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream file{path};
+    if (!file.is_open()) {
+        throw std::runtime_error{"Could not open file"};
+    }
+    file << "name,op,ns_per_vector,bytes_per_second" << std::endl;
+    for (const auto& r : results) {
+        file << r.name << "," << r.op << "," << r.ns_per_vector << "," << r.bytes_per_second
+             << std::endl;
+    }
+}
+
+std::map<std::string, double> load(const std::string& path) {
+    std::ifstream file{path};
+    if (!file.is_open()) {
+        throw std::runtime_error{"Could not open file"};
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields;
+        std::stringstream ss{line};
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 4) {
+            throw std::runtime_error{"Invalid baseline file"};
+        }
+        baseline[key(fields[0], fields[1])] = std::stod(fields[2]);
+    }
+    return baseline;
+}
+
+int main(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        size_t n = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || n == std::string::npos) {
+            std::cerr << "Expected --name=value, got " << arg << std::endl;
+            return 1;
+        }
+        args[arg.substr(2, n - 2)] = arg.substr(n + 1);
+    }
+    double threshold = args.contains("threshold") ? std::stod(args["threshold"]) : 10;
+
+    std::vector<Result> results = run_all();
+
+    std::cout << std::fixed << std::setprecision(1);
+    if (args.contains("compare")) {
+        std::map<std::string, double> baseline = load(args["compare"]);
+        bool regressed = false;
+        std::cout << "name,op,baseline_ns,ns,change_percent" << std::endl;
+        for (const auto& r : results) {
+            auto it = baseline.find(key(r.name, r.op));
+            if (it == baseline.end()) {
+                std::cout << r.name << "," << r.op << ",," << r.ns_per_vector << "," << std::endl;
+                continue;
+            }
+            double change = (r.ns_per_vector / it->second - 1) * 100;
+            regressed |= change > threshold;
+            std::cout << r.name << "," << r.op << "," << it->second << "," << r.ns_per_vector
+                      << "," << change << std::endl;
+        }
+        if (regressed) {
+            std::cerr << "Slower than baseline by more than " << threshold << "%" << std::endl;
+            return 1;
+        }
+    } else {
+        std::cout << "name,op,ns_per_vector,mb_per_second" << std::endl;
+        for (const auto& r : results) {
+            std::cout << r.name << "," << r.op << "," << r.ns_per_vector << ","
+                      << r.bytes_per_second / 1e6 << std::endl;
+        }
+    }
+
+    if (args.contains("save")) {
+        save(args["save"], results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+// measures how pruning sparse vectors trades non-zero elements for recall
+//
+// run with
+// build/benchmark [rows] [queries]
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/flat.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/prune.hpp>
+#include <pgvector/sparsevec.hpp>
+
+const int dimensions = 30522;
+
+// term ids follow a power law and weights are log-normal, like learned sparse encoders
+std::vector<pgvector::SparseVector> random_documents(size_t rows, size_t terms, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_real_distribution<double> uniform{0, 1};
+    std::lognormal_distribution<float> weight{-1, 0.8f};
+
+    std::vector<pgvector::SparseVector> documents;
+    documents.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        pgvector::SparseVectorBuilder builder{dimensions};
+        std::unordered_set<int> seen;
+        while (seen.size() < terms) {
+            int term = static_cast<int>(std::pow(dimensions, uniform(prng))) - 1;
+            if (seen.insert(term).second) {
+                builder.push_back(term, weight(prng));
+            }
+        }
+        documents.push_back(builder.build());
+    }
+    return documents;
+}
+
+// takes terms from a document so each query has relevant results
+std::vector<pgvector::SparseVector> random_queries(
+    const std::vector<pgvector::SparseVector>& documents,
+    size_t rows,
+    size_t terms,
+    uint64_t seed
+) {
+    std::mt19937_64 prng{seed};
+    std::uniform_int_distribution<size_t> pick{0, documents.size() - 1};
+    std::uniform_real_distribution<float> noise{0.5f, 1.5f};
+
+    std::vector<pgvector::SparseVector> queries;
+    queries.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        const pgvector::SparseVector& document = documents[pick(prng)];
+        pgvector::SparseVectorBuilder builder{dimensions};
+        for (size_t j = 0; j < document.indices().size(); j += document.indices().size() / terms) {
+            builder.push_back(document.indices()[j], document.values()[j] * noise(prng));
+        }
+        queries.push_back(builder.build());
+    }
+    return queries;
+}
+
+std::vector<std::vector<pgvector::Neighbor>> search(
+    const std::vector<pgvector::SparseVector>& documents,
+    const std::vector<pgvector::SparseVector>& queries,
+    size_t k
+) {
+    pgvector::FlatIndex<pgvector::SparseVector> index{
+        dimensions, {.metric = pgvector::Metric::InnerProduct}
+    };
+    index.reserve(documents.size());
+    for (size_t i = 0; i < documents.size(); i++) {
+        index.add(static_cast<int64_t>(i), documents[i]);
+    }
+    return index.search(queries, k);
+}
+
+double recall(
+    const std::vector<std::vector<pgvector::Neighbor>>& expected,
+    const std::vector<std::vector<pgvector::Neighbor>>& actual
+) {
+    size_t found = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < expected.size(); i++) {
+        std::unordered_set<int64_t> ids;
+        for (const auto& v : expected[i]) {
+            ids.insert(v.id);
+        }
+        for (const auto& v : actual[i]) {
+            found += ids.count(v.id);
+        }
+        total += expected[i].size();
+    }
+    return static_cast<double>(found) / static_cast<double>(total);
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t num_queries = argc > 2 ? std::stoul(argv[2]) : 200;
+    size_t k = 10;
+
+    std::vector<pgvector::SparseVector> documents = random_documents(rows, 200, 1);
+    std::vector<pgvector::SparseVector> queries = random_queries(documents, num_queries, 20, 2);
+    auto expected = search(documents, queries, k);
+
+    size_t nnz = 0;
+    for (const auto& v : documents) {
+        nnz += v.indices().size();
+    }
+
+    using Prune = std::function<pgvector::SparseVector(const pgvector::SparseVector&)>;
+    auto top_k = [](size_t n) -> Prune {
+        return [n](const auto& v) { return pgvector::prune_top_k(v, n); };
+    };
+    auto mass = [](double fraction) -> Prune {
+        return [fraction](const auto& v) { return pgvector::prune_mass(v, fraction); };
+    };
+    auto threshold = [](float t) -> Prune {
+        return [t](const auto& v) { return pgvector::prune_threshold(v, t); };
+    };
+    std::vector<std::pair<std::string, Prune>> methods{
+        {"top_k,128", top_k(128)},
+        {"top_k,64", top_k(64)},
+        {"top_k,32", top_k(32)},
+        {"mass,0.9", mass(0.9)},
+        {"mass,0.7", mass(0.7)},
+        {"mass,0.5", mass(0.5)},
+        {"threshold,0.2", threshold(0.2f)},
+        {"threshold,0.4", threshold(0.4f)},
+        {"threshold,0.8", threshold(0.8f)},
+    };
+
+    std::cout << "method,parameter,nnz_per_vector,nnz_reduction,recall" << std::endl;
+    for (const auto& [name, prune] : methods) {
+        std::vector<pgvector::SparseVector> pruned;
+        pruned.reserve(documents.size());
+        size_t pruned_nnz = 0;
+        for (const auto& v : documents) {
+            pruned.push_back(prune(v));
+            pruned_nnz += pruned.back().indices().size();
+        }
+        auto actual = search(pruned, queries, k);
+
+        std::cout << name << ","
+                  << static_cast<double>(pruned_nnz) / static_cast<double>(documents.size())
+                  << "," << 1 - static_cast<double>(pruned_nnz) / static_cast<double>(nnz) << ","
+                  << recall(expected, actual) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+// sweeps search parameters for HNSW and IVFFlat indexes and reports recall and latency as CSV
+//
+// run with
+// createdb pgvector_example
+// build/benchmark [--rows=100000] [--dimensions=128] [--queries=1000] [--k=10] [--metric=l2]
+//                 [--base=base.fvecs] [--query=query.fvecs] [--m=16] [--ef-construction=64]
+//                 [--lists=100]
+//
+// with fvecs files, --rows and --queries limit the number of vectors read
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/flat.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/vecs.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+struct Config {
+    size_t rows = 100000;
+    size_t dimensions = 128;
+    size_t queries = 1000;
+    size_t k = 10;
+    std::string metric = "l2";
+    std::string base;
+    std::string query;
+    size_t m = 16;
+    size_t ef_construction = 64;
+    size_t lists = 0;
+};
+
+Config parse_args(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg{argv[i]};
+        size_t n = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || n == std::string::npos) {
+            throw std::invalid_argument{"Expected --name=value, got " + arg};
+        }
+        args[arg.substr(2, n - 2)] = arg.substr(n + 1);
+    }
+
+    Config config;
+    for (const auto& [name, value] : args) {
+        if (name == "rows") {
+            config.rows = std::stoul(value);
+        } else if (name == "dimensions") {
+            config.dimensions = std::stoul(value);
+        } else if (name == "queries") {
+            config.queries = std::stoul(value);
+        } else if (name == "k") {
+            config.k = std::stoul(value);
+        } else if (name == "metric") {
+            config.metric = value;
+        } else if (name == "base") {
+            config.base = value;
+        } else if (name == "query") {
+            config.query = value;
+        } else if (name == "m") {
+            config.m = std::stoul(value);
+        } else if (name == "ef-construction") {
+            config.ef_construction = std::stoul(value);
+        } else if (name == "lists") {
+            config.lists = std::stoul(value);
+        } else {
+            throw std::invalid_argument{"Unknown option --" + name};
+        }
+    }
+    return config;
+}
+
+pgvector::VectorBatch<float> random_batch(size_t rows, size_t dimensions, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_real_distribution<float> dist{0, 1};
+
+    pgvector::VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows * dimensions; i++) {
+        batch.data()[i] = dist(prng);
+    }
+    return batch;
+}
+
+pgvector::VectorBatch<float> read_fvecs(const std::string& path, size_t limit) {
+    pgvector::FvecsFile file{path};
+    if (file.empty()) {
+        throw std::runtime_error{"Empty fvecs file"};
+    }
+
+    pgvector::VectorBatch<float> batch{file.dimensions()};
+    size_t rows = std::min(file.rows(), limit);
+    batch.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        batch.push_back(file[i]);
+    }
+    return batch;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p) {
+    std::ranges::sort(values);
+    size_t i = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    return values.at(i);
+}
+
+int main(int argc, char* argv[]) {
+    Config config = parse_args(argc, argv);
+
+    std::map<std::string, std::pair<pgvector::Metric, std::string>> metrics{
+        {"l2", {pgvector::Metric::L2, "<->"}},
+        {"ip", {pgvector::Metric::InnerProduct, "<#>"}},
+        {"cosine", {pgvector::Metric::Cosine, "<=>"}}
+    };
+    auto metric = metrics.find(config.metric);
+    if (metric == metrics.end()) {
+        std::cerr << "Unknown metric " << config.metric << std::endl;
+        return 1;
+    }
+    auto [metric_type, op] = metric->second;
+    std::string opclass = "vector_" + config.metric + "_ops";
+
+    // load dataset
+    pgvector::VectorBatch<float> base = config.base.empty()
+        ? random_batch(config.rows, config.dimensions, 1)
+        : read_fvecs(config.base, config.rows);
+    pgvector::VectorBatch<float> queries = config.query.empty()
+        ? random_batch(config.queries, base.dimensions(), 2)
+        : read_fvecs(config.query, config.queries);
+    size_t rows = base.rows();
+    size_t dimensions = base.dimensions();
+    size_t k = config.k;
+    if (queries.dimensions() != dimensions) {
+        std::cerr << "Base and query dimensions do not match" << std::endl;
+        return 1;
+    }
+    std::cerr << "Loaded " << rows << " rows and " << queries.rows() << " queries" << std::endl;
+
+    // compute ground truth locally
+    std::vector<int64_t> ids;
+    ids.reserve(rows);
+    for (size_t i = 0; i < rows; i++) {
+        ids.push_back(static_cast<int64_t>(i));
+    }
+    pgvector::FlatIndex<pgvector::Vector> flat{dimensions, {.metric = metric_type}};
+    flat.add(ids, base);
+    std::vector<std::vector<pgvector::Neighbor>> expected = flat.search(queries, k);
+    std::cerr << "Computed ground truth" << std::endl;
+
+    // load table
+    pqxx::connection conn{"dbname=pgvector_example"};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
+    tx.exec("DROP TABLE IF EXISTS benchmark_items");
+    tx.exec(
+        "CREATE TABLE benchmark_items (id bigint, embedding vector(" + std::to_string(dimensions)
+        + "))"
+    );
+    pqxx::stream_to stream = pqxx::stream_to::table(tx, {"benchmark_items"}, {"id", "embedding"});
+    for (size_t i = 0; i < rows; i++) {
+        stream.write_values(ids[i], pgvector::Vector{base.row(i)});
+    }
+    stream.complete();
+    tx.exec("ANALYZE benchmark_items");
+    std::cerr << "Loaded table" << std::endl;
+
+    std::string sql = "SELECT id FROM benchmark_items ORDER BY embedding " + op + " $1 LIMIT $2";
+    auto run = [&](
+                   const std::string& index,
+                   const std::string& build_params,
+                   double build_time,
+                   const std::string& param,
+                   size_t value
+               ) {
+        std::vector<double> latencies;
+        latencies.reserve(queries.rows());
+        size_t found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < queries.rows(); i++) {
+            auto query_start = std::chrono::steady_clock::now();
+            pqxx::result result = tx.exec(sql, pqxx::params{pgvector::Vector{queries.row(i)}, k});
+            latencies.push_back(seconds_since(query_start) * 1000);
+
+            std::unordered_set<int64_t> truth;
+            for (const auto& v : expected[i]) {
+                truth.insert(v.id);
+            }
+            for (const auto& row : result) {
+                found += truth.count(row[0].as<int64_t>());
+            }
+        }
+        double elapsed = seconds_since(start);
+
+        double mean = 0;
+        for (auto v : latencies) {
+            mean += v;
+        }
+        mean /= static_cast<double>(latencies.size());
+        double recall = static_cast<double>(found) / static_cast<double>(queries.rows() * k);
+
+        std::cout << index << "," << build_params << "," << build_time << "," << param << ","
+                  << value << "," << recall << "," << mean << "," << percentile(latencies, 0.99)
+                  << "," << static_cast<double>(queries.rows()) / elapsed << std::endl;
+    };
+
+    std::cout << "index,build_params,build_seconds,param,value,recall,mean_ms,p99_ms,qps"
+              << std::endl;
+
+    auto build = [&](const std::string& sql) {
+        tx.exec("DROP INDEX IF EXISTS benchmark_items_embedding_idx");
+        auto start = std::chrono::steady_clock::now();
+        tx.exec(sql);
+        return seconds_since(start);
+    };
+
+    // HNSW
+    std::string hnsw_params = "m=" + std::to_string(config.m)
+        + " ef_construction=" + std::to_string(config.ef_construction);
+    double hnsw_time = build(
+        "CREATE INDEX benchmark_items_embedding_idx ON benchmark_items USING hnsw (embedding "
+        + opclass + ") WITH (m = " + std::to_string(config.m)
+        + ", ef_construction = " + std::to_string(config.ef_construction) + ")"
+    );
+    for (size_t ef_search : {10, 20, 40, 80, 160, 320, 640}) {
+        if (ef_search < k) {
+            continue;
+        }
+        tx.exec("SET hnsw.ef_search = " + std::to_string(ef_search));
+        run("hnsw", hnsw_params, hnsw_time, "ef_search", ef_search);
+    }
+
+    // IVFFlat
+    size_t lists = config.lists > 0 ? config.lists : std::max(rows / 1000, static_cast<size_t>(1));
+    double ivfflat_time = build(
+        "CREATE INDEX benchmark_items_embedding_idx ON benchmark_items USING ivfflat (embedding "
+        + opclass + ") WITH (lists = " + std::to_string(lists) + ")"
+    );
+    for (size_t probes = 1; probes <= lists; probes *= 2) {
+        tx.exec("SET ivfflat.probes = " + std::to_string(probes));
+        run("ivfflat", "lists=" + std::to_string(lists), ivfflat_time, "probes", probes);
+    }
+
+    tx.exec("DROP TABLE benchmark_items");
+
+    return 0;
+}
@@ -8,6 +8,7 @@
 
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
+#include <pgvector/hybrid.hpp>
 #include <pgvector/pqxx.hpp>
 #include <pqxx/pqxx>
 
@@ -66,36 +67,21 @@ int main() {
         );
     }
 
-    std::string sql{R"(
-    WITH semantic_search AS (
-        SELECT id, RANK () OVER (ORDER BY embedding <=> $2) AS rank
-        FROM documents
-        ORDER BY embedding <=> $2
-        LIMIT 20
-    ),
-    keyword_search AS (
-        SELECT id, RANK () OVER (ORDER BY ts_rank_cd(to_tsvector('english', content), query) DESC)
-        FROM documents, plainto_tsquery('english', $1) query
-        WHERE to_tsvector('english', content) @@ query
-        ORDER BY ts_rank_cd(to_tsvector('english', content), query) DESC
-        LIMIT 20
-    )
-    SELECT
-        COALESCE(semantic_search.id, keyword_search.id) AS id,
-        COALESCE(1.0 / ($3 + semantic_search.rank), 0.0) +
-        COALESCE(1.0 / ($3 + keyword_search.rank), 0.0) AS score
-    FROM semantic_search
-    FULL OUTER JOIN keyword_search ON semantic_search.id = keyword_search.id
-    ORDER BY score DESC
-    LIMIT 5
-    )"};
+    // run semantic and keyword searches concurrently and fuse with Reciprocal Rank Fusion
     std::string query{"growling bear"};
     std::vector<float> query_embedding = embed({query}, "search_query")[0];
-    double k = 60;
-    pqxx::result result = tx.exec(sql, pqxx::params{query, pgvector::Vector{query_embedding}, k});
-    for (const auto& row : result) {
-        std::cout << "document: " << row[0].as<std::string>()
-                  << ", RRF score: " << row[1].as<double>() << std::endl;
+    pgvector::HybridSearch search{"dbname=pgvector_example", {.rrf_k = 60}};
+    std::vector<pgvector::HybridResult> results = search.search(
+        {
+            pgvector::semantic_retriever(
+                "documents", "embedding", pgvector::Vector{query_embedding}, 20
+            ),
+            pgvector::keyword_retriever("documents", "content", query, 20),
+        },
+        5
+    );
+    for (const auto& v : results) {
+        std::cout << "document: " << v.id << ", RRF score: " << v.score << std::endl;
     }
 
     return 0;
@@ -2,6 +2,7 @@
 #include <random>
 #include <vector>
 
+#include <pgvector/loader.hpp>
 #include <pgvector/pqxx.hpp>
 #include <pqxx/pqxx>
 
@@ -31,32 +32,34 @@ int main() {
     tx.exec("DROP TABLE IF EXISTS items");
     tx.exec("CREATE TABLE items (id bigserial, embedding vector(128))");
 
-    // load data
+    // load data over multiple connections
     // libpqxx does not support binary COPY
     std::cout << "Loading " << rows << " rows" << std::endl;
-    pqxx::stream_to stream = pqxx::stream_to::table(tx, {"items"}, {"embedding"});
+    pgvector::BulkLoader<pgvector::Vector> loader{
+        "dbname=pgvector_example", "items", {"embedding"}, {.connections = 4}
+    };
     for (size_t i = 0; i < embeddings.size(); i++) {
         // show progress
         if (i % 10000 == 0) {
             std::cout << '.' << std::flush;
         }
 
-        stream.write_values(pgvector::Vector{embeddings[i]});
+        loader.write_values(pgvector::Vector{embeddings[i]});
     }
-    stream.complete();
-    std::cout << std::endl << "Success!" << std::endl;
 
     // create any indexes *after* loading initial data (skipping for this example)
     bool create_index = false;
     if (create_index) {
-        std::cout << "Creating index" << std::endl;
-        tx.exec("SET maintenance_work_mem = '8GB'");
-        tx.exec("SET max_parallel_maintenance_workers = 7");
-        tx.exec("CREATE INDEX ON items USING hnsw (embedding vector_cosine_ops)");
+        loader.after_load("SET maintenance_work_mem = '8GB'");
+        loader.after_load("SET max_parallel_maintenance_workers = 7");
+        loader.after_load("CREATE INDEX ON items USING hnsw (embedding vector_cosine_ops)");
     }
 
     // update planner statistics for good measure
-    tx.exec("ANALYZE items");
+    loader.after_load("ANALYZE items");
+
+    pgvector::LoaderStats stats = loader.complete();
+    std::cout << std::endl << "Success! " << stats.rows_per_second() << " rows/sec" << std::endl;
 
     return 0;
 }
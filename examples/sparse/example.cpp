@@ -8,7 +8,6 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <cpr/cpr.h>
@@ -32,11 +31,12 @@ std::vector<pgvector::SparseVector> embed(const std::vector<std::string>& inputs
 
     std::vector<pgvector::SparseVector> embeddings;
     for (const auto& item : response) {
-        std::unordered_map<int, float> map;
+        pgvector::SparseVectorBuilder builder{30522};
+        builder.reserve(item.size());
         for (const auto& e : item) {
-            map.insert({e["index"], e["value"]});
+            builder.push_back(e["index"], e["value"]);
         }
-        embeddings.emplace_back(pgvector::SparseVector{map, 30522});
+        embeddings.push_back(builder.build());
     }
     return embeddings;
 }
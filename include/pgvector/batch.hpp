@@ -0,0 +1,134 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pgvector {
+/// @cond
+namespace detail {
+// aligns allocations to cache lines so rows can be loaded efficiently
+template<typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    static constexpr std::align_val_t alignment{64};
+
+    AlignedAllocator() noexcept = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), alignment));
+    }
+
+    void deallocate(T* p, size_t) noexcept {
+        ::operator delete(p, alignment);
+    }
+
+    template<typename U>
+    friend bool operator==(const AlignedAllocator&, const AlignedAllocator<U>&) noexcept {
+        return true;
+    }
+};
+} // namespace detail
+/// @endcond
+
+/// A batch of vectors with the same number of dimensions, stored contiguously in row-major
+/// order.
+template<typename T>
+class VectorBatch {
+  public:
+    /// The element type.
+    using value_type = T;
+
+    /// Creates an empty batch.
+    explicit VectorBatch(size_t dimensions) : dimensions_{dimensions} {}
+
+    /// Creates a batch of zero vectors.
+    VectorBatch(size_t dimensions, size_t rows) :
+        dimensions_{dimensions},
+        data_(dimensions * rows) {}
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the number of vectors.
+    size_t rows() const {
+        return dimensions_ == 0 ? 0 : data_.size() / dimensions_;
+    }
+
+    /// Returns whether the batch is empty.
+    bool empty() const {
+        return data_.empty();
+    }
+
+    /// Reserves space for a number of vectors.
+    void reserve(size_t rows) {
+        data_.reserve(rows * dimensions_);
+    }
+
+    /// Removes all vectors.
+    void clear() {
+        data_.clear();
+    }
+
+    /// Adds a vector.
+    void push_back(std::span<const T> value) {
+        if (value.size() != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.size())
+            };
+        }
+        data_.insert(data_.end(), value.begin(), value.end());
+    }
+
+    /// Returns a vector.
+    std::span<const T> row(size_t i) const {
+        return {data_.data() + i * dimensions_, dimensions_};
+    }
+
+    /// Returns a vector.
+    std::span<T> row(size_t i) {
+        return {data_.data() + i * dimensions_, dimensions_};
+    }
+
+    /// Returns a vector.
+    std::span<const T> operator[](size_t i) const {
+        return row(i);
+    }
+
+    /// Returns a vector.
+    std::span<T> operator[](size_t i) {
+        return row(i);
+    }
+
+    /// Returns the elements of all vectors.
+    const T* data() const {
+        return data_.data();
+    }
+
+    /// Returns the elements of all vectors.
+    T* data() {
+        return data_.data();
+    }
+
+  private:
+    size_t dimensions_;
+    std::vector<T, detail::AlignedAllocator<T>> data_;
+};
+} // namespace pgvector
@@ -0,0 +1,45 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pgvector {
+/// Packs a bit string like `"101"` into bytes, with the first bit in the high bit of the first
+/// byte like the server.
+inline std::vector<uint8_t> pack_bits(std::string_view value) {
+    std::vector<uint8_t> bytes((value.size() + 7) / 8);
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '1') {
+            bytes[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+        } else if (value[i] != '0') {
+            throw std::invalid_argument{"invalid bit string"};
+        }
+    }
+    return bytes;
+}
+
+/// Unpacks the first `dimensions` bits into a bit string like `"101"`.
+inline std::string unpack_bits(std::span<const uint8_t> bytes, size_t dimensions) {
+    if (dimensions > bytes.size() * 8) {
+        throw std::invalid_argument{"not enough bytes for dimensions"};
+    }
+    std::string value(dimensions, '0');
+    for (size_t i = 0; i < dimensions; i++) {
+        if (bytes[i / 8] & (0x80 >> (i % 8))) {
+            value[i] = '1';
+        }
+    }
+    return value;
+}
+} // namespace pgvector
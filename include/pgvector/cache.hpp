@@ -0,0 +1,305 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "hash.hpp"
+#include "neighbor.hpp"
+#include "sparsevec.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Query cache options.
+struct CacheOptions {
+    /// The max size of all entries in bytes.
+    size_t max_bytes = 64 * 1024 * 1024;
+
+    /// How long entries are kept, or zero to keep them until evicted.
+    std::chrono::steady_clock::duration ttl = std::chrono::minutes{1};
+
+    /// The number of independently locked shards.
+    size_t shards = 16;
+};
+
+/// The parts of a search besides the query vector that determine its results.
+struct QueryKey {
+    /// The distance metric.
+    Metric metric = Metric::L2;
+
+    /// The number of neighbors.
+    size_t k = 10;
+
+    /// The filter, like a `WHERE` clause and its parameters.
+    std::string_view filter = {};
+
+    /// The search profile, like `"hnsw.ef_search=100"`.
+    std::string_view profile = {};
+};
+
+/// Query cache statistics.
+struct CacheStats {
+    /// The number of lookups that found an entry.
+    uint64_t hits = 0;
+
+    /// The number of lookups that did not find an entry.
+    uint64_t misses = 0;
+
+    /// The number of entries removed to stay under the size limit.
+    uint64_t evictions = 0;
+
+    /// The search time saved by hits.
+    std::chrono::nanoseconds saved{0};
+
+    /// Returns the fraction of lookups that found an entry.
+    double hit_ratio() const {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(total);
+    }
+};
+
+/// An in-process LRU cache for search results.
+///
+/// Keys are the exact bytes of the query vector and `QueryKey`, so only identical searches
+/// hit. Entries are split across shards by hash so threads rarely wait on each other.
+class QueryCache {
+  public:
+    /// Creates an empty cache.
+    explicit QueryCache(const CacheOptions& options = {}) :
+        options_{options},
+        shards_(options.shards == 0 ? 1 : options.shards) {
+        for (auto& s : shards_) {
+            s = std::make_unique<Shard>();
+        }
+    }
+
+    /// Returns the options.
+    const CacheOptions& options() const {
+        return options_;
+    }
+
+    /// Returns the cached neighbors for a search, if present.
+    template<typename V>
+    std::optional<std::vector<Neighbor>> get(const V& query, const QueryKey& key) {
+        std::string bytes = encode_key(query, key);
+        uint64_t hash = detail::hash_bytes(bytes);
+        Shard& s = shard(hash);
+        auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard lock{s.mutex};
+        auto it = s.map.find(hash);
+        if (it == s.map.end() || it->second->key != bytes) {
+            s.stats.misses++;
+            return std::nullopt;
+        }
+        if (it->second->expires_at && *it->second->expires_at <= now) {
+            erase(s, it->second);
+            s.stats.misses++;
+            return std::nullopt;
+        }
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        s.stats.hits++;
+        s.stats.saved += it->second->latency;
+        return it->second->neighbors;
+    }
+
+    /// Caches the neighbors for a search, along with how long the search took.
+    template<typename V>
+    void put(
+        const V& query,
+        const QueryKey& key,
+        std::vector<Neighbor> neighbors,
+        std::chrono::nanoseconds latency = {}
+    ) {
+        std::string bytes = encode_key(query, key);
+        uint64_t hash = detail::hash_bytes(bytes);
+        size_t size = entry_size(bytes, neighbors);
+        size_t limit = options_.max_bytes / shards_.size();
+        Shard& s = shard(hash);
+
+        std::optional<std::chrono::steady_clock::time_point> expires_at;
+        if (options_.ttl.count() > 0) {
+            expires_at = std::chrono::steady_clock::now() + options_.ttl;
+        }
+
+        std::lock_guard lock{s.mutex};
+        auto it = s.map.find(hash);
+        if (it != s.map.end()) {
+            erase(s, it->second);
+        }
+        if (size > limit) {
+            return;
+        }
+        while (s.bytes + size > limit) {
+            erase(s, std::prev(s.lru.end()));
+            s.stats.evictions++;
+        }
+        s.lru.push_front({std::move(bytes), hash, std::move(neighbors), latency, expires_at, size});
+        s.map.emplace(hash, s.lru.begin());
+        s.bytes += size;
+    }
+
+    /// Returns cached neighbors, or calls `search_fn()` and caches its result.
+    template<typename V, typename F>
+    std::vector<Neighbor> search(const V& query, const QueryKey& key, F&& search_fn) {
+        if (auto cached = get(query, key)) {
+            return std::move(*cached);
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Neighbor> neighbors = search_fn();
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start
+        );
+        put(query, key, neighbors, latency);
+        return neighbors;
+    }
+
+    /// Returns the number of entries.
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& s : shards_) {
+            std::lock_guard lock{s->mutex};
+            n += s->lru.size();
+        }
+        return n;
+    }
+
+    /// Returns the approximate memory used by entries in bytes.
+    size_t bytes() const {
+        size_t n = 0;
+        for (const auto& s : shards_) {
+            std::lock_guard lock{s->mutex};
+            n += s->bytes;
+        }
+        return n;
+    }
+
+    /// Returns the statistics.
+    CacheStats stats() const {
+        CacheStats result;
+        for (const auto& s : shards_) {
+            std::lock_guard lock{s->mutex};
+            result.hits += s->stats.hits;
+            result.misses += s->stats.misses;
+            result.evictions += s->stats.evictions;
+            result.saved += s->stats.saved;
+        }
+        return result;
+    }
+
+    /// Removes all entries.
+    void clear() {
+        for (auto& s : shards_) {
+            std::lock_guard lock{s->mutex};
+            s->lru.clear();
+            s->map.clear();
+            s->bytes = 0;
+        }
+    }
+
+  private:
+    struct Entry {
+        std::string key;
+        uint64_t hash;
+        std::vector<Neighbor> neighbors;
+        std::chrono::nanoseconds latency;
+        std::optional<std::chrono::steady_clock::time_point> expires_at;
+        size_t size;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> map;
+        size_t bytes = 0;
+        CacheStats stats;
+    };
+
+    template<typename T>
+    static void append(std::string& out, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        char buf[sizeof(T)];
+        std::memcpy(buf, &value, sizeof(T));
+        out.append(buf, sizeof(T));
+    }
+
+    template<typename T>
+    static void append(std::string& out, const std::vector<T>& values) {
+        append(out, values.size());
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    static void append(std::string& out, std::string_view value) {
+        append(out, value.size());
+        out.append(value);
+    }
+
+    // distinguishes types so a vector and halfvec with the same bytes do not collide
+    template<typename V>
+    static std::string encode_key(const V& query, const QueryKey& key) {
+        std::string out;
+        if constexpr (std::is_same_v<V, Vector>) {
+            out.push_back('v');
+            append(out, query.values());
+        } else if constexpr (std::is_same_v<V, HalfVector>) {
+            out.push_back('h');
+            append(out, query.values());
+        } else if constexpr (std::is_same_v<V, SparseVector>) {
+            out.push_back('s');
+            append(out, query.dimensions());
+            append(out, query.indices());
+            append(out, query.values());
+        } else {
+            static_assert(
+                std::is_convertible_v<const V&, std::string_view>,
+                "QueryCache requires Vector, HalfVector, SparseVector, or std::string"
+            );
+            out.push_back('b');
+            append(out, std::string_view{query});
+        }
+        append(out, key.metric);
+        append(out, key.k);
+        append(out, key.filter);
+        append(out, key.profile);
+        return out;
+    }
+
+    // includes the list and map nodes
+    static size_t entry_size(const std::string& key, const std::vector<Neighbor>& neighbors) {
+        return sizeof(Entry) + 64 + key.size() + neighbors.size() * sizeof(Neighbor);
+    }
+
+    static void erase(Shard& s, std::list<Entry>::iterator it) {
+        s.bytes -= it->size;
+        s.map.erase(it->hash);
+        s.lru.erase(it);
+    }
+
+    Shard& shard(uint64_t hash) {
+        // use the high bits since the map uses the low bits
+        return *shards_[(hash >> 32) % shards_.size()];
+    }
+
+    CacheOptions options_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+} // namespace pgvector
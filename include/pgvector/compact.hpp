@@ -0,0 +1,253 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "halfvec.hpp"
+#include "sparsevec.hpp"
+
+namespace pgvector {
+/// How values of a compact sparse vector are stored.
+enum class CompactValues : uint8_t {
+    /// 32-bit floats, which are exact.
+    Float32 = 0,
+
+    /// 16-bit floats, which halve the size of values but round them.
+    Float16 = 1
+};
+
+/// @cond
+namespace detail {
+inline void write_varint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+// returns nullptr if the varint is truncated or too long
+inline const uint8_t* read_varint(const uint8_t* p, const uint8_t* end, uint32_t& v) {
+    // most gaps fit in one byte
+    if (p < end && *p < 0x80) {
+        v = *p;
+        return p + 1;
+    }
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (b < 0x80) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+struct CompactHeader {
+    int dimensions;
+    size_t nnz;
+    CompactValues format;
+    const uint8_t* values;
+    const uint8_t* indices;
+    const uint8_t* end;
+};
+
+inline CompactHeader read_compact_header(std::span<const uint8_t> bytes) {
+    const uint8_t* p = bytes.data();
+    const uint8_t* end = p + bytes.size();
+    uint32_t dimensions;
+    uint32_t nnz;
+    if ((p = read_varint(p, end, dimensions)) == nullptr
+        || (p = read_varint(p, end, nnz)) == nullptr || p == end || *p > 1) {
+        throw std::invalid_argument{"invalid compact sparse vector"};
+    }
+    if (dimensions > static_cast<uint32_t>(std::numeric_limits<int>::max()) || nnz > dimensions) {
+        throw std::invalid_argument{"invalid compact sparse vector"};
+    }
+    auto format = static_cast<CompactValues>(*p++);
+    size_t width = format == CompactValues::Float16 ? 2 : 4;
+    if (static_cast<size_t>(end - p) < nnz * width) {
+        throw std::invalid_argument{"invalid compact sparse vector"};
+    }
+    return {static_cast<int>(dimensions), nnz, format, p, p + nnz * width, end};
+}
+
+inline float compact_value(const CompactHeader& header, size_t i) {
+    if (header.format == CompactValues::Float16) {
+        uint16_t bits;
+        std::memcpy(&bits, header.values + i * 2, 2);
+        return binary16_to_float(bits);
+    }
+    float v;
+    std::memcpy(&v, header.values + i * 4, 4);
+    return v;
+}
+
+// calls f(index, position) for each element, assuming the buffer was validated
+template<typename F>
+void for_each_compact_index(const CompactHeader& header, F&& f) {
+    const uint8_t* p = header.indices;
+    uint32_t index = 0;
+    for (size_t i = 0; i < header.nnz; i++) {
+        uint32_t gap;
+        p = read_varint(p, header.end, gap);
+        index = i == 0 ? gap : index + gap + 1;
+        f(static_cast<int>(index), i);
+    }
+}
+} // namespace detail
+/// @endcond
+
+/// A sparse vector in one contiguous buffer, for keeping many in memory.
+///
+/// Indices are stored as varint gaps between them and values as 32-bit or 16-bit floats in one
+/// heap allocation, so a typical vector takes 45-70% of the memory of a `SparseVector`. Inner
+/// products are computed on the encoded form without decoding.
+class CompactSparseVector {
+  public:
+    /// Encodes a sparse vector.
+    explicit CompactSparseVector(
+        const SparseVector& value,
+        CompactValues format = CompactValues::Float32
+    ) {
+        const std::vector<int>& indices = value.indices();
+        const std::vector<float>& values = value.values();
+        size_t width = format == CompactValues::Float16 ? 2 : 4;
+        bytes_.reserve(11 + values.size() * (width + 2));
+        detail::write_varint(bytes_, static_cast<uint32_t>(value.dimensions()));
+        detail::write_varint(bytes_, static_cast<uint32_t>(values.size()));
+        bytes_.push_back(static_cast<uint8_t>(format));
+
+        size_t offset = bytes_.size();
+        bytes_.resize(offset + values.size() * width);
+        for (size_t i = 0; i < values.size(); i++) {
+            uint8_t* out = bytes_.data() + offset + i * width;
+            if (format == CompactValues::Float16) {
+                uint16_t bits = detail::float_to_binary16(values[i]);
+                std::memcpy(out, &bits, 2);
+            } else {
+                std::memcpy(out, &values[i], 4);
+            }
+        }
+
+        for (size_t i = 0; i < indices.size(); i++) {
+            uint32_t index = static_cast<uint32_t>(indices[i]);
+            uint32_t gap = i == 0 ? index : index - static_cast<uint32_t>(indices[i - 1]) - 1;
+            detail::write_varint(bytes_, gap);
+        }
+        bytes_.shrink_to_fit();
+    }
+
+    /// Creates a compact sparse vector from bytes returned by `bytes`, validating them.
+    explicit CompactSparseVector(std::span<const uint8_t> bytes) :
+        bytes_(bytes.begin(), bytes.end()) {
+        detail::CompactHeader header = detail::read_compact_header(bytes_);
+        const uint8_t* p = header.indices;
+        uint64_t index = 0;
+        for (size_t i = 0; i < header.nnz; i++) {
+            uint32_t gap;
+            if ((p = detail::read_varint(p, header.end, gap)) == nullptr) {
+                throw std::invalid_argument{"invalid compact sparse vector"};
+            }
+            index = i == 0 ? gap : index + gap + 1;
+            if (index >= static_cast<uint64_t>(header.dimensions)) {
+                throw std::invalid_argument{"invalid compact sparse vector"};
+            }
+        }
+        if (p != header.end) {
+            throw std::invalid_argument{"invalid compact sparse vector"};
+        }
+    }
+
+    /// Returns the number of dimensions.
+    int dimensions() const {
+        return header().dimensions;
+    }
+
+    /// Returns the number of non-zero elements.
+    size_t nnz() const {
+        return header().nnz;
+    }
+
+    /// Returns how values are stored.
+    CompactValues format() const {
+        return header().format;
+    }
+
+    /// Returns the encoded bytes, with values in the byte order of the host.
+    std::span<const uint8_t> bytes() const {
+        return bytes_;
+    }
+
+    /// Decodes to a sparse vector.
+    SparseVector decode() const {
+        detail::CompactHeader h = header();
+        std::vector<int> indices(h.nnz);
+        std::vector<float> values(h.nnz);
+        detail::for_each_compact_index(h, [&](int index, size_t i) {
+            indices[i] = index;
+            values[i] = detail::compact_value(h, i);
+        });
+        return SparseVector{std::move(indices), std::move(values), h.dimensions};
+    }
+
+    friend bool operator==(const CompactSparseVector& lhs, const CompactSparseVector& rhs) {
+        return lhs.bytes_ == rhs.bytes_;
+    }
+
+  private:
+    detail::CompactHeader header() const {
+        return detail::read_compact_header(bytes_);
+    }
+
+    std::vector<uint8_t> bytes_;
+};
+
+/// Returns the inner product of a compact sparse vector and a sparse vector.
+inline float inner_product(const CompactSparseVector& a, const SparseVector& b) {
+    if (a.dimensions() != b.dimensions()) {
+        throw std::invalid_argument{"different vector dimensions"};
+    }
+    detail::CompactHeader h = detail::read_compact_header(a.bytes());
+    const std::vector<int>& indices = b.indices();
+    const std::vector<float>& values = b.values();
+    float sum = 0;
+    size_t j = 0;
+    detail::for_each_compact_index(h, [&](int index, size_t i) {
+        while (j < indices.size() && indices[j] < index) {
+            j++;
+        }
+        if (j < indices.size() && indices[j] == index) {
+            sum += detail::compact_value(h, i) * values[j];
+        }
+    });
+    return sum;
+}
+
+/// Returns the inner product of a compact sparse vector and a dense vector, which is the
+/// fastest way to score many vectors against one query.
+inline float inner_product(const CompactSparseVector& a, std::span<const float> b) {
+    if (static_cast<size_t>(a.dimensions()) != b.size()) {
+        throw std::invalid_argument{"different vector dimensions"};
+    }
+    detail::CompactHeader h = detail::read_compact_header(a.bytes());
+    float sum = 0;
+    detail::for_each_compact_index(h, [&](int index, size_t i) {
+        sum += detail::compact_value(h, i) * b[static_cast<size_t>(index)];
+    });
+    return sum;
+}
+} // namespace pgvector
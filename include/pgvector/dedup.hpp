@@ -0,0 +1,164 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include "halfvec.hpp"
+#include "hash.hpp"
+#include "sparsevec.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// How a deduplicator remembers vectors.
+enum class DedupMode {
+    /// Keep the 128-bit hashes of the most recent vectors, forgetting the oldest when full.
+    HashSet,
+
+    /// Keep a Bloom filter, which uses less memory but drops some unique vectors.
+    BloomFilter
+};
+
+/// Deduplicator options.
+struct DedupOptions {
+    /// How vectors are remembered.
+    DedupMode mode = DedupMode::HashSet;
+
+    /// The number of vectors to remember.
+    size_t capacity = 1000000;
+
+    /// The fraction of unique vectors a Bloom filter drops once it holds `capacity` vectors.
+    double false_positive_rate = 0.001;
+};
+
+/// Drops exact duplicates from a stream of vectors, like rows before `COPY`, using bounded
+/// memory.
+///
+/// Supports `Vector`, `HalfVector`, `SparseVector`, and bit strings like `"101"` as
+/// `std::string`.
+template<typename V>
+class Deduplicator {
+    static_assert(
+        std::is_same_v<V, Vector> || std::is_same_v<V, HalfVector>
+            || std::is_same_v<V, SparseVector> || std::is_same_v<V, std::string>,
+        "Deduplicator requires Vector, HalfVector, SparseVector, or std::string"
+    );
+
+  public:
+    /// Creates an empty deduplicator.
+    explicit Deduplicator(const DedupOptions& options = {}) : options_{options} {
+        if (options.capacity == 0) {
+            throw std::invalid_argument{"capacity must be greater than 0"};
+        }
+        if (options.mode == DedupMode::BloomFilter) {
+            if (!(options.false_positive_rate > 0 && options.false_positive_rate < 1)) {
+                throw std::invalid_argument{"false_positive_rate must be between 0 and 1"};
+            }
+            // optimal size and number of hash functions for the capacity
+            double n = static_cast<double>(options.capacity);
+            double ln2 = std::log(2.0);
+            double bits = std::ceil(-n * std::log(options.false_positive_rate) / (ln2 * ln2));
+            size_t words = (static_cast<size_t>(bits) + 63) / 64;
+            bloom_.resize(words);
+            hashes_ = std::max(
+                static_cast<size_t>(std::round(static_cast<double>(words * 64) / n * ln2)),
+                static_cast<size_t>(1)
+            );
+        } else {
+            recent_.reserve(options.capacity);
+            set_.reserve(options.capacity);
+        }
+    }
+
+    /// Returns the options.
+    const DedupOptions& options() const {
+        return options_;
+    }
+
+    /// Remembers a vector and returns whether it has not been seen before.
+    bool insert(const V& value) {
+        Hash128 hash = hash128(value);
+        bool unique = options_.mode == DedupMode::BloomFilter ? insert_bloom(hash)
+                                                              : insert_set(hash);
+        if (unique) {
+            unique_++;
+        } else {
+            duplicates_++;
+        }
+        return unique;
+    }
+
+    /// Returns the number of unique vectors seen.
+    size_t unique() const {
+        return unique_;
+    }
+
+    /// Returns the number of duplicates dropped.
+    size_t duplicates() const {
+        return duplicates_;
+    }
+
+    /// Forgets all vectors.
+    void clear() {
+        set_.clear();
+        recent_.clear();
+        next_ = 0;
+        std::fill(bloom_.begin(), bloom_.end(), 0);
+        unique_ = 0;
+        duplicates_ = 0;
+    }
+
+  private:
+    bool insert_set(const Hash128& hash) {
+        if (!set_.insert(hash).second) {
+            return false;
+        }
+        // forget the oldest hash in FIFO order
+        if (recent_.size() < options_.capacity) {
+            recent_.push_back(hash);
+        } else {
+            set_.erase(recent_[next_]);
+            recent_[next_] = hash;
+            next_ = (next_ + 1) % options_.capacity;
+        }
+        return true;
+    }
+
+    // double hashing from the two halves gives independent enough probes
+    bool insert_bloom(const Hash128& hash) {
+        size_t bits = bloom_.size() * 64;
+        bool seen = true;
+        for (size_t i = 0; i < hashes_; i++) {
+            uint64_t bit = (hash.low + i * hash.high) % bits;
+            uint64_t mask = uint64_t{1} << (bit % 64);
+            uint64_t& word = bloom_[bit / 64];
+            if ((word & mask) == 0) {
+                seen = false;
+                word |= mask;
+            }
+        }
+        return !seen;
+    }
+
+    DedupOptions options_;
+    std::unordered_set<Hash128> set_;
+    std::vector<Hash128> recent_;
+    size_t next_ = 0;
+    std::vector<uint64_t> bloom_;
+    size_t hashes_ = 0;
+    size_t unique_ = 0;
+    size_t duplicates_ = 0;
+};
+} // namespace pgvector
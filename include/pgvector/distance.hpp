@@ -0,0 +1,461 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__AVX__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include "halfvec.hpp"
+#include "sparsevec.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// A distance metric.
+enum class Metric {
+    /// L2 distance (`<->`).
+    L2,
+    /// Negative inner product (`<#>`).
+    InnerProduct,
+    /// Cosine distance (`<=>`).
+    Cosine,
+    /// L1 distance (`<+>`).
+    L1,
+    /// Hamming distance for bit vectors (`<~>`).
+    Hamming,
+    /// Jaccard distance for bit vectors (`<%>`).
+    Jaccard
+};
+
+/// @cond
+namespace detail {
+inline void check_dimensions(size_t a, size_t b) {
+    if (a != b) {
+        throw std::invalid_argument{"different vector dimensions"};
+    }
+}
+
+inline void check_vector_metric(Metric metric) {
+    if (metric == Metric::Hamming || metric == Metric::Jaccard) {
+        throw std::invalid_argument{"hamming and jaccard distance require bit vectors"};
+    }
+}
+
+inline void check_bit_metric(Metric metric) {
+    if (metric != Metric::Hamming && metric != Metric::Jaccard) {
+        throw std::invalid_argument{"bit vectors require hamming or jaccard distance"};
+    }
+}
+
+inline const char* metric_operator(Metric metric) {
+    switch (metric) {
+        case Metric::L2:
+            return "<->";
+        case Metric::InnerProduct:
+            return "<#>";
+        case Metric::Cosine:
+            return "<=>";
+        case Metric::L1:
+            return "<+>";
+        case Metric::Hamming:
+            return "<~>";
+        case Metric::Jaccard:
+            return "<%>";
+    }
+    throw std::invalid_argument{"unknown metric"};
+}
+
+#if defined(__AVX__) && defined(__FMA__)
+inline __m256 load8(const float* p) {
+    return _mm256_loadu_ps(p);
+}
+
+#if defined(__F16C__)
+inline __m256 load8(const Half* p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+#endif
+
+inline float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+template<typename T>
+inline constexpr bool has_simd = std::is_same_v<T, float>
+#if defined(__F16C__)
+    || std::is_same_v<T, Half>
+#endif
+    ;
+#endif
+
+// n is a size_t, or a std::integral_constant for fixed vectors so loop bounds are constants
+template<typename T, typename Size>
+float squared_l2(const T* a, const T* b, Size n) {
+    size_t i = 0;
+    float sum = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<T>) {
+        __m256 s0 = _mm256_setzero_ps();
+        __m256 s1 = _mm256_setzero_ps();
+        for (; i + 16 <= n; i += 16) {
+            __m256 d0 = _mm256_sub_ps(load8(a + i), load8(b + i));
+            __m256 d1 = _mm256_sub_ps(load8(a + i + 8), load8(b + i + 8));
+            s0 = _mm256_fmadd_ps(d0, d0, s0);
+            s1 = _mm256_fmadd_ps(d1, d1, s1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            __m256 d0 = _mm256_sub_ps(load8(a + i), load8(b + i));
+            s0 = _mm256_fmadd_ps(d0, d0, s0);
+        }
+        sum = hsum(_mm256_add_ps(s0, s1));
+    }
+#endif
+    for (; i < n; i++) {
+        float d = static_cast<float>(a[i]) - static_cast<float>(b[i]);
+        sum += d * d;
+    }
+    return sum;
+}
+
+template<typename T, typename Size>
+float dot(const T* a, const T* b, Size n) {
+    size_t i = 0;
+    float sum = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<T>) {
+        __m256 s0 = _mm256_setzero_ps();
+        __m256 s1 = _mm256_setzero_ps();
+        for (; i + 16 <= n; i += 16) {
+            s0 = _mm256_fmadd_ps(load8(a + i), load8(b + i), s0);
+            s1 = _mm256_fmadd_ps(load8(a + i + 8), load8(b + i + 8), s1);
+        }
+        for (; i + 8 <= n; i += 8) {
+            s0 = _mm256_fmadd_ps(load8(a + i), load8(b + i), s0);
+        }
+        sum = hsum(_mm256_add_ps(s0, s1));
+    }
+#endif
+    for (; i < n; i++) {
+        sum += static_cast<float>(a[i]) * static_cast<float>(b[i]);
+    }
+    return sum;
+}
+
+template<typename T, typename Size>
+float cosine(const T* a, const T* b, Size n) {
+    float ab = dot(a, b, n);
+    float aa = dot(a, a, n);
+    float bb = dot(b, b, n);
+    // matches the server, which returns NaN for zero vectors
+    float similarity = ab / std::sqrt(aa * bb);
+    if (similarity > 1) {
+        similarity = 1;
+    } else if (similarity < -1) {
+        similarity = -1;
+    }
+    return 1 - similarity;
+}
+
+template<typename T, typename Size>
+float l1(const T* a, const T* b, Size n) {
+    size_t i = 0;
+    float sum = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<T>) {
+        const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+        __m256 s0 = _mm256_setzero_ps();
+        for (; i + 8 <= n; i += 8) {
+            s0 = _mm256_add_ps(s0, _mm256_and_ps(_mm256_sub_ps(load8(a + i), load8(b + i)), mask));
+        }
+        sum = hsum(s0);
+    }
+#endif
+    for (; i < n; i++) {
+        sum += std::fabs(static_cast<float>(a[i]) - static_cast<float>(b[i]));
+    }
+    return sum;
+}
+
+template<typename T, typename Size>
+float distance(Metric metric, const T* a, const T* b, Size n) {
+    switch (metric) {
+        case Metric::L2:
+            return std::sqrt(squared_l2(a, b, n));
+        case Metric::InnerProduct:
+            return -dot(a, b, n);
+        case Metric::Cosine:
+            return cosine(a, b, n);
+        case Metric::L1:
+            return l1(a, b, n);
+        case Metric::Hamming:
+        case Metric::Jaccard:
+            check_vector_metric(metric);
+    }
+    return 0;
+}
+
+// bit vectors are packed with the first bit in the high bit of the first byte, like the server
+inline uint64_t popcount(const uint8_t* a, size_t n) {
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        std::memcpy(&x, a + i, 8);
+        count += static_cast<uint64_t>(std::popcount(x));
+    }
+    for (; i < n; i++) {
+        count += static_cast<uint64_t>(std::popcount(a[i]));
+    }
+    return count;
+}
+
+inline uint64_t hamming(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        uint64_t y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        count += static_cast<uint64_t>(std::popcount(x ^ y));
+    }
+    for (; i < n; i++) {
+        count += static_cast<uint64_t>(std::popcount(static_cast<uint8_t>(a[i] ^ b[i])));
+    }
+    return count;
+}
+
+inline uint64_t intersection(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;
+        uint64_t y;
+        std::memcpy(&x, a + i, 8);
+        std::memcpy(&y, b + i, 8);
+        count += static_cast<uint64_t>(std::popcount(x & y));
+    }
+    for (; i < n; i++) {
+        count += static_cast<uint64_t>(std::popcount(static_cast<uint8_t>(a[i] & b[i])));
+    }
+    return count;
+}
+
+inline float jaccard(const uint8_t* a, const uint8_t* b, size_t n) {
+    uint64_t ab = intersection(a, b, n);
+    uint64_t total = popcount(a, n) + popcount(b, n) - ab;
+    if (total == 0) {
+        return 1;
+    }
+    return 1 - static_cast<float>(static_cast<double>(ab) / static_cast<double>(total));
+}
+
+inline float bit_distance(Metric metric, const uint8_t* a, const uint8_t* b, size_t n) {
+    check_bit_metric(metric);
+    if (metric == Metric::Hamming) {
+        return static_cast<float>(hamming(a, b, n));
+    }
+    return jaccard(a, b, n);
+}
+
+// sparse vectors are passed as sorted indices and values
+struct SparseRef {
+    const int* indices;
+    const float* values;
+    size_t nnz;
+};
+
+inline SparseRef sparse_ref(const SparseVector& v) {
+    return {v.indices().data(), v.values().data(), v.indices().size()};
+}
+
+inline float sparse_dot(SparseRef a, SparseRef b) {
+    float sum = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.nnz && j < b.nnz) {
+        if (a.indices[i] == b.indices[j]) {
+            sum += a.values[i] * b.values[j];
+            i++;
+            j++;
+        } else if (a.indices[i] < b.indices[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return sum;
+}
+
+// f(a, b) for each index in either vector, with zeros for missing values
+template<typename F>
+void sparse_union(SparseRef a, SparseRef b, F&& f) {
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.nnz || j < b.nnz) {
+        if (j == b.nnz || (i < a.nnz && a.indices[i] < b.indices[j])) {
+            f(a.values[i], 0.0f);
+            i++;
+        } else if (i == a.nnz || b.indices[j] < a.indices[i]) {
+            f(0.0f, b.values[j]);
+            j++;
+        } else {
+            f(a.values[i], b.values[j]);
+            i++;
+            j++;
+        }
+    }
+}
+
+inline float sparse_distance(Metric metric, SparseRef a, SparseRef b) {
+    switch (metric) {
+        case Metric::L2: {
+            float sum = 0;
+            sparse_union(a, b, [&](float x, float y) { sum += (x - y) * (x - y); });
+            return std::sqrt(sum);
+        }
+        case Metric::InnerProduct:
+            return -sparse_dot(a, b);
+        case Metric::Cosine: {
+            float similarity = sparse_dot(a, b) / std::sqrt(sparse_dot(a, a) * sparse_dot(b, b));
+            if (similarity > 1) {
+                similarity = 1;
+            } else if (similarity < -1) {
+                similarity = -1;
+            }
+            return 1 - similarity;
+        }
+        case Metric::L1: {
+            float sum = 0;
+            sparse_union(a, b, [&](float x, float y) { sum += std::fabs(x - y); });
+            return sum;
+        }
+        case Metric::Hamming:
+        case Metric::Jaccard:
+            check_vector_metric(metric);
+    }
+    return 0;
+}
+} // namespace detail
+/// @endcond
+
+/// Returns the L2 distance between two vectors.
+inline float l2_distance(std::span<const float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return std::sqrt(detail::squared_l2(a.data(), b.data(), a.size()));
+}
+
+/// Returns the L2 distance between two half vectors.
+inline float l2_distance(std::span<const Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return std::sqrt(detail::squared_l2(a.data(), b.data(), a.size()));
+}
+
+/// Returns the inner product of two vectors.
+inline float inner_product(std::span<const float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::dot(a.data(), b.data(), a.size());
+}
+
+/// Returns the inner product of two half vectors.
+inline float inner_product(std::span<const Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::dot(a.data(), b.data(), a.size());
+}
+
+/// Returns the cosine distance between two vectors.
+inline float cosine_distance(std::span<const float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::cosine(a.data(), b.data(), a.size());
+}
+
+/// Returns the cosine distance between two half vectors.
+inline float cosine_distance(std::span<const Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::cosine(a.data(), b.data(), a.size());
+}
+
+/// Returns the L1 distance between two vectors.
+inline float l1_distance(std::span<const float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::l1(a.data(), b.data(), a.size());
+}
+
+/// Returns the L1 distance between two half vectors.
+inline float l1_distance(std::span<const Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::l1(a.data(), b.data(), a.size());
+}
+
+/// Returns the distance between two vectors, ordered the same way as the server.
+inline float distance(Metric metric, std::span<const float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::distance(metric, a.data(), b.data(), a.size());
+}
+
+/// Returns the distance between two half vectors, ordered the same way as the server.
+inline float distance(Metric metric, std::span<const Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::distance(metric, a.data(), b.data(), a.size());
+}
+
+/// Returns the distance between two vectors, ordered the same way as the server.
+inline float distance(Metric metric, const Vector& a, const Vector& b) {
+    return distance(metric, std::span<const float>{a.values()}, std::span<const float>{b.values()});
+}
+
+/// Returns the distance between two half vectors, ordered the same way as the server.
+inline float distance(Metric metric, const HalfVector& a, const HalfVector& b) {
+    return distance(metric, std::span<const Half>{a.values()}, std::span<const Half>{b.values()});
+}
+
+/// Returns the distance between two sparse vectors, ordered the same way as the server.
+inline float distance(Metric metric, const SparseVector& a, const SparseVector& b) {
+    if (a.dimensions() != b.dimensions()) {
+        throw std::invalid_argument{"different sparsevec dimensions"};
+    }
+    return detail::sparse_distance(metric, detail::sparse_ref(a), detail::sparse_ref(b));
+}
+
+/// Returns the inner product of two sparse vectors.
+inline float inner_product(const SparseVector& a, const SparseVector& b) {
+    if (a.dimensions() != b.dimensions()) {
+        throw std::invalid_argument{"different sparsevec dimensions"};
+    }
+    return detail::sparse_dot(detail::sparse_ref(a), detail::sparse_ref(b));
+}
+
+/// Returns the Hamming distance between two bit vectors packed with `pack_bits`.
+inline float hamming_distance(std::span<const uint8_t> a, std::span<const uint8_t> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return static_cast<float>(detail::hamming(a.data(), b.data(), a.size()));
+}
+
+/// Returns the Jaccard distance between two bit vectors packed with `pack_bits`.
+inline float jaccard_distance(std::span<const uint8_t> a, std::span<const uint8_t> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::jaccard(a.data(), b.data(), a.size());
+}
+
+/// Returns the distance between two bit vectors packed with `pack_bits`.
+inline float distance(Metric metric, std::span<const uint8_t> a, std::span<const uint8_t> b) {
+    detail::check_dimensions(a.size(), b.size());
+    return detail::bit_distance(metric, a.data(), b.data(), a.size());
+}
+} // namespace pgvector
@@ -0,0 +1,173 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include "batch.hpp"
+#include "halfvec.hpp"
+#include "instrumentation.hpp"
+#include "parallel.hpp"
+#include "pqxx.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Extraction options.
+struct ExtractOptions {
+    /// The number of threads for decoding, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// Ids and vectors extracted from a result, where `ids[i]` is the id of `vectors[i]`.
+template<typename T>
+struct ExtractedVectors {
+    /// The ids.
+    std::vector<int64_t> ids = {};
+
+    /// The vectors.
+    VectorBatch<T> vectors{0};
+};
+
+/// @cond
+namespace detail {
+// decoding a few rows is faster than starting a thread
+inline constexpr size_t extract_rows_per_thread = 256;
+
+inline size_t literal_dimensions(std::string_view text) {
+    if (text.size() <= 2) {
+        return 0;
+    }
+    return static_cast<size_t>(std::count(text.begin(), text.end(), ',')) + 1;
+}
+
+// parses a vector literal into out, which has the expected number of dimensions
+inline void parse_vector_literal(
+    std::string_view text,
+    std::span<float> out,
+    std::string_view type
+) {
+    if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
+        throw pqxx::conversion_error{"Malformed " + std::string{type} + " literal"};
+    }
+    size_t dimensions = literal_dimensions(text);
+    if (dimensions != out.size()) {
+        throw pqxx::conversion_error{
+            "Expected " + std::to_string(out.size()) + " dimensions, not "
+            + std::to_string(dimensions)
+        };
+    }
+
+    std::string_view inner = text.substr(1, text.size() - 2);
+    for (size_t i = 0; i < dimensions; i++) {
+        size_t end = std::min(inner.find(','), inner.size());
+        out[i] = pqxx::from_string<float>(inner.substr(0, end));
+        inner.remove_prefix(std::min(end + 1, inner.size()));
+    }
+}
+
+template<typename V>
+VectorBatch<typename V::value_type> extract_column(
+    const pqxx::result& result,
+    int column,
+    int64_t* ids,
+    int id_column,
+    const ExtractOptions& options
+) {
+    static_assert(
+        std::is_same_v<V, Vector> || std::is_same_v<V, HalfVector>,
+        "extract_vectors requires Vector or HalfVector"
+    );
+    using T = typename V::value_type;
+    constexpr std::string_view type = std::is_same_v<V, Vector> ? "vector" : "halfvec";
+
+    PGVECTOR_INSTRUMENT(Decode, type);
+
+    size_t n = static_cast<size_t>(result.size());
+    if (n == 0) {
+        return VectorBatch<T>{0};
+    }
+
+    // all rows must have the dimensions of the first
+    auto first = result[0][column];
+    size_t dimensions = first.is_null() ? 0 : literal_dimensions(first.view());
+    VectorBatch<T> batch{dimensions, n};
+
+    size_t threads = std::min(
+        thread_count(options.threads), (n + extract_rows_per_thread - 1) / extract_rows_per_thread
+    );
+    std::vector<size_t> bytes(threads);
+    parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+        // halfvec elements are parsed as floats and converted a row at a time
+        std::vector<float> buffer(std::is_same_v<T, float> ? 0 : dimensions);
+        for (size_t i = begin; i < end; i++) {
+            auto row = result[static_cast<int>(i)];
+            auto field = row[column];
+            if (field.is_null()) {
+                throw pqxx::conversion_error{"Unexpected null " + std::string{type}};
+            }
+            std::string_view text = field.view();
+            bytes[t] += text.size();
+            if constexpr (std::is_same_v<T, float>) {
+                parse_vector_literal(text, batch[i], type);
+            } else {
+                parse_vector_literal(text, buffer, type);
+                convert(buffer.data(), batch[i].data(), dimensions);
+            }
+            if (ids != nullptr) {
+                ids[i] = row[id_column].template as<int64_t>();
+            }
+        }
+    });
+
+    PGVECTOR_INSTRUMENT_SIZE(
+        std::accumulate(bytes.begin(), bytes.end(), size_t{0}), n * dimensions
+    );
+    return batch;
+}
+} // namespace detail
+/// @endcond
+
+/// Decodes a `vector` or `halfvec` column of a result into one contiguous batch, splitting rows
+/// across threads.
+///
+/// All vectors must have the same number of dimensions. Use instead of `as<Vector>()` for each
+/// row when fetching many vectors, like candidates for reranking.
+template<typename V = Vector>
+VectorBatch<typename V::value_type> extract_vectors(
+    const pqxx::result& result,
+    int column,
+    const ExtractOptions& options = {}
+) {
+    return detail::extract_column<V>(result, column, nullptr, 0, options);
+}
+
+/// Decodes a `bigint` id column and a `vector` or `halfvec` column of a result, splitting rows
+/// across threads.
+template<typename V = Vector>
+ExtractedVectors<typename V::value_type> extract_vectors_with_ids(
+    const pqxx::result& result,
+    int id_column,
+    int column,
+    const ExtractOptions& options = {}
+) {
+    ExtractedVectors<typename V::value_type> extracted;
+    extracted.ids.resize(static_cast<size_t>(result.size()));
+    extracted.vectors =
+        detail::extract_column<V>(result, column, extracted.ids.data(), id_column, options);
+    return extracted;
+}
+} // namespace pgvector
@@ -0,0 +1,171 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "distance.hpp"
+#include "halfvec.hpp"
+
+namespace pgvector {
+/// @cond
+namespace detail {
+// aligns for SIMD loads when that adds no padding, so arrays of vectors stay contiguous
+template<typename T, size_t N>
+inline constexpr size_t fixed_alignment = N > 0 && N * sizeof(T) % 32 == 0 ? 32 : alignof(T);
+
+inline void check_fixed_dimensions(size_t expected, size_t actual) {
+    if (actual != expected) {
+        throw std::invalid_argument{
+            "expected " + std::to_string(expected) + " dimensions, not " + std::to_string(actual)
+        };
+    }
+}
+} // namespace detail
+/// @endcond
+
+/// A vector with a number of dimensions known at compile time, stored inline without
+/// allocating.
+///
+/// Use `FixedVector` or `FixedHalfVector`. Vectors are trivially copyable, so arrays of them
+/// are one block of memory.
+template<typename T, size_t N>
+class alignas(detail::fixed_alignment<T, N>) BasicFixedVector {
+    static_assert(
+        std::is_same_v<T, float> || std::is_same_v<T, Half>, "element type must be float or Half"
+    );
+
+  public:
+    /// The element type.
+    using value_type = T;
+
+    /// Creates a vector of zeros.
+    BasicFixedVector() = default;
+
+    /// Creates a vector from a `std::array`.
+    explicit BasicFixedVector(const std::array<T, N>& value) : value_{value} {}
+
+    /// Creates a vector from a span, checking the number of dimensions.
+    explicit BasicFixedVector(std::span<const T> value) {
+        detail::check_fixed_dimensions(N, value.size());
+        std::copy(value.begin(), value.end(), value_.begin());
+    }
+
+    /// Returns the number of dimensions.
+    static constexpr size_t dimensions() {
+        return N;
+    }
+
+    /// Returns the values.
+    const std::array<T, N>& values() const {
+        return value_;
+    }
+
+    friend bool operator==(const BasicFixedVector& lhs, const BasicFixedVector& rhs) {
+        return lhs.value_ == rhs.value_;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const BasicFixedVector& value) {
+        os << "[";
+        for (size_t i = 0; i < N; i++) {
+            if (i > 0) {
+                os << ",";
+            }
+            os << static_cast<float>(value.value_[i]);
+        }
+        os << "]";
+        return os;
+    }
+
+  private:
+    std::array<T, N> value_ = {};
+};
+
+/// A vector with a fixed number of dimensions.
+template<size_t N>
+using FixedVector = BasicFixedVector<float, N>;
+
+/// A half vector with a fixed number of dimensions.
+template<size_t N>
+using FixedHalfVector = BasicFixedVector<Half, N>;
+
+/// A bit vector with a fixed number of dimensions, packed like `pack_bits`.
+template<size_t N>
+class FixedBitVector {
+  public:
+    /// The number of bytes.
+    static constexpr size_t bytes = (N + 7) / 8;
+
+    /// Creates a vector of zeros.
+    FixedBitVector() = default;
+
+    /// Creates a vector from a bit string like `"101"`, checking the number of dimensions.
+    explicit FixedBitVector(std::string_view value) {
+        detail::check_fixed_dimensions(N, value.size());
+        for (size_t i = 0; i < N; i++) {
+            if (value[i] == '1') {
+                value_[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+            } else if (value[i] != '0') {
+                throw std::invalid_argument{"invalid bit string"};
+            }
+        }
+    }
+
+    /// Returns the number of dimensions.
+    static constexpr size_t dimensions() {
+        return N;
+    }
+
+    /// Returns the packed bits.
+    const std::array<uint8_t, bytes>& values() const {
+        return value_;
+    }
+
+    /// Returns whether a bit is set.
+    bool test(size_t i) const {
+        return value_[i / 8] & (0x80 >> (i % 8));
+    }
+
+    friend bool operator==(const FixedBitVector& lhs, const FixedBitVector& rhs) = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedBitVector& value) {
+        for (size_t i = 0; i < N; i++) {
+            os << (value.test(i) ? '1' : '0');
+        }
+        return os;
+    }
+
+  private:
+    std::array<uint8_t, bytes> value_ = {};
+};
+
+/// Returns the distance between two vectors, ordered the same way as the server.
+///
+/// The number of dimensions is checked at compile time and is a constant in the distance
+/// loops, so the compiler can drop the remainder loops and unroll short vectors.
+template<typename T, size_t N>
+float distance(Metric metric, const BasicFixedVector<T, N>& a, const BasicFixedVector<T, N>& b) {
+    return detail::distance(
+        metric, a.values().data(), b.values().data(), std::integral_constant<size_t, N>{}
+    );
+}
+
+/// Returns the distance between two bit vectors, ordered the same way as the server.
+template<size_t N>
+float distance(Metric metric, const FixedBitVector<N>& a, const FixedBitVector<N>& b) {
+    return detail::bit_distance(metric, a.values().data(), b.values().data(), a.bytes);
+}
+} // namespace pgvector
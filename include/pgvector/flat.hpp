@@ -0,0 +1,386 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "batch.hpp"
+#include "bit.hpp"
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "instrumentation.hpp"
+#include "neighbor.hpp"
+#include "parallel.hpp"
+#include "sparsevec.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Flat index options.
+struct FlatOptions {
+    /// The distance metric.
+    Metric metric = Metric::L2;
+
+    /// The number of threads for search, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// An in-memory index for exact search.
+///
+/// Supports `Vector`, `HalfVector`, `SparseVector`, and bit strings like `"101"` as
+/// `std::string`. Vectors are stored contiguously, and searches split queries and vectors
+/// across threads.
+template<typename V>
+class FlatIndex {
+    static constexpr bool is_dense = std::is_same_v<V, Vector> || std::is_same_v<V, HalfVector>;
+    static constexpr bool is_sparse = std::is_same_v<V, SparseVector>;
+    static constexpr bool is_bit = std::is_same_v<V, std::string>;
+
+    static_assert(
+        is_dense || is_sparse || is_bit,
+        "FlatIndex requires Vector, HalfVector, SparseVector, or std::string"
+    );
+
+    template<typename U>
+    struct element {
+        using type = typename U::value_type;
+    };
+
+    template<typename U>
+        requires std::is_same_v<U, SparseVector>
+    struct element<U> {
+        using type = float;
+    };
+
+    template<typename U>
+        requires std::is_same_v<U, std::string>
+    struct element<U> {
+        using type = uint8_t;
+    };
+
+  public:
+    /// The element type, which is packed bytes for bit strings.
+    using value_type = typename element<V>::type;
+
+    /// Creates an empty index.
+    explicit FlatIndex(size_t dimensions, const FlatOptions& options = {}) :
+        dimensions_{dimensions},
+        options_{options},
+        data_{is_bit ? (dimensions + 7) / 8 : (is_dense ? dimensions : 0)} {
+        if constexpr (is_bit) {
+            detail::check_bit_metric(options.metric);
+        } else {
+            detail::check_vector_metric(options.metric);
+        }
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the number of vectors added.
+    size_t size() const {
+        return ids_.size();
+    }
+
+    /// Returns the options.
+    const FlatOptions& options() const {
+        return options_;
+    }
+
+    /// Reserves space for a number of vectors.
+    void reserve(size_t n) {
+        ids_.reserve(n);
+        if constexpr (is_sparse) {
+            offsets_.reserve(n + 1);
+        } else {
+            data_.reserve(n);
+        }
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, const V& value) {
+        PGVECTOR_INSTRUMENT(Insert, "flat");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        if constexpr (is_dense) {
+            data_.push_back(value.values());
+            if (options_.metric == Metric::Cosine) {
+                norms_.push_back(norm(data_.row(data_.rows() - 1)));
+            }
+        } else if constexpr (is_sparse) {
+            check_sparse_dimensions(value);
+            if (offsets_.empty()) {
+                offsets_.push_back(0);
+            }
+            indices_.insert(indices_.end(), value.indices().begin(), value.indices().end());
+            values_.insert(values_.end(), value.values().begin(), value.values().end());
+            offsets_.push_back(indices_.size());
+            if (options_.metric == Metric::Cosine) {
+                norms_.push_back(std::sqrt(detail::sparse_dot(
+                    detail::sparse_ref(value), detail::sparse_ref(value)
+                )));
+            }
+        } else {
+            data_.push_back(pack(value));
+        }
+        ids_.push_back(id);
+    }
+
+    /// Adds a batch of vectors.
+    void add(std::span<const int64_t> ids, const VectorBatch<value_type>& values)
+        requires is_dense
+    {
+        PGVECTOR_INSTRUMENT(Insert, "flat");
+        PGVECTOR_INSTRUMENT_SIZE(0, ids.size());
+
+        if (ids.size() != values.rows()) {
+            throw std::invalid_argument{"ids and values must be the same size"};
+        }
+        detail::check_dimensions(values.dimensions(), dimensions_);
+        reserve(size() + ids.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            data_.push_back(values.row(i));
+            if (options_.metric == Metric::Cosine) {
+                norms_.push_back(norm(values.row(i)));
+            }
+        }
+        ids_.insert(ids_.end(), ids.begin(), ids.end());
+    }
+
+    /// Adds rows of `(id, vector)` tuples, like those from `pqxx::transaction_base::stream`.
+    template<typename R>
+    void load(R&& rows) {
+        for (const auto& [id, value] : rows) {
+            add(static_cast<int64_t>(id), value);
+        }
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(const V& query, size_t k) const {
+        return std::move(search(std::span<const V>{&query, 1}, k).front());
+    }
+
+    /// Returns the `k` nearest neighbors for each query.
+    std::vector<std::vector<Neighbor>> search(std::span<const V> queries, size_t k) const {
+        if constexpr (is_dense) {
+            VectorBatch<value_type> batch{dimensions_};
+            batch.reserve(queries.size());
+            for (const auto& q : queries) {
+                batch.push_back(q.values());
+            }
+            return search(batch, k);
+        } else if constexpr (is_sparse) {
+            std::vector<detail::SparseRef> refs;
+            std::vector<float> norms;
+            refs.reserve(queries.size());
+            for (const auto& q : queries) {
+                check_sparse_dimensions(q);
+                refs.push_back(detail::sparse_ref(q));
+                norms.push_back(std::sqrt(detail::sparse_dot(refs.back(), refs.back())));
+            }
+            return run(queries.size(), k, [&](size_t q, size_t row) {
+                detail::SparseRef r{
+                    indices_.data() + offsets_[row], values_.data() + offsets_[row],
+                    offsets_[row + 1] - offsets_[row]
+                };
+                if (options_.metric == Metric::Cosine) {
+                    return cosine(detail::sparse_dot(refs[q], r), norms[q], norms_[row]);
+                }
+                return detail::sparse_distance(options_.metric, refs[q], r);
+            });
+        } else {
+            VectorBatch<uint8_t> batch{data_.dimensions()};
+            batch.reserve(queries.size());
+            for (const auto& q : queries) {
+                batch.push_back(pack(q));
+            }
+            return run(queries.size(), k, [&](size_t q, size_t row) {
+                return detail::bit_distance(
+                    options_.metric, batch.row(q).data(), data_.row(row).data(),
+                    data_.dimensions()
+                );
+            });
+        }
+    }
+
+    /// Returns the `k` nearest neighbors for each query.
+    std::vector<std::vector<Neighbor>> search(
+        const VectorBatch<value_type>& queries,
+        size_t k
+    ) const
+        requires is_dense
+    {
+        detail::check_dimensions(queries.dimensions(), dimensions_);
+
+        std::vector<float> norms;
+        if (options_.metric == Metric::Cosine) {
+            norms.reserve(queries.rows());
+            for (size_t i = 0; i < queries.rows(); i++) {
+                norms.push_back(norm(queries.row(i)));
+            }
+        }
+
+        const Metric metric = options_.metric;
+        const size_t dim = dimensions_;
+        auto result = run(queries.rows(), k, [&](size_t q, size_t row) {
+            const value_type* a = queries.data() + q * dim;
+            const value_type* b = data_.data() + row * dim;
+            switch (metric) {
+                case Metric::L2:
+                    return detail::squared_l2(a, b, dim);
+                case Metric::InnerProduct:
+                    return -detail::dot(a, b, dim);
+                case Metric::Cosine:
+                    return cosine(detail::dot(a, b, dim), norms[q], norms_[row]);
+                case Metric::L1:
+                    return detail::l1(a, b, dim);
+                case Metric::Hamming:
+                case Metric::Jaccard:
+                    break;
+            }
+            return 0.0f;
+        });
+
+        if (metric == Metric::L2) {
+            for (auto& neighbors : result) {
+                for (auto& v : neighbors) {
+                    v.distance = std::sqrt(v.distance);
+                }
+            }
+        }
+        return result;
+    }
+
+  private:
+    // sized to stay in L2 cache while every query in a partition scans it
+    static constexpr size_t tile_bytes = 256 * 1024;
+
+    static float norm(std::span<const value_type> v) {
+        return std::sqrt(detail::dot(v.data(), v.data(), v.size()));
+    }
+
+    static float cosine(float dot, float a, float b) {
+        float similarity = dot / (a * b);
+        if (similarity > 1) {
+            similarity = 1;
+        } else if (similarity < -1) {
+            similarity = -1;
+        }
+        return 1 - similarity;
+    }
+
+    std::vector<uint8_t> pack(std::string_view value) const {
+        if (value.size() != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.size())
+            };
+        }
+        return pack_bits(value);
+    }
+
+    void check_sparse_dimensions(const SparseVector& value) const {
+        if (static_cast<size_t>(value.dimensions()) != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.dimensions())
+            };
+        }
+    }
+
+    size_t row_bytes() const {
+        if constexpr (is_sparse) {
+            size_t n = size();
+            return n == 0 ? 1 : std::max(offsets_.back() / n, static_cast<size_t>(1)) * 8;
+        } else {
+            return std::max(data_.dimensions() * sizeof(value_type), static_cast<size_t>(1));
+        }
+    }
+
+    // splits queries across threads, and also vectors when there are fewer queries than threads,
+    // then merges the per-thread heaps
+    template<typename F>
+    std::vector<std::vector<Neighbor>> run(size_t nq, size_t k, F&& distance) const {
+        PGVECTOR_INSTRUMENT(Search, "flat");
+        PGVECTOR_INSTRUMENT_SIZE(0, nq);
+
+        if (k == 0) {
+            return std::vector<std::vector<Neighbor>>(nq);
+        }
+
+        size_t n = size();
+        size_t threads = detail::thread_count(options_.threads);
+        size_t query_parts = std::max(std::min(nq, threads), static_cast<size_t>(1));
+        size_t data_parts = std::max(std::min(threads / query_parts, n), static_cast<size_t>(1));
+        size_t parts = query_parts * data_parts;
+        size_t tile = std::max(tile_bytes / row_bytes(), static_cast<size_t>(1));
+
+        std::vector<std::vector<TopK>> partial(parts);
+        detail::parallel_for(parts, parts, [&](size_t begin, size_t end, size_t) {
+            for (size_t p = begin; p < end; p++) {
+                size_t qp = p / data_parts;
+                size_t dp = p % data_parts;
+                size_t q_begin = nq * qp / query_parts;
+                size_t q_end = nq * (qp + 1) / query_parts;
+                size_t d_begin = n * dp / data_parts;
+                size_t d_end = n * (dp + 1) / data_parts;
+
+                std::vector<TopK> tops(q_end - q_begin, TopK{k});
+                for (size_t t_begin = d_begin; t_begin < d_end; t_begin += tile) {
+                    size_t t_end = std::min(t_begin + tile, d_end);
+                    for (size_t q = q_begin; q < q_end; q++) {
+                        TopK& top = tops[q - q_begin];
+                        float threshold = top.threshold();
+                        for (size_t row = t_begin; row < t_end; row++) {
+                            float d = distance(q, row);
+                            if (!(d > threshold)) {
+                                top.push(ids_[row], d);
+                                threshold = top.threshold();
+                            }
+                        }
+                    }
+                }
+                partial[p] = std::move(tops);
+            }
+        });
+
+        std::vector<std::vector<Neighbor>> result;
+        result.reserve(nq);
+        for (size_t qp = 0; qp < query_parts; qp++) {
+            size_t q_begin = nq * qp / query_parts;
+            size_t q_end = nq * (qp + 1) / query_parts;
+            for (size_t q = q_begin; q < q_end; q++) {
+                TopK& top = partial[qp * data_parts][q - q_begin];
+                for (size_t dp = 1; dp < data_parts; dp++) {
+                    top.merge(partial[qp * data_parts + dp][q - q_begin]);
+                }
+                result.push_back(top.sorted());
+            }
+        }
+        return result;
+    }
+
+    size_t dimensions_;
+    FlatOptions options_;
+    VectorBatch<value_type> data_;
+    std::vector<size_t> offsets_;
+    std::vector<int> indices_;
+    std::vector<float> values_;
+    std::vector<float> norms_;
+    std::vector<int64_t> ids_;
+};
+} // namespace pgvector
@@ -6,12 +6,19 @@
 
 #pragma once
 
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <span>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
 #if __STDCPP_FLOAT16_T__
 #include <stdfloat>
 #else
@@ -20,18 +27,128 @@
 #endif
 
 namespace pgvector {
-/// A half vector element.
+/// @cond
+namespace detail {
+// IEEE binary16 bits with round to nearest even, for storage when Half is not native
+inline uint16_t float_to_binary16(float value) {
+    uint32_t u = std::bit_cast<uint32_t>(value);
+    uint32_t sign = (u >> 16) & 0x8000;
+    u &= 0x7FFFFFFF;
+
+    uint32_t bits;
+    if (u >= (127 + 16) << 23) {
+        // overflow to infinity and keep NaN quiet
+        bits = u > 0x7F800000 ? 0x7E00 : 0x7C00;
+    } else if (u < 113 << 23) {
+        // subnormal or zero, rounded by adding 0.5f so the result lands in the low bits
+        float f = std::bit_cast<float>(u) + 0.5f;
+        bits = std::bit_cast<uint32_t>(f) - 0x3F000000;
+    } else {
+        uint32_t odd = (u >> 13) & 1;
+        u += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFF + odd;
+        bits = u >> 13;
+    }
+    return static_cast<uint16_t>(bits | sign);
+}
+
+inline float binary16_to_float(uint16_t value) {
+    constexpr uint32_t exponent_mask = 0x7C00 << 13;
+    uint32_t u = static_cast<uint32_t>(value & 0x7FFF) << 13;
+    uint32_t exponent = u & exponent_mask;
+    u += static_cast<uint32_t>(127 - 15) << 23;
+    if (exponent == exponent_mask) {
+        // infinity or NaN
+        u += static_cast<uint32_t>(128 - 16) << 23;
+    } else if (exponent == 0) {
+        // subnormal
+        u += 1 << 23;
+        u = std::bit_cast<uint32_t>(std::bit_cast<float>(u) - std::bit_cast<float>(113u << 23));
+    }
+    return std::bit_cast<float>(u | (static_cast<uint32_t>(value & 0x8000) << 16));
+}
+} // namespace detail
+/// @endcond
+
 #if __STDCPP_FLOAT16_T__
+/// A half vector element.
 using Half = std::float16_t;
 #elif defined(__FLT16_MAX__)
+/// A half vector element.
 using Half = _Float16;
 #else
-using Half = float;
+/// A half vector element, stored as IEEE binary16 and converted to `float` for arithmetic since
+/// the compiler has no native 16-bit float.
+class Half {
+  public:
+    /// Creates a zero.
+    Half() = default;
+
+    /// Creates a half from a number, rounding to nearest even.
+    template<typename T>
+        requires std::is_arithmetic_v<T>
+    Half(T value) : bits_{detail::float_to_binary16(static_cast<float>(value))} {}
+
+    /// Returns the value as a float, which is exact.
+    operator float() const {
+        return detail::binary16_to_float(bits_);
+    }
+
+  private:
+    uint16_t bits_ = 0;
+};
+#endif
+
+/// @cond
+namespace detail {
+// uses the bit conversions for the scalar path, since native conversions may be library calls
+inline void convert(const float* from, Half* to, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(from + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), h);
+    }
+#endif
+    for (; i < n; i++) {
+        to[i] = std::bit_cast<Half>(float_to_binary16(from[i]));
+    }
+}
+
+inline void convert(const Half* from, float* to, size_t n) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+        _mm256_storeu_ps(to + i, _mm256_cvtph_ps(h));
+    }
 #endif
+    for (; i < n; i++) {
+        to[i] = binary16_to_float(std::bit_cast<uint16_t>(from[i]));
+    }
+}
+} // namespace detail
+/// @endcond
+
+/// Converts floats to halves, rounding to nearest even.
+inline std::vector<Half> to_half(std::span<const float> values) {
+    std::vector<Half> result(values.size());
+    detail::convert(values.data(), result.data(), values.size());
+    return result;
+}
+
+/// Converts halves to floats, which is exact.
+inline std::vector<float> to_float(std::span<const Half> values) {
+    std::vector<float> result(values.size());
+    detail::convert(values.data(), result.data(), values.size());
+    return result;
+}
 
 /// A half vector.
 class HalfVector {
   public:
+    /// The element type.
+    using value_type = Half;
+
     /// Creates a half vector from a `std::vector`.
     explicit HalfVector(const std::vector<Half>& value) : value_{value} {}
 
@@ -0,0 +1,354 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "halfvec.hpp"
+#include "sparsevec.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// A 128-bit hash.
+struct Hash128 {
+    /// The low 64 bits.
+    uint64_t low;
+
+    /// The high 64 bits.
+    uint64_t high;
+
+    friend bool operator==(const Hash128& lhs, const Hash128& rhs) = default;
+};
+} // namespace pgvector
+
+/// @cond
+
+namespace pgvector::detail {
+inline constexpr uint64_t xxh_prime1 = 0x9E3779B185EBCA87;
+inline constexpr uint64_t xxh_prime2 = 0xC2B2AE3D27D4EB4F;
+inline constexpr uint64_t xxh_prime3 = 0x165667B19E3779F9;
+inline constexpr uint64_t xxh_prime4 = 0x85EBCA77C2B2AE63;
+inline constexpr uint64_t xxh_prime5 = 0x27D4EB2F165667C5;
+
+// reads little-endian so hashes are the same on every platform
+inline uint64_t read_le64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+inline uint32_t read_le32(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+        | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * xxh_prime2;
+    acc = std::rotl(acc, 31);
+    return acc * xxh_prime1;
+}
+
+inline uint64_t xxh_merge_round(uint64_t acc, uint64_t value) {
+    acc ^= xxh_round(0, value);
+    return acc * xxh_prime1 + xxh_prime4;
+}
+
+// streaming XXH64
+class Xxh64 {
+  public:
+    explicit Xxh64(uint64_t seed = 0) :
+        v1_{seed + xxh_prime1 + xxh_prime2},
+        v2_{seed + xxh_prime2},
+        v3_{seed},
+        v4_{seed - xxh_prime1},
+        seed_{seed} {}
+
+    void update(const void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        const auto* p = static_cast<const unsigned char*>(data);
+        const unsigned char* end = p + size;
+        total_ += size;
+
+        if (buffered_ + size < 32) {
+            std::memcpy(buffer_ + buffered_, p, size);
+            buffered_ += size;
+            return;
+        }
+        if (buffered_ > 0) {
+            size_t n = 32 - buffered_;
+            std::memcpy(buffer_ + buffered_, p, n);
+            stripe(buffer_);
+            p += n;
+            buffered_ = 0;
+        }
+        for (; end - p >= 32; p += 32) {
+            stripe(p);
+        }
+        buffered_ = static_cast<size_t>(end - p);
+        std::memcpy(buffer_, p, buffered_);
+    }
+
+    uint64_t digest() const {
+        uint64_t h;
+        if (total_ >= 32) {
+            h = std::rotl(v1_, 1) + std::rotl(v2_, 7) + std::rotl(v3_, 12) + std::rotl(v4_, 18);
+            h = xxh_merge_round(h, v1_);
+            h = xxh_merge_round(h, v2_);
+            h = xxh_merge_round(h, v3_);
+            h = xxh_merge_round(h, v4_);
+        } else {
+            h = seed_ + xxh_prime5;
+        }
+        h += total_;
+
+        const unsigned char* p = buffer_;
+        const unsigned char* end = buffer_ + buffered_;
+        for (; end - p >= 8; p += 8) {
+            h ^= xxh_round(0, read_le64(p));
+            h = std::rotl(h, 27) * xxh_prime1 + xxh_prime4;
+        }
+        if (end - p >= 4) {
+            h ^= static_cast<uint64_t>(read_le32(p)) * xxh_prime1;
+            h = std::rotl(h, 23) * xxh_prime2 + xxh_prime3;
+            p += 4;
+        }
+        for (; p < end; p++) {
+            h ^= *p * xxh_prime5;
+            h = std::rotl(h, 11) * xxh_prime1;
+        }
+
+        h ^= h >> 33;
+        h *= xxh_prime2;
+        h ^= h >> 29;
+        h *= xxh_prime3;
+        h ^= h >> 32;
+        return h;
+    }
+
+  private:
+    // the four lanes are independent so they can run in parallel
+    void stripe(const unsigned char* p) {
+        v1_ = xxh_round(v1_, read_le64(p));
+        v2_ = xxh_round(v2_, read_le64(p + 8));
+        v3_ = xxh_round(v3_, read_le64(p + 16));
+        v4_ = xxh_round(v4_, read_le64(p + 24));
+    }
+
+    uint64_t v1_;
+    uint64_t v2_;
+    uint64_t v3_;
+    uint64_t v4_;
+    uint64_t seed_;
+    uint64_t total_ = 0;
+    unsigned char buffer_[32];
+    size_t buffered_ = 0;
+};
+
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0) {
+    Xxh64 state{seed};
+    state.update(data, size);
+    return state.digest();
+}
+
+inline uint64_t hash_bytes(std::string_view data, uint64_t seed = 0) {
+    return hash_bytes(data.data(), data.size(), seed);
+}
+
+// two independent states, since a 128-bit XXH3 is much more code
+class Xxh128 {
+  public:
+    explicit Xxh128(uint64_t seed) : low_{seed}, high_{seed ^ xxh_prime5} {}
+
+    void update(const void* data, size_t size) {
+        low_.update(data, size);
+        high_.update(data, size);
+    }
+
+    Hash128 digest() const {
+        return {low_.digest(), high_.digest()};
+    }
+
+  private:
+    Xxh64 low_;
+    Xxh64 high_;
+};
+
+template<typename S>
+void hash_u32(S& state, uint32_t v) {
+    unsigned char bytes[4];
+    for (int j = 0; j < 4; j++) {
+        bytes[j] = static_cast<unsigned char>(v >> (8 * j));
+    }
+    state.update(bytes, 4);
+}
+
+// writes little-endian float32 bits in chunks so the conversion loop vectorizes,
+// with -0 as 0 to match operator==
+template<typename S, typename T>
+void hash_floats(S& state, std::span<const T> values) {
+    constexpr size_t chunk = 256;
+    unsigned char bytes[chunk * 4];
+    float converted[chunk];
+    for (size_t start = 0; start < values.size(); start += chunk) {
+        size_t n = std::min(chunk, values.size() - start);
+        const float* floats = converted;
+        if constexpr (std::is_same_v<T, float>) {
+            floats = values.data() + start;
+        } else {
+            convert(values.data() + start, converted, n);
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint32_t bits = std::bit_cast<uint32_t>(floats[i] + 0.0f);
+            for (int j = 0; j < 4; j++) {
+                bytes[i * 4 + static_cast<size_t>(j)] = static_cast<unsigned char>(bits >> (8 * j));
+            }
+        }
+        state.update(bytes, n * 4);
+    }
+}
+
+template<typename S>
+void hash_ints(S& state, std::span<const int> values) {
+    constexpr size_t chunk = 256;
+    unsigned char bytes[chunk * 4];
+    for (size_t start = 0; start < values.size(); start += chunk) {
+        size_t n = std::min(chunk, values.size() - start);
+        for (size_t i = 0; i < n; i++) {
+            auto bits = static_cast<uint32_t>(values[start + i]);
+            for (int j = 0; j < 4; j++) {
+                bytes[i * 4 + static_cast<size_t>(j)] = static_cast<unsigned char>(bits >> (8 * j));
+            }
+        }
+        state.update(bytes, n * 4);
+    }
+}
+
+template<typename S>
+void hash_value(S& state, const Vector& value) {
+    hash_floats(state, std::span<const float>{value.values()});
+}
+
+// hashes float32 bits so the result does not depend on whether Half is a native type
+template<typename S>
+void hash_value(S& state, const HalfVector& value) {
+    hash_floats(state, std::span<const Half>{value.values()});
+}
+
+template<typename S>
+void hash_value(S& state, const SparseVector& value) {
+    hash_u32(state, static_cast<uint32_t>(value.dimensions()));
+    hash_u32(state, static_cast<uint32_t>(value.indices().size()));
+    hash_ints(state, std::span<const int>{value.indices()});
+    hash_floats(state, std::span<const float>{value.values()});
+}
+
+template<typename S>
+void hash_value(S& state, std::string_view bits) {
+    state.update(bits.data(), bits.size());
+}
+} // namespace pgvector::detail
+
+/// @endcond
+
+namespace pgvector {
+/// Returns a 64-bit hash of a vector that is the same on every platform.
+inline uint64_t hash64(const Vector& value, uint64_t seed = 0) {
+    detail::Xxh64 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 64-bit hash of a half vector that is the same on every platform.
+inline uint64_t hash64(const HalfVector& value, uint64_t seed = 0) {
+    detail::Xxh64 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 64-bit hash of a sparse vector that is the same on every platform.
+inline uint64_t hash64(const SparseVector& value, uint64_t seed = 0) {
+    detail::Xxh64 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 64-bit hash of a bit string like `"101"` that is the same on every platform.
+inline uint64_t hash64(std::string_view bits, uint64_t seed = 0) {
+    detail::Xxh64 state{seed};
+    detail::hash_value(state, bits);
+    return state.digest();
+}
+
+/// Returns a 128-bit hash of a vector that is the same on every platform.
+inline Hash128 hash128(const Vector& value, uint64_t seed = 0) {
+    detail::Xxh128 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 128-bit hash of a half vector that is the same on every platform.
+inline Hash128 hash128(const HalfVector& value, uint64_t seed = 0) {
+    detail::Xxh128 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 128-bit hash of a sparse vector that is the same on every platform.
+inline Hash128 hash128(const SparseVector& value, uint64_t seed = 0) {
+    detail::Xxh128 state{seed};
+    detail::hash_value(state, value);
+    return state.digest();
+}
+
+/// Returns a 128-bit hash of a bit string like `"101"` that is the same on every platform.
+inline Hash128 hash128(std::string_view bits, uint64_t seed = 0) {
+    detail::Xxh128 state{seed};
+    detail::hash_value(state, bits);
+    return state.digest();
+}
+} // namespace pgvector
+
+template<>
+struct std::hash<pgvector::Vector> {
+    size_t operator()(const pgvector::Vector& value) const noexcept {
+        return static_cast<size_t>(pgvector::hash64(value));
+    }
+};
+
+template<>
+struct std::hash<pgvector::HalfVector> {
+    size_t operator()(const pgvector::HalfVector& value) const noexcept {
+        return static_cast<size_t>(pgvector::hash64(value));
+    }
+};
+
+template<>
+struct std::hash<pgvector::SparseVector> {
+    size_t operator()(const pgvector::SparseVector& value) const noexcept {
+        return static_cast<size_t>(pgvector::hash64(value));
+    }
+};
+
+template<>
+struct std::hash<pgvector::Hash128> {
+    size_t operator()(const pgvector::Hash128& value) const noexcept {
+        return static_cast<size_t>(value.low);
+    }
+};
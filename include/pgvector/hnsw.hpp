@@ -0,0 +1,537 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "instrumentation.hpp"
+#include "math.hpp"
+#include "neighbor.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// HNSW index options.
+struct HnswOptions {
+    /// The distance metric.
+    Metric metric = Metric::L2;
+
+    /// The max number of connections per layer.
+    size_t m = 16;
+
+    /// The size of the dynamic candidate list for constructing the graph.
+    size_t ef_construction = 64;
+
+    /// The size of the dynamic candidate list for search.
+    size_t ef_search = 40;
+
+    /// The seed for choosing layers.
+    uint64_t seed = 0;
+};
+
+/// An in-memory HNSW index for `Vector` or `HalfVector`.
+///
+/// Vectors are stored contiguously in a buffer sized on creation. Adding and searching
+/// can happen concurrently from multiple threads.
+template<typename V>
+class HnswIndex {
+    static_assert(
+        std::is_same_v<V, Vector> || std::is_same_v<V, HalfVector>,
+        "HnswIndex requires Vector or HalfVector"
+    );
+
+  public:
+    /// The element type.
+    using value_type = typename V::value_type;
+
+    /// Creates an index with room for `capacity` vectors.
+    HnswIndex(size_t dimensions, size_t capacity, const HnswOptions& options = {}) :
+        dimensions_{dimensions},
+        capacity_{capacity},
+        options_{options},
+        max_m0_{options.m * 2},
+        ml_{1 / std::log(static_cast<double>(options.m))},
+        data_(capacity * dimensions),
+        ids_(capacity),
+        links0_(capacity * (max_m0_ + 1)),
+        upper_links_(capacity),
+        locks_(capacity),
+        rng_{options.seed} {
+        if (dimensions == 0) {
+            throw std::invalid_argument{"dimensions must be greater than 0"};
+        }
+        detail::check_vector_metric(options.metric);
+        if (capacity > std::numeric_limits<uint32_t>::max()) {
+            throw std::invalid_argument{"capacity cannot be greater than max uint32"};
+        }
+        if (options.m < 2 || options.m > 100) {
+            throw std::invalid_argument{"m must be between 2 and 100"};
+        }
+        if (options.ef_construction < 2 * options.m || options.ef_construction > 1000) {
+            throw std::invalid_argument{"ef_construction must be between 2 * m and 1000"};
+        }
+        if (options.ef_search < 1 || options.ef_search > 1000) {
+            throw std::invalid_argument{"ef_search must be between 1 and 1000"};
+        }
+    }
+
+    HnswIndex(const HnswIndex&) = delete;
+    HnswIndex& operator=(const HnswIndex&) = delete;
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the number of vectors added, not counting inserts still in progress.
+    size_t size() const {
+        return size_.load();
+    }
+
+    /// Returns the max number of vectors.
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    /// Returns the options.
+    const HnswOptions& options() const {
+        return options_;
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, const V& value) {
+        add(id, std::span<const value_type>{value.values()});
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, std::span<const value_type> value) {
+        PGVECTOR_INSTRUMENT(Insert, "hnsw");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        if (value.size() != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.size())
+            };
+        }
+
+        uint32_t node = reserve();
+        int level = random_level();
+
+        std::copy(value.begin(), value.end(), vector(node));
+        if (options_.metric == Metric::Cosine) {
+            detail::normalize(vector(node), dimensions_);
+        }
+        ids_[node] = id;
+        upper_links_[node].resize(static_cast<size_t>(level) * (options_.m + 1));
+
+        insert(node, level);
+        size_.fetch_add(1);
+    }
+
+    /// Adds rows of `(id, vector)` tuples, like those from `pqxx::transaction_base::stream`.
+    template<typename R>
+    void load(R&& rows) {
+        for (const auto& [id, value] : rows) {
+            add(static_cast<int64_t>(id), value);
+        }
+    }
+
+    /// Returns the `k` nearest neighbors, using `ef_search` from the options.
+    std::vector<Neighbor> search(const V& query, size_t k) const {
+        return search(std::span<const value_type>{query.values()}, k, options_.ef_search);
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(const V& query, size_t k, size_t ef_search) const {
+        return search(std::span<const value_type>{query.values()}, k, ef_search);
+    }
+
+    /// Returns the `k` nearest neighbors, using `ef_search` from the options.
+    std::vector<Neighbor> search(std::span<const value_type> query, size_t k) const {
+        return search(query, k, options_.ef_search);
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(
+        std::span<const value_type> query,
+        size_t k,
+        size_t ef_search
+    ) const {
+        PGVECTOR_INSTRUMENT(Search, "hnsw");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        detail::check_dimensions(query.size(), dimensions_);
+
+        std::vector<value_type> normalized;
+        const value_type* q = query.data();
+        if (options_.metric == Metric::Cosine) {
+            normalized.assign(query.begin(), query.end());
+            detail::normalize(normalized.data(), dimensions_);
+            q = normalized.data();
+        }
+
+        uint32_t ep;
+        int top;
+        {
+            std::lock_guard lock{entry_mutex_};
+            if (max_level_ < 0) {
+                return {};
+            }
+            ep = entry_point_;
+            top = max_level_;
+        }
+
+        float ep_distance = distance(q, ep);
+        for (int lc = top; lc > 0; lc--) {
+            greedy_search(q, ep, ep_distance, lc);
+        }
+
+        std::vector<Candidate> candidates =
+            search_layer(q, ep, ep_distance, std::max(ef_search, k), 0, std::nullopt);
+        if (candidates.size() > k) {
+            candidates.resize(k);
+        }
+
+        std::vector<Neighbor> result;
+        result.reserve(candidates.size());
+        for (const auto& [d, c] : candidates) {
+            result.push_back({ids_[c], options_.metric == Metric::L2 ? std::sqrt(d) : d});
+        }
+        return result;
+    }
+
+  private:
+    using Candidate = std::pair<float, uint32_t>;
+
+    struct VisitedList {
+        std::vector<uint32_t> marks;
+        uint32_t tag = 0;
+    };
+
+    // returns a visited list to the pool when done
+    class VisitedGuard {
+      public:
+        explicit VisitedGuard(const HnswIndex& index) : index_{index} {
+            {
+                std::lock_guard lock{index.visited_mutex_};
+                if (!index.visited_pool_.empty()) {
+                    list_ = std::move(index.visited_pool_.back());
+                    index.visited_pool_.pop_back();
+                }
+            }
+            if (!list_) {
+                list_ = std::make_unique<VisitedList>();
+                list_->marks.resize(index.capacity_);
+            }
+            list_->tag++;
+            if (list_->tag == 0) {
+                std::ranges::fill(list_->marks, 0);
+                list_->tag = 1;
+            }
+        }
+
+        VisitedGuard(const VisitedGuard&) = delete;
+        VisitedGuard& operator=(const VisitedGuard&) = delete;
+
+        ~VisitedGuard() {
+            std::lock_guard lock{index_.visited_mutex_};
+            index_.visited_pool_.push_back(std::move(list_));
+        }
+
+        // marks a node and returns whether it was already visited
+        bool visit(uint32_t node) {
+            if (list_->marks[node] == list_->tag) {
+                return true;
+            }
+            list_->marks[node] = list_->tag;
+            return false;
+        }
+
+      private:
+        const HnswIndex& index_;
+        std::unique_ptr<VisitedList> list_;
+    };
+
+    uint32_t reserve() {
+        size_t n = reserved_.load();
+        do {
+            if (n >= capacity_) {
+                throw std::length_error{"hnsw index is full"};
+            }
+        } while (!reserved_.compare_exchange_weak(n, n + 1));
+        return static_cast<uint32_t>(n);
+    }
+
+    int random_level() {
+        std::lock_guard lock{rng_mutex_};
+        std::uniform_real_distribution<double> dist{0, 1};
+        double level = -std::log(1 - dist(rng_)) * ml_;
+        // same max level as the server
+        return static_cast<int>(std::min(level, 15.0));
+    }
+
+    value_type* vector(uint32_t node) {
+        return data_.data() + static_cast<size_t>(node) * dimensions_;
+    }
+
+    const value_type* vector(uint32_t node) const {
+        return data_.data() + static_cast<size_t>(node) * dimensions_;
+    }
+
+    // internal distance, which is squared for L2 and assumes normalized vectors for cosine
+    float distance(const value_type* a, const value_type* b) const {
+        switch (options_.metric) {
+            case Metric::L2:
+                return detail::squared_l2(a, b, dimensions_);
+            case Metric::InnerProduct:
+                return -detail::dot(a, b, dimensions_);
+            case Metric::Cosine:
+                return 1 - detail::dot(a, b, dimensions_);
+            case Metric::L1:
+                return detail::l1(a, b, dimensions_);
+            case Metric::Hamming:
+            case Metric::Jaccard:
+                break;
+        }
+        return 0;
+    }
+
+    float distance(const value_type* q, uint32_t node) const {
+        return distance(q, vector(node));
+    }
+
+    size_t max_connections(int level) const {
+        return level == 0 ? max_m0_ : options_.m;
+    }
+
+    // points to the count followed by the neighbors
+    uint32_t* links(uint32_t node, int level) {
+        if (level == 0) {
+            return links0_.data() + static_cast<size_t>(node) * (max_m0_ + 1);
+        }
+        return upper_links_[node].data() + static_cast<size_t>(level - 1) * (options_.m + 1);
+    }
+
+    const uint32_t* links(uint32_t node, int level) const {
+        return const_cast<HnswIndex*>(this)->links(node, level);
+    }
+
+    void copy_links(uint32_t node, int level, std::vector<uint32_t>& out) const {
+        std::lock_guard lock{locks_[node]};
+        const uint32_t* l = links(node, level);
+        out.assign(l + 1, l + 1 + l[0]);
+    }
+
+    void greedy_search(const value_type* q, uint32_t& ep, float& ep_distance, int level) const {
+        std::vector<uint32_t> neighbors;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            copy_links(ep, level, neighbors);
+            for (auto n : neighbors) {
+                float d = distance(q, n);
+                if (d < ep_distance) {
+                    ep = n;
+                    ep_distance = d;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // returns up to ef candidates sorted by distance
+    std::vector<Candidate> search_layer(
+        const value_type* q,
+        uint32_t ep,
+        float ep_distance,
+        size_t ef,
+        int level,
+        std::optional<uint32_t> skip
+    ) const {
+        VisitedGuard visited{*this};
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> candidates;
+        std::priority_queue<Candidate> nearest;
+
+        visited.visit(ep);
+        candidates.emplace(ep_distance, ep);
+        if (ep != skip) {
+            nearest.emplace(ep_distance, ep);
+        }
+
+        std::vector<uint32_t> neighbors;
+        while (!candidates.empty()) {
+            auto [d, c] = candidates.top();
+            if (nearest.size() >= ef && d > nearest.top().first) {
+                break;
+            }
+            candidates.pop();
+
+            copy_links(c, level, neighbors);
+            for (auto n : neighbors) {
+                if (visited.visit(n)) {
+                    continue;
+                }
+
+                float nd = distance(q, n);
+                if (nearest.size() < ef || nd < nearest.top().first) {
+                    candidates.emplace(nd, n);
+                    if (n != skip) {
+                        nearest.emplace(nd, n);
+                        if (nearest.size() > ef) {
+                            nearest.pop();
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<Candidate> result(nearest.size());
+        for (size_t i = result.size(); i > 0; i--) {
+            result[i - 1] = nearest.top();
+            nearest.pop();
+        }
+        return result;
+    }
+
+    // heuristic from the HNSW paper, which favors diverse neighbors
+    std::vector<uint32_t> select_neighbors(
+        const std::vector<Candidate>& candidates,
+        size_t m
+    ) const {
+        std::vector<uint32_t> selected;
+        selected.reserve(m);
+        for (const auto& [d, c] : candidates) {
+            if (selected.size() >= m) {
+                break;
+            }
+            bool good = true;
+            for (auto s : selected) {
+                if (distance(vector(c), vector(s)) < d) {
+                    good = false;
+                    break;
+                }
+            }
+            if (good) {
+                selected.push_back(c);
+            }
+        }
+        return selected;
+    }
+
+    void connect(uint32_t node, uint32_t neighbor, int level) {
+        std::lock_guard lock{locks_[neighbor]};
+        uint32_t* l = links(neighbor, level);
+        size_t max = max_connections(level);
+        if (l[0] < max) {
+            l[l[0] + 1] = node;
+            l[0]++;
+            return;
+        }
+
+        // shrink connections
+        std::vector<Candidate> candidates;
+        candidates.reserve(max + 1);
+        candidates.emplace_back(distance(vector(neighbor), vector(node)), node);
+        for (size_t i = 1; i <= max; i++) {
+            candidates.emplace_back(distance(vector(neighbor), vector(l[i])), l[i]);
+        }
+        std::ranges::sort(candidates);
+
+        std::vector<uint32_t> selected = select_neighbors(candidates, max);
+        std::ranges::copy(selected, l + 1);
+        l[0] = static_cast<uint32_t>(selected.size());
+    }
+
+    void insert(uint32_t node, int level) {
+        std::unique_lock entry_lock{entry_mutex_};
+        if (max_level_ < 0) {
+            entry_point_ = node;
+            max_level_ = level;
+            return;
+        }
+        uint32_t ep = entry_point_;
+        int top = max_level_;
+        // keep the lock until the entry point is updated
+        if (level <= top) {
+            entry_lock.unlock();
+        }
+
+        const value_type* q = vector(node);
+        float ep_distance = distance(q, ep);
+        for (int lc = top; lc > level; lc--) {
+            greedy_search(q, ep, ep_distance, lc);
+        }
+
+        for (int lc = std::min(level, top); lc >= 0; lc--) {
+            std::vector<Candidate> candidates =
+                search_layer(q, ep, ep_distance, options_.ef_construction, lc, node);
+            std::vector<uint32_t> neighbors = select_neighbors(candidates, options_.m);
+
+            {
+                std::lock_guard lock{locks_[node]};
+                uint32_t* l = links(node, lc);
+                std::ranges::copy(neighbors, l + 1);
+                l[0] = static_cast<uint32_t>(neighbors.size());
+            }
+
+            for (auto n : neighbors) {
+                connect(node, n, lc);
+            }
+
+            if (!candidates.empty()) {
+                std::tie(ep_distance, ep) = candidates.front();
+            }
+        }
+
+        if (level > top) {
+            entry_point_ = node;
+            max_level_ = level;
+        }
+    }
+
+    size_t dimensions_;
+    size_t capacity_;
+    HnswOptions options_;
+    size_t max_m0_;
+    double ml_;
+    std::vector<value_type> data_;
+    std::vector<int64_t> ids_;
+    std::vector<uint32_t> links0_;
+    std::vector<std::vector<uint32_t>> upper_links_;
+    mutable std::vector<std::mutex> locks_;
+    // slots claimed by inserts, which can run ahead of completed inserts
+    std::atomic<size_t> reserved_{0};
+    std::atomic<size_t> size_{0};
+    mutable std::mutex entry_mutex_;
+    uint32_t entry_point_ = 0;
+    int max_level_ = -1;
+    std::mutex rng_mutex_;
+    std::mt19937_64 rng_;
+    mutable std::mutex visited_mutex_;
+    mutable std::vector<std::unique_ptr<VisitedList>> visited_pool_;
+};
+} // namespace pgvector
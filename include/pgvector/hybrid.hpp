@@ -0,0 +1,305 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include "distance.hpp"
+#include "instrumentation.hpp"
+#include "pqxx.hpp"
+#include "sql.hpp"
+
+namespace pgvector {
+/// How results from multiple retrievers are combined.
+enum class Fusion {
+    /// Sum `weight / (rrf_k + rank)` across retrievers.
+    ReciprocalRank,
+
+    /// Sum `weight * score`, with scores scaled to between 0 and 1 for each retriever.
+    Weighted
+};
+
+/// Hybrid search options.
+struct HybridOptions {
+    /// How results are combined.
+    Fusion fusion = Fusion::ReciprocalRank;
+
+    /// The rank constant for reciprocal rank fusion.
+    double rrf_k = 60;
+};
+
+/// A query whose rows are candidates for hybrid search.
+struct Retriever {
+    /// The query, which returns an id and a score for each row, best first.
+    std::string sql = {};
+
+    /// The query parameters.
+    pqxx::params params = {};
+
+    /// The weight of the retriever.
+    double weight = 1;
+
+    /// Whether lower scores are better, like distances.
+    bool ascending = false;
+};
+
+/// A hybrid search result.
+struct HybridResult {
+    /// The id.
+    int64_t id;
+
+    /// The fused score, where higher is better.
+    double score;
+
+    friend bool operator==(const HybridResult& lhs, const HybridResult& rhs) = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const HybridResult& value) {
+        os << value.id << ":" << value.score;
+        return os;
+    }
+};
+
+/// @cond
+namespace detail {
+// open addressing with linear probing, since candidate sets are small and ids are integers
+class ScoreMap {
+  public:
+    explicit ScoreMap(size_t expected) {
+        size_t capacity = std::bit_ceil(std::max(expected * 2, static_cast<size_t>(16)));
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+        entries_.reserve(expected);
+    }
+
+    void add(int64_t id, double score) {
+        uint64_t hash = static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15;
+        size_t i = static_cast<size_t>(hash >> 32) & mask_;
+        while (slots_[i] != 0) {
+            HybridResult& entry = entries_[slots_[i] - 1];
+            if (entry.id == id) {
+                entry.score += score;
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+        entries_.push_back({id, score});
+        slots_[i] = entries_.size();
+    }
+
+    std::vector<HybridResult>& entries() {
+        return entries_;
+    }
+
+  private:
+    // entry index plus one, or zero if empty
+    std::vector<size_t> slots_;
+    size_t mask_;
+    std::vector<HybridResult> entries_;
+};
+
+inline std::vector<HybridResult> fuse(
+    const std::vector<Retriever>& retrievers,
+    const std::vector<std::vector<HybridResult>>& results,
+    size_t limit,
+    const HybridOptions& options
+) {
+    size_t expected = 0;
+    for (const auto& r : results) {
+        expected += r.size();
+    }
+    ScoreMap scores{expected};
+
+    for (size_t i = 0; i < retrievers.size(); i++) {
+        const Retriever& retriever = retrievers[i];
+        const std::vector<HybridResult>& rows = results[i];
+        if (options.fusion == Fusion::ReciprocalRank) {
+            for (size_t rank = 0; rank < rows.size(); rank++) {
+                double rrf = 1.0 / (options.rrf_k + static_cast<double>(rank + 1));
+                scores.add(rows[rank].id, retriever.weight * rrf);
+            }
+        } else {
+            // scale so scores from different retrievers are comparable
+            double min = 0;
+            double max = 0;
+            if (!rows.empty()) {
+                auto [lo, hi] = std::ranges::minmax_element(rows, {}, &HybridResult::score);
+                min = lo->score;
+                max = hi->score;
+            }
+            for (const auto& row : rows) {
+                double scaled = 1;
+                if (max > min) {
+                    scaled = retriever.ascending ? (max - row.score) / (max - min)
+                                                 : (row.score - min) / (max - min);
+                }
+                scores.add(row.id, retriever.weight * scaled);
+            }
+        }
+    }
+
+    // break ties by id so results are deterministic
+    auto better = [](const HybridResult& a, const HybridResult& b) {
+        return a.score > b.score || (a.score == b.score && a.id < b.id);
+    };
+    std::vector<HybridResult>& entries = scores.entries();
+    size_t n = std::min(limit, entries.size());
+    auto middle = entries.begin() + static_cast<ptrdiff_t>(n);
+    std::partial_sort(entries.begin(), middle, entries.end(), better);
+    entries.resize(n);
+    return std::move(entries);
+}
+} // namespace detail
+/// @endcond
+
+/// Returns a retriever for the nearest neighbors of a vector, like `Vector` or `SparseVector`.
+template<typename V>
+Retriever semantic_retriever(
+    std::string_view table,
+    std::string_view column,
+    const V& query,
+    size_t limit,
+    Metric metric = Metric::Cosine,
+    std::string_view id_column = "id"
+) {
+    std::string distance = detail::quote_name(column) + " " + detail::metric_operator(metric)
+        + " $1";
+    return Retriever{
+        .sql = "SELECT " + detail::quote_name(id_column) + ", " + distance + " FROM "
+            + detail::quote_name(table) + " ORDER BY " + distance + " LIMIT $2",
+        .params = pqxx::params{query, static_cast<int64_t>(limit)},
+        .ascending = true
+    };
+}
+
+/// Returns a retriever for full-text matches of a text column, ranked by `ts_rank_cd`.
+///
+/// Create an index on `to_tsvector(config, column)` to avoid scanning the table.
+inline Retriever keyword_retriever(
+    std::string_view table,
+    std::string_view column,
+    std::string_view query,
+    size_t limit,
+    std::string_view config = "english",
+    std::string_view id_column = "id"
+) {
+    // the config is a literal so an expression index can match
+    std::string document = "to_tsvector(" + detail::quote_literal(config) + ", "
+        + detail::quote_name(column) + ")";
+    return Retriever{
+        .sql = "SELECT " + detail::quote_name(id_column) + ", ts_rank_cd(" + document
+            + ", query) AS score FROM " + detail::quote_name(table) + ", plainto_tsquery("
+            + detail::quote_literal(config) + ", $1) query WHERE " + document
+            + " @@ query ORDER BY score DESC LIMIT $2",
+        .params = pqxx::params{std::string{query}, static_cast<int64_t>(limit)}
+    };
+}
+
+/// Runs several retrievers concurrently and fuses their results.
+///
+/// Each retriever runs on its own thread and connection, so semantic and keyword scans run in
+/// parallel on the server instead of one after the other in a single query. Connections are
+/// opened on first use and reused. Searches on the same object run one at a time.
+class HybridSearch {
+  public:
+    /// Creates a hybrid search.
+    explicit HybridSearch(std::string conninfo, const HybridOptions& options = {}) :
+        conninfo_{std::move(conninfo)},
+        options_{options} {}
+
+    HybridSearch(const HybridSearch&) = delete;
+    HybridSearch& operator=(const HybridSearch&) = delete;
+
+    /// Returns the options.
+    const HybridOptions& options() const {
+        return options_;
+    }
+
+    /// Returns the top results across retrievers, best first.
+    std::vector<HybridResult> search(const std::vector<Retriever>& retrievers, size_t limit) {
+        PGVECTOR_INSTRUMENT(Search, "hybrid");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        std::lock_guard lock{mutex_};
+
+        size_t n = retrievers.size();
+        while (connections_.size() < n) {
+            connections_.emplace_back();
+        }
+        std::vector<std::vector<HybridResult>> results(n);
+        std::vector<std::exception_ptr> errors(n);
+
+        auto run = [&](size_t i) {
+            try {
+                results[i] = retrieve(i, retrievers[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                connections_[i].reset();
+            }
+        };
+
+        // run the first retriever on this thread
+        std::vector<std::thread> threads;
+        threads.reserve(n);
+        for (size_t i = 1; i < n; i++) {
+            threads.emplace_back(run, i);
+        }
+        if (n > 0) {
+            run(0);
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (const auto& e : errors) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+
+        return detail::fuse(retrievers, results, limit, options_);
+    }
+
+  private:
+    std::vector<HybridResult> retrieve(size_t i, const Retriever& retriever) {
+        std::unique_ptr<pqxx::connection>& conn = connections_[i];
+        if (!conn || !conn->is_open()) {
+            conn = std::make_unique<pqxx::connection>(conninfo_);
+        }
+        pqxx::nontransaction tx{*conn};
+        pqxx::result rows = tx.exec(retriever.sql, retriever.params);
+        if (rows.columns() < 2) {
+            throw std::invalid_argument{"expected retriever to return id and score columns"};
+        }
+
+        std::vector<HybridResult> result;
+        result.reserve(rows.size());
+        for (const auto& row : rows) {
+            result.push_back({row[0].as<int64_t>(), row[1].as<double>()});
+        }
+        return result;
+    }
+
+    std::string conninfo_;
+    HybridOptions options_;
+    std::vector<std::unique_ptr<pqxx::connection>> connections_;
+    std::mutex mutex_;
+};
+} // namespace pgvector
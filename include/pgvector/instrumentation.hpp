@@ -0,0 +1,291 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Hooks are compiled in only when PGVECTOR_INSTRUMENTATION is defined, and must be defined the
+// same way in every translation unit.
+#ifdef PGVECTOR_INSTRUMENTATION
+    #define PGVECTOR_INSTRUMENT(operation, name) \
+        ::pgvector::detail::ScopedEvent pgvector_event_{::pgvector::Operation::operation, name}
+    #define PGVECTOR_INSTRUMENT_SIZE(bytes, elements) pgvector_event_.size(bytes, elements)
+#else
+    #define PGVECTOR_INSTRUMENT(operation, name) static_cast<void>(0)
+    #define PGVECTOR_INSTRUMENT_SIZE(bytes, elements) static_cast<void>(0)
+#endif
+
+namespace pgvector {
+/// An instrumented operation.
+enum class Operation {
+    /// Converting a value to text.
+    Encode,
+
+    /// Converting text to a value.
+    Decode,
+
+    /// Adding vectors to an index.
+    Insert,
+
+    /// Searching an index.
+    Search
+};
+
+/// A completed call.
+struct Event {
+    /// The operation.
+    Operation operation;
+
+    /// The type or index, like `"vector"` or `"hnsw"`.
+    std::string_view name;
+
+    /// The number of bytes of text, or zero for inserts and searches.
+    size_t bytes;
+
+    /// The number of elements for conversions, or vectors for inserts and searches.
+    size_t elements;
+
+    /// The duration in nanoseconds.
+    uint64_t nanoseconds;
+};
+
+/// Receives events from instrumented calls. Implementations must be thread-safe.
+class Observer {
+  public:
+    virtual ~Observer() = default;
+
+    /// Records an event.
+    virtual void record(const Event& event) = 0;
+};
+
+/// Metrics for an operation.
+struct Metrics {
+    /// The number of buckets in the histogram.
+    static constexpr size_t buckets = 64;
+
+    /// The number of calls.
+    uint64_t count = 0;
+
+    /// The total number of bytes.
+    uint64_t bytes = 0;
+
+    /// The total number of elements.
+    uint64_t elements = 0;
+
+    /// The total duration in nanoseconds.
+    uint64_t nanoseconds = 0;
+
+    /// The number of calls by duration, where bucket `i` counts durations less than `2^i`
+    /// nanoseconds that are not in an earlier bucket.
+    std::array<uint64_t, buckets> histogram{};
+
+    /// Returns an upper bound on the duration in nanoseconds at a quantile from 0 to 1.
+    uint64_t percentile(double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        double target = std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets; i++) {
+            seen += histogram[i];
+            if (seen > 0 && static_cast<double>(seen) >= target) {
+                return i == buckets - 1 ? UINT64_MAX : (uint64_t{1} << i) - 1;
+            }
+        }
+        return UINT64_MAX;
+    }
+};
+
+/// @cond
+namespace detail {
+// written only by the owning thread, so it can load and store without read-modify-writes, and
+// readers can sum with relaxed loads
+struct alignas(64) ThreadMetrics {
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> elements{0};
+        std::atomic<uint64_t> nanoseconds{0};
+        std::array<std::atomic<uint64_t>, Metrics::buckets> histogram{};
+    };
+
+    std::array<Counters, 4> operations;
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void add(const Event& event) {
+        Counters& c = operations[static_cast<size_t>(event.operation)];
+        increment(c.count, 1);
+        increment(c.bytes, event.bytes);
+        increment(c.elements, event.elements);
+        increment(c.nanoseconds, event.nanoseconds);
+        size_t bucket = std::min(
+            static_cast<size_t>(std::bit_width(event.nanoseconds)), Metrics::buckets - 1
+        );
+        increment(c.histogram[bucket], 1);
+    }
+};
+
+inline void add_counters(Metrics& metrics, const ThreadMetrics::Counters& c) {
+    metrics.count += c.count.load(std::memory_order_relaxed);
+    metrics.bytes += c.bytes.load(std::memory_order_relaxed);
+    metrics.elements += c.elements.load(std::memory_order_relaxed);
+    metrics.nanoseconds += c.nanoseconds.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < Metrics::buckets; i++) {
+        metrics.histogram[i] += c.histogram[i].load(std::memory_order_relaxed);
+    }
+}
+
+// live threads, plus totals from exited threads so totals never go backwards
+struct MetricsRegistry {
+    std::mutex mutex;
+    std::vector<ThreadMetrics*> threads;
+    std::array<Metrics, 4> retired{};
+};
+
+inline MetricsRegistry& metrics_registry() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// registers the metrics for a thread, and folds them into the retired totals when it exits
+class ThreadMetricsOwner {
+  public:
+    ThreadMetricsOwner() {
+        MetricsRegistry& registry = metrics_registry();
+        std::lock_guard lock{registry.mutex};
+        registry.threads.push_back(&metrics_);
+    }
+
+    ThreadMetricsOwner(const ThreadMetricsOwner&) = delete;
+    ThreadMetricsOwner& operator=(const ThreadMetricsOwner&) = delete;
+
+    ~ThreadMetricsOwner() {
+        MetricsRegistry& registry = metrics_registry();
+        std::lock_guard lock{registry.mutex};
+        for (size_t i = 0; i < registry.retired.size(); i++) {
+            add_counters(registry.retired[i], metrics_.operations[i]);
+        }
+        std::erase(registry.threads, &metrics_);
+    }
+
+    ThreadMetrics& metrics() {
+        return metrics_;
+    }
+
+  private:
+    ThreadMetrics metrics_;
+};
+
+inline ThreadMetrics& thread_metrics() {
+    thread_local ThreadMetricsOwner owner;
+    return owner.metrics();
+}
+
+inline std::atomic<Observer*>& current_observer() {
+    static std::atomic<Observer*> observer{nullptr};
+    return observer;
+}
+
+inline void record(const Event& event) {
+    Observer* observer = current_observer().load(std::memory_order_acquire);
+    if (observer != nullptr) {
+        observer->record(event);
+    } else {
+        thread_metrics().add(event);
+    }
+}
+
+// records the duration of a scope unless it exits with an exception
+class ScopedEvent {
+  public:
+    ScopedEvent(Operation operation, std::string_view name) :
+        operation_{operation},
+        name_{name},
+        exceptions_{std::uncaught_exceptions()},
+        start_{std::chrono::steady_clock::now()} {}
+
+    ScopedEvent(const ScopedEvent&) = delete;
+    ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+    ~ScopedEvent() {
+        if (std::uncaught_exceptions() > exceptions_) {
+            return;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        record({
+            operation_, name_, bytes_, elements_,
+            static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+            )
+        });
+    }
+
+    void size(size_t bytes, size_t elements) {
+        bytes_ = bytes;
+        elements_ = elements;
+    }
+
+  private:
+    Operation operation_;
+    std::string_view name_;
+    int exceptions_;
+    std::chrono::steady_clock::time_point start_;
+    size_t bytes_ = 0;
+    size_t elements_ = 0;
+};
+} // namespace detail
+/// @endcond
+
+/// Sends events to an observer, or to the default per-thread metrics if `nullptr`. The observer
+/// must outlive any instrumented calls.
+inline void set_observer(Observer* observer) {
+    detail::current_observer().store(observer, std::memory_order_release);
+}
+
+/// Returns the metrics for an operation from the default observer, summed across threads.
+inline Metrics metrics(Operation operation) {
+    detail::MetricsRegistry& registry = detail::metrics_registry();
+    std::lock_guard lock{registry.mutex};
+    Metrics result = registry.retired[static_cast<size_t>(operation)];
+    for (const auto* t : registry.threads) {
+        detail::add_counters(result, t->operations[static_cast<size_t>(operation)]);
+    }
+    return result;
+}
+
+/// Resets the metrics from the default observer. Threads recording at the same time may keep
+/// some of their earlier counts.
+inline void reset_metrics() {
+    detail::MetricsRegistry& registry = detail::metrics_registry();
+    std::lock_guard lock{registry.mutex};
+    registry.retired = {};
+    for (auto* t : registry.threads) {
+        for (auto& c : t->operations) {
+            c.count.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+            c.elements.store(0, std::memory_order_relaxed);
+            c.nanoseconds.store(0, std::memory_order_relaxed);
+            for (auto& h : c.histogram) {
+                h.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+} // namespace pgvector
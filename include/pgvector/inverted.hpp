@@ -0,0 +1,433 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "neighbor.hpp"
+#include "parallel.hpp"
+#include "sparsevec.hpp"
+
+namespace pgvector {
+/// Inverted index options.
+struct InvertedOptions {
+    /// The number of postings in each block, which is the unit of skipping.
+    size_t block_size = 128;
+
+    /// The number of threads for building and search, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// @cond
+namespace detail {
+inline constexpr uint32_t end_of_postings = std::numeric_limits<uint32_t>::max();
+
+// the largest contribution of a posting with a value in [min, max], which is never negative
+// since vectors without the term contribute zero
+inline double contribution_bound(float weight, float min, float max) {
+    double bound = weight > 0 ? static_cast<double>(weight) * max
+                              : static_cast<double>(weight) * min;
+    return bound > 0 ? bound : 0;
+}
+
+struct PostingCursor {
+    const uint32_t* rows;
+    const float* values;
+    size_t size;
+    size_t pos;
+    const uint32_t* block_last;
+    const float* block_max;
+    const float* block_min;
+    size_t blocks;
+    // a lower bound on the block of the next target, since targets only increase
+    size_t current;
+    size_t block_size;
+    float weight;
+    double bound;
+
+    uint32_t row() const {
+        return pos < size ? rows[pos] : end_of_postings;
+    }
+
+    // the first block that may contain target or a later row
+    size_t block(uint32_t target) {
+        current = std::max(current, pos / block_size);
+        while (current < blocks && block_last[current] < target) {
+            current++;
+        }
+        return current;
+    }
+
+    // moves to the first row greater than or equal to target
+    void seek(uint32_t target) {
+        size_t b = block(target);
+        if (b == blocks) {
+            pos = size;
+            return;
+        }
+        const uint32_t* begin = rows + std::max(pos, b * block_size);
+        const uint32_t* end = rows + std::min((b + 1) * block_size, size);
+        pos = static_cast<size_t>(std::lower_bound(begin, end, target) - rows);
+    }
+};
+} // namespace detail
+/// @endcond
+
+/// An in-memory inverted index for exact inner product search of sparse vectors.
+///
+/// Each dimension has a posting list of the vectors with a non-zero value for it, stored
+/// contiguously and split into blocks that record their largest and smallest values. Searches
+/// use MaxScore with block maxima to skip vectors that cannot make the top k, and return the
+/// same neighbors and distances as `FlatIndex` with `Metric::InnerProduct` among vectors that
+/// share a dimension with the query.
+class InvertedIndex {
+  public:
+    /// Creates an empty index.
+    explicit InvertedIndex(size_t dimensions, const InvertedOptions& options = {}) :
+        dimensions_{dimensions},
+        options_{options} {
+        if (options.block_size == 0) {
+            throw std::invalid_argument{"block_size must be greater than 0"};
+        }
+        offsets_.push_back(0);
+        list_offsets_.assign(dimensions + 1, 0);
+        block_offsets_.assign(dimensions + 1, 0);
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the number of vectors added.
+    size_t size() const {
+        return ids_.size();
+    }
+
+    /// Returns the options.
+    const InvertedOptions& options() const {
+        return options_;
+    }
+
+    /// Returns whether posting lists include all vectors added.
+    bool built() const {
+        return built_ == ids_.size();
+    }
+
+    /// Reserves space for a number of vectors.
+    void reserve(size_t n) {
+        ids_.reserve(n);
+        offsets_.reserve(n + 1);
+    }
+
+    /// Adds a vector, which is searchable after the next `build`.
+    void add(int64_t id, const SparseVector& value) {
+        PGVECTOR_INSTRUMENT(Insert, "inverted");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        check_dimensions(value);
+        if (ids_.size() >= detail::end_of_postings) {
+            throw std::length_error{"inverted index cannot have more than 4294967294 vectors"};
+        }
+        indices_.insert(indices_.end(), value.indices().begin(), value.indices().end());
+        values_.insert(values_.end(), value.values().begin(), value.values().end());
+        offsets_.push_back(indices_.size());
+        ids_.push_back(id);
+    }
+
+    /// Adds a batch of vectors, which are searchable after the next `build`.
+    void add(std::span<const int64_t> ids, std::span<const SparseVector> values) {
+        if (ids.size() != values.size()) {
+            throw std::invalid_argument{"ids and values must be the same size"};
+        }
+        for (const auto& v : values) {
+            check_dimensions(v);
+        }
+        reserve(size() + ids.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            add(ids[i], values[i]);
+        }
+    }
+
+    /// Adds rows of `(id, vector)` tuples, like those from `pqxx::transaction_base::stream`.
+    template<typename R>
+    void load(R&& rows) {
+        for (const auto& [id, value] : rows) {
+            add(static_cast<int64_t>(id), value);
+        }
+    }
+
+    /// Builds posting lists for all vectors added, splitting the work across threads.
+    void build() {
+        size_t n = ids_.size();
+        size_t threads = std::min(detail::thread_count(options_.threads), std::max(n, size_t{1}));
+
+        // count postings for each chunk of rows so each thread writes its own range of a list
+        std::vector<size_t> counts(threads * dimensions_);
+        detail::parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+            size_t* c = counts.data() + t * dimensions_;
+            for (size_t k = offsets_[begin]; k < offsets_[end]; k++) {
+                c[static_cast<size_t>(indices_[k])]++;
+            }
+        });
+
+        list_offsets_.assign(dimensions_ + 1, 0);
+        size_t total = 0;
+        for (size_t d = 0; d < dimensions_; d++) {
+            list_offsets_[d] = total;
+            for (size_t t = 0; t < threads; t++) {
+                size_t count = counts[t * dimensions_ + d];
+                counts[t * dimensions_ + d] = total;
+                total += count;
+            }
+        }
+        list_offsets_[dimensions_] = total;
+
+        // chunks are in row order, so each list is sorted by row
+        rows_.resize(total);
+        postings_.resize(total);
+        detail::parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+            size_t* next = counts.data() + t * dimensions_;
+            for (size_t row = begin; row < end; row++) {
+                for (size_t k = offsets_[row]; k < offsets_[row + 1]; k++) {
+                    size_t p = next[static_cast<size_t>(indices_[k])]++;
+                    rows_[p] = static_cast<uint32_t>(row);
+                    postings_[p] = values_[k];
+                }
+            }
+        });
+
+        size_t block_size = options_.block_size;
+        block_offsets_.assign(dimensions_ + 1, 0);
+        size_t blocks = 0;
+        for (size_t d = 0; d < dimensions_; d++) {
+            block_offsets_[d] = blocks;
+            blocks += (list_offsets_[d + 1] - list_offsets_[d] + block_size - 1) / block_size;
+        }
+        block_offsets_[dimensions_] = blocks;
+
+        block_last_.resize(blocks);
+        block_max_.resize(blocks);
+        block_min_.resize(blocks);
+        list_max_.assign(dimensions_, 0);
+        list_min_.assign(dimensions_, 0);
+        detail::parallel_for(dimensions_, threads, [&](size_t begin, size_t end, size_t) {
+            for (size_t d = begin; d < end; d++) {
+                size_t list_begin = list_offsets_[d];
+                size_t list_end = list_offsets_[d + 1];
+                for (size_t b = block_offsets_[d]; b < block_offsets_[d + 1]; b++) {
+                    size_t first = list_begin + (b - block_offsets_[d]) * block_size;
+                    size_t last = std::min(first + block_size, list_end);
+                    auto [min, max] = std::minmax_element(
+                        postings_.begin() + static_cast<std::ptrdiff_t>(first),
+                        postings_.begin() + static_cast<std::ptrdiff_t>(last)
+                    );
+                    block_last_[b] = rows_[last - 1];
+                    block_max_[b] = *max;
+                    block_min_[b] = *min;
+                }
+                for (size_t b = block_offsets_[d]; b < block_offsets_[d + 1]; b++) {
+                    list_max_[d] = b == block_offsets_[d] ? block_max_[b]
+                                                          : std::max(list_max_[d], block_max_[b]);
+                    list_min_[d] = b == block_offsets_[d] ? block_min_[b]
+                                                          : std::min(list_min_[d], block_min_[b]);
+                }
+            }
+        });
+
+        built_ = n;
+    }
+
+    /// Returns the `k` vectors with the largest inner product, with the negative inner product
+    /// as the distance like `<#>`.
+    std::vector<Neighbor> search(const SparseVector& query, size_t k) const {
+        return std::move(search(std::span<const SparseVector>{&query, 1}, k).front());
+    }
+
+    /// Returns the `k` vectors with the largest inner product for each query.
+    std::vector<std::vector<Neighbor>> search(
+        std::span<const SparseVector> queries,
+        size_t k
+    ) const {
+        PGVECTOR_INSTRUMENT(Search, "inverted");
+        PGVECTOR_INSTRUMENT_SIZE(0, queries.size());
+
+        if (!built()) {
+            throw std::logic_error{"inverted index must be built"};
+        }
+        for (const auto& q : queries) {
+            check_dimensions(q);
+        }
+
+        std::vector<std::vector<Neighbor>> result(queries.size());
+        auto search_range = [&](size_t begin, size_t end, size_t) {
+            for (size_t q = begin; q < end; q++) {
+                result[q] = search_one(queries[q], k);
+            }
+        };
+        detail::parallel_for(queries.size(), options_.threads, search_range);
+        return result;
+    }
+
+  private:
+    void check_dimensions(const SparseVector& value) const {
+        if (static_cast<size_t>(value.dimensions()) != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.dimensions())
+            };
+        }
+    }
+
+    std::vector<Neighbor> search_one(const SparseVector& query, size_t k) const {
+        if (k == 0) {
+            return {};
+        }
+        TopK top{k};
+
+        // cursors are in dimension order so scores add up in the same order as sparse_dot
+        const std::vector<int>& indices = query.indices();
+        const std::vector<float>& weights = query.values();
+        std::vector<detail::PostingCursor> cursors;
+        cursors.reserve(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            size_t d = static_cast<size_t>(indices[i]);
+            size_t list_begin = list_offsets_[d];
+            size_t size = list_offsets_[d + 1] - list_begin;
+            if (size == 0) {
+                continue;
+            }
+            size_t block_begin = block_offsets_[d];
+            cursors.push_back({
+                rows_.data() + list_begin, postings_.data() + list_begin, size, 0,
+                block_last_.data() + block_begin, block_max_.data() + block_begin,
+                block_min_.data() + block_begin, block_offsets_[d + 1] - block_begin, 0,
+                options_.block_size, weights[i],
+                detail::contribution_bound(weights[i], list_min_[d], list_max_[d])
+            });
+        }
+
+        // lists by increasing bound, so the lists that cannot reach the top k on their own
+        // are a prefix
+        size_t n = cursors.size();
+        std::vector<detail::PostingCursor*> lists;
+        lists.reserve(n);
+        for (auto& c : cursors) {
+            lists.push_back(&c);
+        }
+        std::ranges::sort(lists, {}, &detail::PostingCursor::bound);
+        std::vector<double> prefix(n + 1);
+        for (size_t i = 0; i < n; i++) {
+            prefix[i + 1] = prefix[i] + lists[i]->bound;
+        }
+        std::vector<double> block_bounds(n);
+
+        // the smallest score that can enter the top k, lowered slightly since bounds are
+        // summed in a different order than scores
+        double threshold = -std::numeric_limits<double>::infinity();
+        auto reaches = [&](double bound) {
+            return bound >= threshold;
+        };
+
+        // rows are only found in essential lists and scored in the others
+        size_t essential = 0;
+        while (true) {
+            while (essential < n && !reaches(prefix[essential + 1])) {
+                essential++;
+            }
+            if (essential == n) {
+                break;
+            }
+
+            uint32_t row = detail::end_of_postings;
+            for (size_t i = essential; i < n; i++) {
+                row = std::min(row, lists[i]->row());
+            }
+            if (row == detail::end_of_postings) {
+                break;
+            }
+
+            double bound = prefix[essential];
+            for (size_t i = essential; i < n; i++) {
+                const detail::PostingCursor& c = *lists[i];
+                if (c.row() == row) {
+                    bound += static_cast<double>(c.weight) * c.values[c.pos];
+                }
+            }
+
+            // tighten bounds with the blocks that could contain the row, then look it up
+            bool candidate = reaches(bound);
+            for (size_t i = 0; candidate && i < essential; i++) {
+                detail::PostingCursor& c = *lists[i];
+                size_t b = c.block(row);
+                block_bounds[i] = b < c.blocks
+                    ? detail::contribution_bound(c.weight, c.block_min[b], c.block_max[b])
+                    : 0;
+                bound += block_bounds[i] - c.bound;
+                candidate = reaches(bound);
+            }
+            for (size_t i = essential; candidate && i-- > 0;) {
+                detail::PostingCursor& c = *lists[i];
+                c.seek(row);
+                bound -= block_bounds[i];
+                if (c.row() == row) {
+                    bound += static_cast<double>(c.weight) * c.values[c.pos];
+                }
+                candidate = reaches(bound);
+            }
+
+            if (candidate) {
+                float score = 0;
+                for (const auto& c : cursors) {
+                    if (c.row() == row) {
+                        score += c.weight * c.values[c.pos];
+                    }
+                }
+                top.push(ids_[row], -score);
+                threshold = -static_cast<double>(top.threshold());
+                if (std::isfinite(threshold)) {
+                    threshold -= std::abs(threshold) * 1e-4;
+                }
+            }
+
+            for (size_t i = essential; i < n; i++) {
+                if (lists[i]->row() == row) {
+                    lists[i]->pos++;
+                }
+            }
+        }
+        return top.sorted();
+    }
+
+    size_t dimensions_;
+    InvertedOptions options_;
+    std::vector<int64_t> ids_;
+    std::vector<size_t> offsets_;
+    std::vector<int> indices_;
+    std::vector<float> values_;
+    size_t built_ = 0;
+    std::vector<size_t> list_offsets_;
+    std::vector<uint32_t> rows_;
+    std::vector<float> postings_;
+    std::vector<size_t> block_offsets_;
+    std::vector<uint32_t> block_last_;
+    std::vector<float> block_max_;
+    std::vector<float> block_min_;
+    std::vector<float> list_max_;
+    std::vector<float> list_min_;
+};
+} // namespace pgvector
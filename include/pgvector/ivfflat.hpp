@@ -0,0 +1,446 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "instrumentation.hpp"
+#include "math.hpp"
+#include "neighbor.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// IVFFlat index options.
+struct IvfflatOptions {
+    /// The distance metric.
+    Metric metric = Metric::L2;
+
+    /// The number of inverted lists.
+    size_t lists = 100;
+
+    /// The number of lists to search.
+    size_t probes = 1;
+
+    /// The max number of k-means iterations.
+    size_t max_iterations = 20;
+
+    /// The number of threads for training, or zero for all hardware threads.
+    size_t threads = 0;
+
+    /// The seed for k-means++.
+    uint64_t seed = 0;
+};
+
+/// An in-memory IVFFlat index for `Vector` or `HalfVector`.
+///
+/// The index must be trained before vectors are added. Each list is stored as one
+/// contiguous block.
+template<typename V>
+class IvfflatIndex {
+    static_assert(
+        std::is_same_v<V, Vector> || std::is_same_v<V, HalfVector>,
+        "IvfflatIndex requires Vector or HalfVector"
+    );
+
+  public:
+    /// The element type.
+    using value_type = typename V::value_type;
+
+    /// Creates an untrained index.
+    explicit IvfflatIndex(size_t dimensions, const IvfflatOptions& options = {}) :
+        dimensions_{dimensions},
+        options_{options},
+        lists_(options.lists) {
+        if (dimensions == 0) {
+            throw std::invalid_argument{"dimensions must be greater than 0"};
+        }
+        detail::check_vector_metric(options.metric);
+        if (options.lists < 1 || options.lists > 32768) {
+            throw std::invalid_argument{"lists must be between 1 and 32768"};
+        }
+        if (options.probes < 1) {
+            throw std::invalid_argument{"probes must be greater than 0"};
+        }
+        if (options.metric == Metric::L1) {
+            throw std::invalid_argument{"ivfflat does not support L1 distance"};
+        }
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the number of vectors added.
+    size_t size() const {
+        return size_;
+    }
+
+    /// Returns the options.
+    const IvfflatOptions& options() const {
+        return options_;
+    }
+
+    /// Returns whether the index has been trained.
+    bool trained() const {
+        return !centers_.empty();
+    }
+
+    /// Returns the number of vectors in each list.
+    std::vector<size_t> list_sizes() const {
+        std::vector<size_t> sizes;
+        sizes.reserve(lists_.size());
+        for (const auto& list : lists_) {
+            sizes.push_back(list.ids.size());
+        }
+        return sizes;
+    }
+
+    /// Finds the list centers with k-means++ and k-means on a sample of vectors. The index must
+    /// be empty, since stored vectors stay in the lists they were added to.
+    void train(std::span<const V> sample) {
+        if (size() > 0) {
+            throw std::logic_error{"ivfflat index must be empty to train"};
+        }
+        if (sample.empty()) {
+            throw std::invalid_argument{"sample cannot be empty"};
+        }
+
+        std::vector<value_type> data(sample.size() * dimensions_);
+        for (size_t i = 0; i < sample.size(); i++) {
+            copy_normalized(sample[i].values(), data.data() + i * dimensions_);
+        }
+        train(data, sample.size());
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, const V& value) {
+        add(id, std::span<const value_type>{value.values()});
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, std::span<const value_type> value) {
+        PGVECTOR_INSTRUMENT(Insert, "ivfflat");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        check_trained();
+        List& list = lists_[nearest_list(value.data(), value.size())];
+        size_t offset = list.data.size();
+        list.data.resize(offset + dimensions_);
+        copy_normalized(value, list.data.data() + offset);
+        list.ids.push_back(id);
+        size_++;
+    }
+
+    /// Adds vectors, choosing lists in parallel.
+    void add(std::span<const int64_t> ids, std::span<const V> values) {
+        PGVECTOR_INSTRUMENT(Insert, "ivfflat");
+        PGVECTOR_INSTRUMENT_SIZE(0, values.size());
+
+        if (ids.size() != values.size()) {
+            throw std::invalid_argument{"ids and values must be the same size"};
+        }
+        check_trained();
+
+        std::vector<size_t> assignments(values.size());
+        auto assign = [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                const auto& v = values[i].values();
+                assignments[i] = nearest_list(v.data(), v.size());
+            }
+        };
+        detail::parallel_for(values.size(), options_.threads, assign);
+
+        for (size_t i = 0; i < values.size(); i++) {
+            List& list = lists_[assignments[i]];
+            size_t offset = list.data.size();
+            list.data.resize(offset + dimensions_);
+            copy_normalized(values[i].values(), list.data.data() + offset);
+            list.ids.push_back(ids[i]);
+        }
+        size_ += values.size();
+    }
+
+    /// Adds rows of `(id, vector)` tuples, like those from `pqxx::transaction_base::stream`.
+    template<typename R>
+    void load(R&& rows) {
+        for (const auto& [id, value] : rows) {
+            add(static_cast<int64_t>(id), value);
+        }
+    }
+
+    /// Returns the `k` nearest neighbors, using `probes` from the options.
+    std::vector<Neighbor> search(const V& query, size_t k) const {
+        return search(std::span<const value_type>{query.values()}, k, options_.probes);
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(const V& query, size_t k, size_t probes) const {
+        return search(std::span<const value_type>{query.values()}, k, probes);
+    }
+
+    /// Returns the `k` nearest neighbors, using `probes` from the options.
+    std::vector<Neighbor> search(std::span<const value_type> query, size_t k) const {
+        return search(query, k, options_.probes);
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(
+        std::span<const value_type> query,
+        size_t k,
+        size_t probes
+    ) const {
+        PGVECTOR_INSTRUMENT(Search, "ivfflat");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        detail::check_dimensions(query.size(), dimensions_);
+        check_trained();
+        if (k == 0) {
+            return {};
+        }
+
+        std::vector<value_type> normalized(dimensions_);
+        copy_normalized(query, normalized.data());
+        const value_type* q = normalized.data();
+
+        // find the nearest lists
+        std::vector<std::pair<float, size_t>> centers;
+        centers.reserve(lists_.size());
+        for (size_t i = 0; i < lists_.size(); i++) {
+            centers.emplace_back(distance(q, center(i)), i);
+        }
+        probes = std::min(probes, centers.size());
+        std::ranges::partial_sort(centers, centers.begin() + static_cast<std::ptrdiff_t>(probes));
+
+        // scan their blocks
+        TopK top{k};
+        for (size_t p = 0; p < probes; p++) {
+            const List& list = lists_[centers[p].second];
+            const value_type* v = list.data.data();
+            for (size_t i = 0; i < list.ids.size(); i++, v += dimensions_) {
+                float d = distance(q, v);
+                if (d <= top.threshold()) {
+                    top.push(list.ids[i], d);
+                }
+            }
+        }
+
+        std::vector<Neighbor> result = top.sorted();
+        if (options_.metric == Metric::L2) {
+            for (auto& v : result) {
+                v.distance = std::sqrt(v.distance);
+            }
+        }
+        return result;
+    }
+
+  private:
+    struct List {
+        std::vector<value_type> data;
+        std::vector<int64_t> ids;
+    };
+
+    void check_trained() const {
+        if (!trained()) {
+            throw std::logic_error{"ivfflat index must be trained"};
+        }
+    }
+
+    const value_type* center(size_t i) const {
+        return centers_.data() + i * dimensions_;
+    }
+
+    void copy_normalized(std::span<const value_type> value, value_type* out) const {
+        if (value.size() != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(value.size())
+            };
+        }
+        std::ranges::copy(value, out);
+        if (options_.metric == Metric::Cosine) {
+            detail::normalize(out, dimensions_);
+        }
+    }
+
+    // internal distance, which is squared for L2 and assumes normalized vectors for cosine
+    float distance(const value_type* a, const value_type* b) const {
+        switch (options_.metric) {
+            case Metric::L2:
+                return detail::squared_l2(a, b, dimensions_);
+            case Metric::InnerProduct:
+                return -detail::dot(a, b, dimensions_);
+            case Metric::Cosine:
+                return 1 - detail::dot(a, b, dimensions_);
+            case Metric::L1:
+            case Metric::Hamming:
+            case Metric::Jaccard:
+                break;
+        }
+        return 0;
+    }
+
+    size_t nearest_list(const value_type* v, size_t dimensions) const {
+        detail::check_dimensions(dimensions, dimensions_);
+
+        std::vector<value_type> normalized;
+        if (options_.metric == Metric::Cosine) {
+            normalized.assign(v, v + dimensions_);
+            detail::normalize(normalized.data(), dimensions_);
+            v = normalized.data();
+        }
+
+        size_t best = 0;
+        float best_distance = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < lists_.size(); i++) {
+            float d = distance(v, center(i));
+            if (d < best_distance) {
+                best = i;
+                best_distance = d;
+            }
+        }
+        return best;
+    }
+
+    // clusters with L2 distance like the server, normalizing centers for cosine
+    void train(const std::vector<value_type>& data, size_t n) {
+        size_t k = lists_.size();
+        size_t dim = dimensions_;
+        size_t threads = std::min(detail::thread_count(options_.threads), n);
+        std::mt19937_64 prng{options_.seed};
+        std::vector<value_type> centers(k * dim);
+        auto point = [&](size_t i) { return data.data() + i * dim; };
+
+        // k-means++
+        std::vector<float> min_distances(n, std::numeric_limits<float>::infinity());
+        std::vector<double> partial_sums(threads);
+        std::uniform_int_distribution<size_t> first{0, n - 1};
+        size_t initial = first(prng);
+        std::copy(point(initial), point(initial) + dim, centers.data());
+        for (size_t c = 1; c < k; c++) {
+            const value_type* prev = centers.data() + (c - 1) * dim;
+            detail::parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+                double sum = 0;
+                for (size_t i = begin; i < end; i++) {
+                    float d = detail::squared_l2(point(i), prev, dim);
+                    min_distances[i] = std::min(min_distances[i], d);
+                    sum += min_distances[i];
+                }
+                partial_sums[t] = sum;
+            });
+
+            double total = 0;
+            for (auto s : partial_sums) {
+                total += s;
+            }
+
+            size_t chosen = first(prng);
+            if (total > 0) {
+                double target = std::uniform_real_distribution<double>{0, total}(prng);
+                for (size_t i = 0; i < n; i++) {
+                    target -= min_distances[i];
+                    if (target <= 0) {
+                        chosen = i;
+                        break;
+                    }
+                }
+            }
+            std::copy(point(chosen), point(chosen) + dim, centers.data() + c * dim);
+        }
+
+        // k-means
+        std::vector<size_t> assignments(n, k);
+        std::vector<std::vector<double>> sums(threads, std::vector<double>(k * dim));
+        std::vector<std::vector<size_t>> counts(threads, std::vector<size_t>(k));
+        std::vector<size_t> changes(threads);
+        for (size_t iteration = 0; iteration < options_.max_iterations; iteration++) {
+            detail::parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+                std::ranges::fill(sums[t], 0.0);
+                std::ranges::fill(counts[t], 0);
+                changes[t] = 0;
+                for (size_t i = begin; i < end; i++) {
+                    const value_type* p = point(i);
+                    size_t best = 0;
+                    float best_distance = std::numeric_limits<float>::infinity();
+                    for (size_t c = 0; c < k; c++) {
+                        float d = detail::squared_l2(p, centers.data() + c * dim, dim);
+                        if (d < best_distance) {
+                            best = c;
+                            best_distance = d;
+                        }
+                    }
+                    if (assignments[i] != best) {
+                        assignments[i] = best;
+                        changes[t]++;
+                    }
+                    double* s = sums[t].data() + best * dim;
+                    for (size_t j = 0; j < dim; j++) {
+                        s[j] += static_cast<double>(p[j]);
+                    }
+                    counts[t][best]++;
+                }
+            });
+
+            size_t changed = 0;
+            for (auto c : changes) {
+                changed += c;
+            }
+            if (changed == 0) {
+                break;
+            }
+
+            for (size_t c = 0; c < k; c++) {
+                size_t count = 0;
+                for (size_t t = 0; t < threads; t++) {
+                    count += counts[t][c];
+                }
+
+                value_type* center = centers.data() + c * dim;
+                if (count == 0) {
+                    // reseed empty lists
+                    size_t i = first(prng);
+                    std::copy(point(i), point(i) + dim, center);
+                } else {
+                    for (size_t j = 0; j < dim; j++) {
+                        double sum = 0;
+                        for (size_t t = 0; t < threads; t++) {
+                            sum += sums[t][c * dim + j];
+                        }
+                        center[j] = static_cast<value_type>(sum / static_cast<double>(count));
+                    }
+                }
+
+                if (options_.metric == Metric::Cosine) {
+                    detail::normalize(center, dimensions_);
+                }
+            }
+        }
+
+        centers_ = std::move(centers);
+    }
+
+    size_t dimensions_;
+    IvfflatOptions options_;
+    std::vector<value_type> centers_;
+    std::vector<List> lists_;
+    size_t size_ = 0;
+};
+} // namespace pgvector
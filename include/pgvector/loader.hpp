@@ -0,0 +1,317 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include "instrumentation.hpp"
+#include "pqxx.hpp"
+#include "sql.hpp"
+
+namespace pgvector {
+/// Bulk loader options.
+struct LoaderOptions {
+    /// The number of connections, each with its own `COPY` stream and thread.
+    size_t connections = 4;
+
+    /// The number of rows handed to a connection at a time.
+    size_t batch_size = 1000;
+
+    /// The max number of rows waiting for a connection before `write_values` blocks.
+    size_t max_pending_rows = 100000;
+
+    /// The schema of the table, or empty to use the search path.
+    std::string schema = {};
+};
+
+/// Bulk loader statistics.
+struct LoaderStats {
+    /// The number of rows loaded.
+    size_t rows = 0;
+
+    /// The time to load rows.
+    std::chrono::duration<double> load_time{0};
+
+    /// The time to run statements after loading, like creating indexes.
+    std::chrono::duration<double> after_load_time{0};
+
+    /// Returns the number of rows loaded per second.
+    double rows_per_second() const {
+        return load_time.count() > 0 ? static_cast<double>(rows) / load_time.count() : 0;
+    }
+};
+
+/// @cond
+namespace detail {
+// blocks producers when full and consumers when empty
+template<typename T>
+class BoundedQueue {
+  public:
+    explicit BoundedQueue(size_t capacity) : capacity_{capacity} {}
+
+    // returns false if closed
+    bool push(T item) {
+        std::unique_lock lock{mutex_};
+        not_full_.wait(lock, [&] { return items_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // returns nullopt once closed and drained, or immediately if aborted
+    std::optional<T> pop() {
+        std::unique_lock lock{mutex_};
+        not_empty_.wait(lock, [&] { return !items_.empty() || closed_; });
+        if (items_.empty() || aborted_) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return item;
+    }
+
+    // lets consumers drain remaining items
+    void close() {
+        std::lock_guard lock{mutex_};
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    bool aborted() {
+        std::lock_guard lock{mutex_};
+        return aborted_;
+    }
+
+    // drops remaining items
+    void abort() {
+        std::lock_guard lock{mutex_};
+        closed_ = true;
+        aborted_ = true;
+        items_.clear();
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+  private:
+    size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    bool aborted_ = false;
+};
+} // namespace detail
+/// @endcond
+
+/// Loads rows into a table over several connections at once.
+///
+/// Rows are passed in batches to one thread per connection, which converts them to text and
+/// writes them to its own `COPY` stream, so conversion and the server both use multiple
+/// cores. Each connection loads in its own transaction. If one fails, the others roll back
+/// unless they have already committed.
+template<typename... T>
+class BulkLoader {
+  public:
+    /// Opens connections and starts a `COPY` on each.
+    BulkLoader(
+        std::string conninfo,
+        std::string table,
+        std::vector<std::string> columns,
+        const LoaderOptions& loader_options = {}
+    ) :
+        conninfo_{std::move(conninfo)},
+        table_{std::move(table)},
+        columns_{std::move(columns)},
+        options_{loader_options},
+        queue_{queue_capacity(loader_options)},
+        start_{std::chrono::steady_clock::now()} {
+        if (loader_options.connections == 0) {
+            throw std::invalid_argument{"connections must be greater than 0"};
+        }
+        if (loader_options.batch_size == 0) {
+            throw std::invalid_argument{"batch_size must be greater than 0"};
+        }
+        if (columns_.size() != sizeof...(T)) {
+            throw std::invalid_argument{"expected one column per value"};
+        }
+        batch_.reserve(options_.batch_size);
+        workers_.reserve(options_.connections);
+        try {
+            for (size_t i = 0; i < options_.connections; i++) {
+                workers_.emplace_back([this] { work(); });
+            }
+        } catch (...) {
+            // destroying a joinable thread terminates
+            queue_.abort();
+            for (auto& w : workers_) {
+                w.join();
+            }
+            throw;
+        }
+    }
+
+    BulkLoader(const BulkLoader&) = delete;
+    BulkLoader& operator=(const BulkLoader&) = delete;
+
+    /// Stops loading without committing if not completed.
+    ~BulkLoader() {
+        if (!completed_) {
+            queue_.abort();
+            for (auto& w : workers_) {
+                w.join();
+            }
+        }
+    }
+
+    /// Adds a row, blocking while too many rows are waiting.
+    void write_values(const T&... values) {
+        batch_.emplace_back(values...);
+        rows_++;
+        if (batch_.size() >= options_.batch_size) {
+            flush();
+        }
+    }
+
+    /// Adds a statement to run on one connection after all rows are loaded, like
+    /// `CREATE INDEX`.
+    void after_load(std::string sql) {
+        after_load_.push_back(std::move(sql));
+    }
+
+    /// Finishes loading, commits each connection, and runs statements added with `after_load`.
+    LoaderStats complete() {
+        if (completed_) {
+            throw std::logic_error{"already completed"};
+        }
+        if (!batch_.empty()) {
+            flush();
+        }
+        queue_.close();
+        for (auto& w : workers_) {
+            w.join();
+        }
+        completed_ = true;
+        rethrow();
+
+        LoaderStats stats;
+        stats.rows = rows_;
+        stats.load_time = std::chrono::steady_clock::now() - start_;
+
+        if (!after_load_.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            pqxx::connection conn{conninfo_};
+            pqxx::nontransaction tx{conn};
+            for (const auto& sql : after_load_) {
+                tx.exec(sql);
+            }
+            stats.after_load_time = std::chrono::steady_clock::now() - start;
+        }
+        return stats;
+    }
+
+  private:
+    using Row = std::tuple<T...>;
+
+    static size_t queue_capacity(const LoaderOptions& options) {
+        if (options.batch_size == 0) {
+            return 1;
+        }
+        return std::max(options.max_pending_rows / options.batch_size, static_cast<size_t>(1));
+    }
+
+    void flush() {
+        if (!queue_.push(std::move(batch_))) {
+            rethrow();
+            throw std::logic_error{"loader closed"};
+        }
+        batch_ = {};
+        batch_.reserve(options_.batch_size);
+    }
+
+    void work() {
+        try {
+            pqxx::connection conn{conninfo_};
+            pqxx::work tx{conn};
+            std::string columns;
+            for (const auto& c : columns_) {
+                if (!columns.empty()) {
+                    columns += ",";
+                }
+                columns += detail::quote_name(c);
+            }
+            std::string table = detail::quote_name(table_);
+            if (!options_.schema.empty()) {
+                table = detail::quote_name(options_.schema) + "." + table;
+            }
+            auto stream = pqxx::stream_to::raw_table(tx, table, columns);
+            while (auto batch = queue_.pop()) {
+                PGVECTOR_INSTRUMENT(Insert, "loader");
+                PGVECTOR_INSTRUMENT_SIZE(0, batch->size());
+
+                for (const auto& row : *batch) {
+                    std::apply([&](const auto&... v) { stream.write_values(v...); }, row);
+                }
+            }
+            // roll back if the destructor or another connection stopped loading
+            if (!queue_.aborted()) {
+                stream.complete();
+                tx.commit();
+            }
+        } catch (...) {
+            {
+                std::lock_guard lock{error_mutex_};
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+            }
+            queue_.abort();
+        }
+    }
+
+    void rethrow() {
+        std::lock_guard lock{error_mutex_};
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    std::string conninfo_;
+    std::string table_;
+    std::vector<std::string> columns_;
+    LoaderOptions options_;
+    detail::BoundedQueue<std::vector<Row>> queue_;
+    std::vector<Row> batch_;
+    size_t rows_ = 0;
+    std::vector<std::string> after_load_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<std::thread> workers_;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+    bool completed_ = false;
+};
+} // namespace pgvector
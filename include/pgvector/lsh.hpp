@@ -0,0 +1,263 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch.hpp"
+#include "distance.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// SimHash options.
+struct SimHashOptions {
+    /// The number of bits in each signature.
+    size_t bits = 64;
+
+    /// The number of bands for grouping, which must divide `bits` into at most 64 bits each.
+    /// More bands find more near-duplicates but compare more pairs.
+    size_t bands = 8;
+
+    /// The max Hamming distance between signatures of near-duplicates.
+    size_t max_distance = 3;
+
+    /// The number of threads, or zero for all hardware threads.
+    size_t threads = 0;
+
+    /// The random seed for the hyperplanes.
+    uint64_t seed = 1;
+};
+
+/// Random-hyperplane locality-sensitive hashing for finding near-duplicate vectors.
+///
+/// The fraction of signature bits that differ estimates the angle between vectors divided by
+/// pi. Signatures are packed with the first bit in the high bit of the first byte, so
+/// `unpack_bits` gives a literal for a `bit(n)` column.
+class SimHash {
+  public:
+    /// Creates random hyperplanes.
+    explicit SimHash(size_t dimensions, const SimHashOptions& options = {}) :
+        dimensions_{dimensions},
+        options_{options},
+        planes_{dimensions, options.bits} {
+        if (dimensions == 0) {
+            throw std::invalid_argument{"dimensions must be greater than 0"};
+        }
+        if (options.bits == 0) {
+            throw std::invalid_argument{"bits must be greater than 0"};
+        }
+        if (options.bands == 0 || options.bits % options.bands != 0
+            || options.bits / options.bands > 64) {
+            throw std::invalid_argument{"bands must divide bits into at most 64 bits each"};
+        }
+
+        std::mt19937_64 prng{options.seed};
+        std::normal_distribution<float> dist;
+        for (size_t i = 0; i < options.bits; i++) {
+            for (auto& v : planes_.row(i)) {
+                v = dist(prng);
+            }
+        }
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the options.
+    const SimHashOptions& options() const {
+        return options_;
+    }
+
+    /// Returns the packed signature of a vector.
+    std::vector<uint8_t> signature(std::span<const float> value) const {
+        std::vector<uint8_t> result(bytes());
+        sign(value, result.data());
+        return result;
+    }
+
+    /// Returns the packed signature of a vector.
+    std::vector<uint8_t> signature(const Vector& value) const {
+        return signature(std::span<const float>{value.values()});
+    }
+
+    /// Returns the packed signatures of vectors, computed in parallel.
+    VectorBatch<uint8_t> signatures(std::span<const Vector> values) const {
+        VectorBatch<uint8_t> result{bytes(), values.size()};
+        auto run = [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                sign(values[i].values(), result.row(i).data());
+            }
+        };
+        detail::parallel_for(values.size(), options_.threads, run);
+        return result;
+    }
+
+    /// Returns the packed signatures of vectors, computed in parallel.
+    VectorBatch<uint8_t> signatures(const VectorBatch<float>& values) const {
+        detail::check_dimensions(values.dimensions(), dimensions_);
+        VectorBatch<uint8_t> result{bytes(), values.rows()};
+        auto run = [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                sign(values.row(i), result.row(i).data());
+            }
+        };
+        detail::parallel_for(values.rows(), options_.threads, run);
+        return result;
+    }
+
+    /// Groups near-duplicates and returns the index of the first vector in each vector's group.
+    ///
+    /// Vectors whose signatures match in any band are candidates, and candidates within
+    /// `max_distance` bits are grouped, along with anything grouped with them.
+    std::vector<size_t> group(const VectorBatch<uint8_t>& signatures) const {
+        if (signatures.dimensions() != bytes()) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(bytes()) + " bytes, not "
+                + std::to_string(signatures.dimensions())
+            };
+        }
+
+        size_t n = signatures.rows();
+        size_t width = options_.bits / options_.bands;
+
+        // bucket each band by sorting, then find pairs within buckets
+        std::vector<std::vector<std::pair<size_t, size_t>>> edges(options_.bands);
+        auto bucket = [&](size_t begin, size_t end, size_t) {
+            std::vector<std::pair<uint64_t, size_t>> keys(n);
+            std::vector<std::vector<size_t>> groups;
+            for (size_t b = begin; b < end; b++) {
+                for (size_t i = 0; i < n; i++) {
+                    keys[i] = {band(signatures.row(i), b * width, width), i};
+                }
+                std::ranges::sort(keys);
+
+                for (size_t start = 0; start < n;) {
+                    size_t stop = start + 1;
+                    while (stop < n && keys[stop].first == keys[start].first) {
+                        stop++;
+                    }
+                    if (stop - start > 1) {
+                        auto members = std::span{keys}.subspan(start, stop - start);
+                        link(signatures, members, groups, edges[b]);
+                    }
+                    start = stop;
+                }
+            }
+        };
+        detail::parallel_for(options_.bands, options_.threads, bucket);
+
+        std::vector<size_t> parent(n);
+        std::iota(parent.begin(), parent.end(), 0);
+        for (const auto& band_edges : edges) {
+            for (const auto& [a, b] : band_edges) {
+                size_t ra = find(parent, a);
+                size_t rb = find(parent, b);
+                // keep the smallest index as the root
+                if (ra < rb) {
+                    parent[rb] = ra;
+                } else if (rb < ra) {
+                    parent[ra] = rb;
+                }
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            parent[i] = find(parent, i);
+        }
+        return parent;
+    }
+
+    /// Groups near-duplicates and returns the index of the first vector in each vector's group.
+    std::vector<size_t> group(std::span<const Vector> values) const {
+        return group(signatures(values));
+    }
+
+  private:
+    size_t bytes() const {
+        return (options_.bits + 7) / 8;
+    }
+
+    void sign(std::span<const float> value, uint8_t* out) const {
+        detail::check_dimensions(value.size(), dimensions_);
+        std::fill(out, out + bytes(), static_cast<uint8_t>(0));
+        for (size_t i = 0; i < options_.bits; i++) {
+            if (detail::dot(planes_.row(i).data(), value.data(), dimensions_) >= 0) {
+                out[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+            }
+        }
+    }
+
+    static uint64_t band(std::span<const uint8_t> signature, size_t start, size_t width) {
+        uint64_t key = 0;
+        for (size_t i = start; i < start + width; i++) {
+            key = (key << 1) | ((signature[i / 8] >> (7 - i % 8)) & 1);
+        }
+        return key;
+    }
+
+    bool close(const VectorBatch<uint8_t>& signatures, size_t a, size_t b) const {
+        return detail::hamming(signatures.row(a).data(), signatures.row(b).data(), bytes())
+            <= options_.max_distance;
+    }
+
+    // checks each member against the groups so far, stopping at the first close member of each,
+    // so a bucket of near-identical vectors takes one check per member
+    void link(
+        const VectorBatch<uint8_t>& signatures,
+        std::span<const std::pair<uint64_t, size_t>> bucket,
+        std::vector<std::vector<size_t>>& groups,
+        std::vector<std::pair<size_t, size_t>>& edges
+    ) const {
+        groups.clear();
+        for (const auto& member : bucket) {
+            size_t a = member.second;
+            std::vector<size_t>* joined = nullptr;
+            for (auto& group : groups) {
+                for (size_t c : group) {
+                    if (close(signatures, a, c)) {
+                        edges.emplace_back(a, c);
+                        if (joined == nullptr) {
+                            group.push_back(a);
+                            joined = &group;
+                        } else {
+                            joined->insert(joined->end(), group.begin(), group.end());
+                            group.clear();
+                        }
+                        break;
+                    }
+                }
+            }
+            if (joined == nullptr) {
+                groups.push_back({a});
+            }
+        }
+    }
+
+    static size_t find(std::vector<size_t>& parent, size_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    size_t dimensions_;
+    SimHashOptions options_;
+    VectorBatch<float> planes_;
+};
+} // namespace pgvector
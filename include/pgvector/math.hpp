@@ -0,0 +1,322 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include "batch.hpp"
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Batch operation options.
+struct BatchOptions {
+    /// The number of threads, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// @cond
+namespace detail {
+#if defined(__AVX__) && defined(__FMA__)
+inline void store8(float* p, __m256 v) {
+    _mm256_storeu_ps(p, v);
+}
+
+#if defined(__F16C__)
+inline void store8(Half* p, __m256 v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+#endif
+#endif
+
+// a[i] += s * b[i], where a can be a float accumulator for half vectors
+template<typename A, typename B>
+void add_scaled(A* a, const B* b, float s, size_t n) {
+    size_t i = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<A> && has_simd<B>) {
+        __m256 vs = _mm256_set1_ps(s);
+        for (; i + 8 <= n; i += 8) {
+            store8(a + i, _mm256_fmadd_ps(load8(b + i), vs, load8(a + i)));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        a[i] = static_cast<A>(static_cast<float>(a[i]) + s * static_cast<float>(b[i]));
+    }
+}
+
+template<typename T>
+void multiply(T* a, float s, size_t n) {
+    size_t i = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<T>) {
+        __m256 vs = _mm256_set1_ps(s);
+        for (; i + 8 <= n; i += 8) {
+            store8(a + i, _mm256_mul_ps(load8(a + i), vs));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        a[i] = static_cast<T>(static_cast<float>(a[i]) * s);
+    }
+}
+
+// used by the indexes too, and divides instead of multiplying by the reciprocal so results
+// are the same as dividing each element
+template<typename T>
+void normalize(T* a, size_t n) {
+    float norm = std::sqrt(dot(a, a, n));
+    if (norm == 0) {
+        return;
+    }
+    size_t i = 0;
+#if defined(__AVX__) && defined(__FMA__)
+    if constexpr (has_simd<T>) {
+        __m256 vn = _mm256_set1_ps(norm);
+        for (; i + 8 <= n; i += 8) {
+            store8(a + i, _mm256_div_ps(load8(a + i), vn));
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        a[i] = static_cast<T>(static_cast<float>(a[i]) / norm);
+    }
+}
+
+// splitting a small batch across threads costs more than it saves
+inline size_t batch_threads(size_t threads, size_t rows, size_t dimensions) {
+    constexpr size_t min_elements = 1 << 16;
+    size_t elements = std::max(rows * dimensions, size_t{1});
+    return std::min(thread_count(threads), (elements + min_elements - 1) / min_elements);
+}
+
+template<typename T, typename F>
+void for_each_row(VectorBatch<T>& batch, const BatchOptions& options, F&& f) {
+    size_t threads = batch_threads(options.threads, batch.rows(), batch.dimensions());
+    parallel_for(batch.rows(), threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            f(batch.row(i));
+        }
+    });
+}
+
+template<typename T>
+Vector weighted_mean(
+    size_t dimensions,
+    size_t rows,
+    const T* const* values,
+    std::span<const float> weights,
+    const BatchOptions& options
+) {
+    if (rows == 0) {
+        throw std::invalid_argument{"expected at least one vector"};
+    }
+    if (!weights.empty() && weights.size() != rows) {
+        throw std::invalid_argument{"weights and values must be the same size"};
+    }
+
+    // each thread sums into its own row so threads never share an accumulator
+    size_t threads = batch_threads(options.threads, rows, dimensions);
+    threads = std::min(threads, rows);
+    std::vector<float> sums(threads * dimensions);
+    std::vector<double> totals(threads);
+    parallel_for(rows, threads, [&](size_t begin, size_t end, size_t t) {
+        float* sum = sums.data() + t * dimensions;
+        for (size_t i = begin; i < end; i++) {
+            float w = weights.empty() ? 1.0f : weights[i];
+            add_scaled(sum, values[i], w, dimensions);
+            totals[t] += w;
+        }
+    });
+
+    double total = 0;
+    for (size_t t = 0; t < threads; t++) {
+        total += totals[t];
+    }
+    if (total == 0) {
+        throw std::invalid_argument{"weights must not sum to zero"};
+    }
+    for (size_t t = 1; t < threads; t++) {
+        add_scaled(sums.data(), sums.data() + t * dimensions, 1.0f, dimensions);
+    }
+    sums.resize(dimensions);
+    multiply(sums.data(), static_cast<float>(1 / total), dimensions);
+    return Vector{std::move(sums)};
+}
+} // namespace detail
+/// @endcond
+
+/// Returns the L2 norm of a vector.
+inline float norm(std::span<const float> value) {
+    return std::sqrt(detail::dot(value.data(), value.data(), value.size()));
+}
+
+/// Returns the L2 norm of a half vector.
+inline float norm(std::span<const Half> value) {
+    return std::sqrt(detail::dot(value.data(), value.data(), value.size()));
+}
+
+/// Returns the L2 norm of each vector in a batch.
+template<typename T>
+std::vector<float> norms(const VectorBatch<T>& batch, const BatchOptions& options = {}) {
+    std::vector<float> result(batch.rows());
+    size_t threads = detail::batch_threads(options.threads, batch.rows(), batch.dimensions());
+    detail::parallel_for(batch.rows(), threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            result[i] = norm(batch.row(i));
+        }
+    });
+    return result;
+}
+
+/// Normalizes a vector to unit length in place, leaving zero vectors unchanged.
+///
+/// Inner product on normalized vectors orders results the same way as cosine distance.
+inline void normalize(std::span<float> value) {
+    detail::normalize(value.data(), value.size());
+}
+
+/// Normalizes a half vector to unit length in place, leaving zero vectors unchanged.
+inline void normalize(std::span<Half> value) {
+    detail::normalize(value.data(), value.size());
+}
+
+/// Returns a vector normalized to unit length, like `l2_normalize` on the server.
+inline Vector normalize(const Vector& value) {
+    std::vector<float> result = value.values();
+    normalize(std::span<float>{result});
+    return Vector{std::move(result)};
+}
+
+/// Returns a half vector normalized to unit length, like `l2_normalize` on the server.
+inline HalfVector normalize(const HalfVector& value) {
+    std::vector<Half> result = value.values();
+    normalize(std::span<Half>{result});
+    return HalfVector{std::move(result)};
+}
+
+/// Normalizes each vector in a batch to unit length in place.
+template<typename T>
+void normalize(VectorBatch<T>& batch, const BatchOptions& options = {}) {
+    detail::for_each_row(batch, options, [](std::span<T> row) {
+        detail::normalize(row.data(), row.size());
+    });
+}
+
+/// Adds a vector to another in place.
+inline void add(std::span<float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    detail::add_scaled(a.data(), b.data(), 1.0f, a.size());
+}
+
+/// Adds a half vector to another in place.
+inline void add(std::span<Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    detail::add_scaled(a.data(), b.data(), 1.0f, a.size());
+}
+
+/// Adds a vector to each vector in a batch in place.
+template<typename T>
+void add(
+    VectorBatch<T>& batch,
+    std::type_identity_t<std::span<const T>> value,
+    const BatchOptions& options = {}
+) {
+    detail::check_dimensions(batch.dimensions(), value.size());
+    detail::for_each_row(batch, options, [&](std::span<T> row) {
+        detail::add_scaled(row.data(), value.data(), 1.0f, row.size());
+    });
+}
+
+/// Subtracts a vector from another in place.
+inline void subtract(std::span<float> a, std::span<const float> b) {
+    detail::check_dimensions(a.size(), b.size());
+    detail::add_scaled(a.data(), b.data(), -1.0f, a.size());
+}
+
+/// Subtracts a half vector from another in place.
+inline void subtract(std::span<Half> a, std::span<const Half> b) {
+    detail::check_dimensions(a.size(), b.size());
+    detail::add_scaled(a.data(), b.data(), -1.0f, a.size());
+}
+
+/// Subtracts a vector from each vector in a batch in place, like the mean to center them.
+template<typename T>
+void subtract(
+    VectorBatch<T>& batch,
+    std::type_identity_t<std::span<const T>> value,
+    const BatchOptions& options = {}
+) {
+    detail::check_dimensions(batch.dimensions(), value.size());
+    detail::for_each_row(batch, options, [&](std::span<T> row) {
+        detail::add_scaled(row.data(), value.data(), -1.0f, row.size());
+    });
+}
+
+/// Multiplies a vector by a number in place.
+inline void scale(std::span<float> value, float factor) {
+    detail::multiply(value.data(), factor, value.size());
+}
+
+/// Multiplies a half vector by a number in place.
+inline void scale(std::span<Half> value, float factor) {
+    detail::multiply(value.data(), factor, value.size());
+}
+
+/// Multiplies each vector in a batch by a number in place.
+template<typename T>
+void scale(VectorBatch<T>& batch, float factor, const BatchOptions& options = {}) {
+    detail::for_each_row(batch, options, [&](std::span<T> row) {
+        detail::multiply(row.data(), factor, row.size());
+    });
+}
+
+/// Returns the mean of vectors, weighted if weights are given, like a centroid of item vectors
+/// for a user.
+inline Vector mean(
+    std::span<const Vector> values,
+    std::span<const float> weights = {},
+    const BatchOptions& options = {}
+) {
+    size_t dimensions = values.empty() ? 0 : values[0].dimensions();
+    std::vector<const float*> rows;
+    rows.reserve(values.size());
+    for (const auto& v : values) {
+        detail::check_dimensions(dimensions, v.dimensions());
+        rows.push_back(v.values().data());
+    }
+    return detail::weighted_mean(dimensions, rows.size(), rows.data(), weights, options);
+}
+
+/// Returns the mean of vectors in a batch, weighted if weights are given.
+template<typename T>
+Vector mean(
+    const VectorBatch<T>& batch,
+    std::span<const float> weights = {},
+    const BatchOptions& options = {}
+) {
+    std::vector<const T*> rows(batch.rows());
+    for (size_t i = 0; i < rows.size(); i++) {
+        rows[i] = batch.row(i).data();
+    }
+    return detail::weighted_mean(batch.dimensions(), rows.size(), rows.data(), weights, options);
+}
+} // namespace pgvector
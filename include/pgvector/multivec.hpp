@@ -0,0 +1,264 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+#include "batch.hpp"
+#include "distance.hpp"
+#include "neighbor.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// A multi-vector, like per-token embeddings for late interaction, with tokens stored
+/// contiguously.
+///
+/// Maps to `vector[]` columns.
+class MultiVector {
+  public:
+    /// Creates a multi-vector with no tokens.
+    explicit MultiVector(size_t dimensions = 0) : tokens_{dimensions} {}
+
+    /// Creates a multi-vector from a batch of token vectors.
+    explicit MultiVector(VectorBatch<float> tokens) : tokens_{std::move(tokens)} {}
+
+    /// Creates a multi-vector from token vectors.
+    explicit MultiVector(std::span<const Vector> tokens) :
+        tokens_{tokens.empty() ? 0 : tokens[0].dimensions()} {
+        tokens_.reserve(tokens.size());
+        for (const auto& v : tokens) {
+            tokens_.push_back(v.values());
+        }
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return tokens_.dimensions();
+    }
+
+    /// Returns the number of tokens.
+    size_t size() const {
+        return tokens_.rows();
+    }
+
+    /// Returns whether there are no tokens.
+    bool empty() const {
+        return tokens_.empty();
+    }
+
+    /// Returns a token vector.
+    std::span<const float> operator[](size_t i) const {
+        return tokens_.row(i);
+    }
+
+    /// Returns the token vectors.
+    const VectorBatch<float>& tokens() const {
+        return tokens_;
+    }
+
+    friend bool operator==(const MultiVector& lhs, const MultiVector& rhs) {
+        return lhs.dimensions() == rhs.dimensions() && lhs.size() == rhs.size()
+            && std::equal(
+                   lhs.tokens_.data(), lhs.tokens_.data() + lhs.size() * lhs.dimensions(),
+                   rhs.tokens_.data()
+            );
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const MultiVector& value) {
+        os << "{";
+        for (size_t i = 0; i < value.size(); i++) {
+            if (i > 0) {
+                os << ",";
+            }
+            os << "\"" << Vector{value[i]} << "\"";
+        }
+        os << "}";
+        return os;
+    }
+
+  private:
+    VectorBatch<float> tokens_;
+};
+
+/// MaxSim options.
+struct MaxSimOptions {
+    /// The number of threads, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// @cond
+namespace detail {
+#if defined(__AVX__) && defined(__FMA__)
+// dot products of four consecutive query tokens with one document token, sharing its loads
+// and summing in the same order as dot, with named accumulators so they stay in registers
+inline void dot4(const float* q, const float* d, size_t n, float* out) {
+    const float* q0 = q;
+    const float* q1 = q + n;
+    const float* q2 = q + 2 * n;
+    const float* q3 = q + 3 * n;
+    __m256 a0 = _mm256_setzero_ps();
+    __m256 a1 = _mm256_setzero_ps();
+    __m256 a2 = _mm256_setzero_ps();
+    __m256 a3 = _mm256_setzero_ps();
+    __m256 b0 = _mm256_setzero_ps();
+    __m256 b1 = _mm256_setzero_ps();
+    __m256 b2 = _mm256_setzero_ps();
+    __m256 b3 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 d0 = load8(d + i);
+        __m256 d1 = load8(d + i + 8);
+        a0 = _mm256_fmadd_ps(load8(q0 + i), d0, a0);
+        a1 = _mm256_fmadd_ps(load8(q1 + i), d0, a1);
+        a2 = _mm256_fmadd_ps(load8(q2 + i), d0, a2);
+        a3 = _mm256_fmadd_ps(load8(q3 + i), d0, a3);
+        b0 = _mm256_fmadd_ps(load8(q0 + i + 8), d1, b0);
+        b1 = _mm256_fmadd_ps(load8(q1 + i + 8), d1, b1);
+        b2 = _mm256_fmadd_ps(load8(q2 + i + 8), d1, b2);
+        b3 = _mm256_fmadd_ps(load8(q3 + i + 8), d1, b3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 d0 = load8(d + i);
+        a0 = _mm256_fmadd_ps(load8(q0 + i), d0, a0);
+        a1 = _mm256_fmadd_ps(load8(q1 + i), d0, a1);
+        a2 = _mm256_fmadd_ps(load8(q2 + i), d0, a2);
+        a3 = _mm256_fmadd_ps(load8(q3 + i), d0, a3);
+    }
+    float s0 = hsum(_mm256_add_ps(a0, b0));
+    float s1 = hsum(_mm256_add_ps(a1, b1));
+    float s2 = hsum(_mm256_add_ps(a2, b2));
+    float s3 = hsum(_mm256_add_ps(a3, b3));
+    for (; i < n; i++) {
+        s0 += q0[i] * d[i];
+        s1 += q1[i] * d[i];
+        s2 += q2[i] * d[i];
+        s3 += q3[i] * d[i];
+    }
+    out[0] = s0;
+    out[1] = s1;
+    out[2] = s2;
+    out[3] = s3;
+}
+#endif
+
+// streams document tokens past the query, which stays in cache, keeping the best inner
+// product for each query token in `best`
+inline float max_sim(
+    const float* q,
+    size_t nq,
+    const float* d,
+    size_t nd,
+    size_t dimensions,
+    float* best
+) {
+    if (nd == 0) {
+        return nq == 0 ? 0 : -std::numeric_limits<float>::infinity();
+    }
+    std::fill(best, best + nq, -std::numeric_limits<float>::infinity());
+    for (size_t j = 0; j < nd; j++) {
+        const float* token = d + j * dimensions;
+        size_t i = 0;
+#if defined(__AVX__) && defined(__FMA__)
+        for (; i + 4 <= nq; i += 4) {
+            float s[4];
+            dot4(q + i * dimensions, token, dimensions, s);
+            for (size_t r = 0; r < 4; r++) {
+                best[i + r] = std::max(best[i + r], s[r]);
+            }
+        }
+#endif
+        for (; i < nq; i++) {
+            best[i] = std::max(best[i], dot(q + i * dimensions, token, dimensions));
+        }
+    }
+
+    float sum = 0;
+    for (size_t i = 0; i < nq; i++) {
+        sum += best[i];
+    }
+    return sum;
+}
+
+inline void check_tokens(const MultiVector& query, const MultiVector& document) {
+    if (!query.empty() && !document.empty()) {
+        check_dimensions(query.dimensions(), document.dimensions());
+    }
+}
+} // namespace detail
+/// @endcond
+
+/// Returns the sum over query tokens of the largest inner product with a document token,
+/// like ColBERT.
+///
+/// Documents without tokens score negative infinity so they rank last.
+inline float max_sim(const MultiVector& query, const MultiVector& document) {
+    detail::check_tokens(query, document);
+    std::vector<float> best(query.size());
+    return detail::max_sim(
+        query.tokens().data(), query.size(), document.tokens().data(), document.size(),
+        query.dimensions(), best.data()
+    );
+}
+
+/// Returns the MaxSim score of each document, scoring documents in parallel.
+inline std::vector<float> max_sim(
+    const MultiVector& query,
+    std::span<const MultiVector> documents,
+    const MaxSimOptions& options = {}
+) {
+    for (const auto& d : documents) {
+        detail::check_tokens(query, d);
+    }
+
+    std::vector<float> scores(documents.size());
+    auto score = [&](size_t begin, size_t end, size_t) {
+        std::vector<float> best(query.size());
+        for (size_t i = begin; i < end; i++) {
+            const MultiVector& d = documents[i];
+            scores[i] = detail::max_sim(
+                query.tokens().data(), query.size(), d.tokens().data(), d.size(),
+                query.dimensions(), best.data()
+            );
+        }
+    };
+    detail::parallel_for(documents.size(), options.threads, score);
+    return scores;
+}
+
+/// Returns the `k` documents with the largest MaxSim scores, with the negative score as the
+/// distance like `Metric::InnerProduct`.
+inline std::vector<Neighbor> rerank(
+    const MultiVector& query,
+    std::span<const int64_t> ids,
+    std::span<const MultiVector> documents,
+    size_t k,
+    const MaxSimOptions& options = {}
+) {
+    if (ids.size() != documents.size()) {
+        throw std::invalid_argument{"ids and documents must be the same size"};
+    }
+    std::vector<float> scores = max_sim(query, documents, options);
+    TopK top{k};
+    for (size_t i = 0; i < scores.size(); i++) {
+        top.push(ids[i], -scores[i]);
+    }
+    return top.sorted();
+}
+} // namespace pgvector
@@ -0,0 +1,107 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace pgvector {
+/// A search result.
+struct Neighbor {
+    /// The id.
+    int64_t id;
+
+    /// The distance to the query.
+    float distance;
+
+    friend bool operator==(const Neighbor& lhs, const Neighbor& rhs) = default;
+
+    friend std::ostream& operator<<(std::ostream& os, const Neighbor& value) {
+        os << value.id << ":" << value.distance;
+        return os;
+    }
+};
+
+/// Keeps the `k` nearest neighbors seen so far.
+class TopK {
+  public:
+    /// Creates an empty set of neighbors.
+    explicit TopK(size_t k) : k_{k} {
+        heap_.reserve(k);
+    }
+
+    /// Returns the number of neighbors to keep.
+    size_t k() const {
+        return k_;
+    }
+
+    /// Returns the number of neighbors kept.
+    size_t size() const {
+        return heap_.size();
+    }
+
+    /// Returns the largest distance kept once full, infinity if not full, or negative infinity
+    /// if `k` is zero.
+    float threshold() const {
+        if (k_ == 0) {
+            return -std::numeric_limits<float>::infinity();
+        }
+        if (heap_.size() < k_) {
+            return std::numeric_limits<float>::infinity();
+        }
+        return heap_.front().distance;
+    }
+
+    /// Adds a candidate and returns whether it was kept.
+    bool push(int64_t id, float distance) {
+        // sort NaN last like Postgres
+        if (std::isnan(distance)) {
+            distance = std::numeric_limits<float>::infinity();
+        }
+        if (heap_.size() < k_) {
+            heap_.push_back({id, distance});
+            std::ranges::push_heap(heap_, less);
+            return true;
+        }
+        if (k_ == 0 || !less({id, distance}, heap_.front())) {
+            return false;
+        }
+        std::ranges::pop_heap(heap_, less);
+        heap_.back() = {id, distance};
+        std::ranges::push_heap(heap_, less);
+        return true;
+    }
+
+    /// Adds the neighbors kept by another set.
+    void merge(const TopK& other) {
+        for (const auto& v : other.heap_) {
+            push(v.id, v.distance);
+        }
+    }
+
+    /// Returns the neighbors sorted by distance.
+    std::vector<Neighbor> sorted() const {
+        std::vector<Neighbor> result{heap_};
+        std::ranges::sort(result, less);
+        return result;
+    }
+
+  private:
+    // break ties by id so results are deterministic
+    static bool less(const Neighbor& a, const Neighbor& b) {
+        return a.distance < b.distance || (a.distance == b.distance && a.id < b.id);
+    }
+
+    size_t k_;
+    std::vector<Neighbor> heap_;
+};
+} // namespace pgvector
@@ -0,0 +1,78 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @cond
+
+namespace pgvector::detail {
+// uses all hardware threads when zero
+inline size_t thread_count(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max(threads, static_cast<size_t>(1));
+}
+
+// calls f(begin, end, thread) for contiguous chunks of [0, n) on up to `threads` threads
+template<typename F>
+void parallel_for(size_t n, size_t threads, F&& f) {
+    threads = std::min(thread_count(threads), n);
+    if (threads <= 1) {
+        if (n > 0) {
+            f(static_cast<size_t>(0), n, static_cast<size_t>(0));
+        }
+        return;
+    }
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto run = [&](size_t t) {
+        size_t begin = n * t / threads;
+        size_t end = n * (t + 1) / threads;
+        try {
+            f(begin, end, t);
+        } catch (...) {
+            std::lock_guard lock{error_mutex};
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    auto join = [&] {
+        for (auto& w : workers) {
+            w.join();
+        }
+    };
+    try {
+        for (size_t t = 1; t < threads; t++) {
+            workers.emplace_back(run, t);
+        }
+    } catch (...) {
+        // destroying a joinable thread terminates
+        join();
+        throw;
+    }
+    run(0);
+    join();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+} // namespace pgvector::detail
+
+/// @endcond
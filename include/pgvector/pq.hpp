@@ -0,0 +1,750 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "batch.hpp"
+#include "distance.hpp"
+#include "instrumentation.hpp"
+#include "math.hpp"
+#include "neighbor.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Product quantization options.
+struct PqOptions {
+    /// The distance metric.
+    Metric metric = Metric::L2;
+
+    /// The number of subvectors, which must divide the number of dimensions.
+    size_t subvectors = 8;
+
+    /// The bits per subvector code, either 4 or 8.
+    size_t bits = 8;
+
+    /// The max number of k-means iterations.
+    size_t max_iterations = 20;
+
+    /// The number of threads for training, encoding, and search, or zero for all hardware
+    /// threads.
+    size_t threads = 0;
+
+    /// The seed for choosing initial centroids.
+    uint64_t seed = 0;
+};
+
+/// @cond
+namespace detail {
+// per-query partial distances for each subvector and code, plus an 8-bit copy for 4-bit codes
+struct PqTable {
+    std::vector<float> values;
+    std::vector<uint8_t> quantized;
+    double scale = 0;
+    double bias = 0;
+    double slack = 0;
+
+    // a lower bound on the exact distance from the sum of quantized entries
+    double bound(uint16_t sum) const {
+        return bias + scale * sum - slack;
+    }
+};
+
+#if defined(__AVX2__)
+// sums the quantized entries for a block of 32 codes with a shuffle per 16-entry table
+inline void pq_fast_scan(const uint8_t* block, const uint8_t* table, size_t bytes, uint16_t* out) {
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    for (size_t j = 0; j < bytes; j++) {
+        const uint8_t* t = table + j * 32;
+        __m256i codes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + j * 32));
+        __m256i lo = _mm256_and_si256(codes, mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(codes, 4), mask);
+        __m128i table0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t));
+        __m128i table1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + 16));
+        __m256i d0 = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table0), lo);
+        __m256i d1 = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table1), hi);
+        acc0 = _mm256_add_epi16(acc0, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(d0)));
+        acc0 = _mm256_add_epi16(acc0, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(d1)));
+        acc1 = _mm256_add_epi16(acc1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(d0, 1)));
+        acc1 = _mm256_add_epi16(acc1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(d1, 1)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), acc0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16), acc1);
+}
+#endif
+} // namespace detail
+/// @endcond
+
+/// Compresses vectors into short codes by quantizing each subvector to its nearest centroid.
+///
+/// Codes use one byte per subvector with 8 bits, or two subvectors per byte (low bits first)
+/// with 4 bits, and can be stored as `bytea`.
+class ProductQuantizer {
+  public:
+    /// Creates an untrained quantizer.
+    explicit ProductQuantizer(size_t dimensions, const PqOptions& options = {}) :
+        dimensions_{dimensions},
+        options_{options} {
+        if (dimensions == 0) {
+            throw std::invalid_argument{"dimensions must be greater than 0"};
+        }
+        detail::check_vector_metric(options.metric);
+        if (options.metric == Metric::L1) {
+            throw std::invalid_argument{"product quantization does not support L1 distance"};
+        }
+        if (options.subvectors == 0 || dimensions % options.subvectors != 0) {
+            throw std::invalid_argument{"subvectors must divide the number of dimensions"};
+        }
+        if (options.bits != 4 && options.bits != 8) {
+            throw std::invalid_argument{"bits must be 4 or 8"};
+        }
+    }
+
+    /// Creates a quantizer from stored centroids.
+    ProductQuantizer(
+        size_t dimensions,
+        std::span<const float> centroids,
+        const PqOptions& options = {}
+    ) :
+        ProductQuantizer{dimensions, options} {
+        size_t expected = centroid_count() * dimensions_;
+        if (centroids.size() != expected) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(expected) + " centroid values, not "
+                + std::to_string(centroids.size())
+            };
+        }
+        centroids_.assign(centroids.begin(), centroids.end());
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns the options.
+    const PqOptions& options() const {
+        return options_;
+    }
+
+    /// Returns whether the quantizer has been trained.
+    bool trained() const {
+        return !centroids_.empty();
+    }
+
+    /// Returns the number of bytes in each code.
+    size_t code_size() const {
+        return (options_.subvectors * options_.bits + 7) / 8;
+    }
+
+    /// Returns the centroids, ordered by subvector and then code.
+    std::span<const float> centroids() const {
+        return centroids_;
+    }
+
+    /// Finds the centroids for each subvector with k-means on a sample of vectors.
+    ///
+    /// Results are the same for any number of threads.
+    void train(const VectorBatch<float>& sample) {
+        detail::check_dimensions(sample.dimensions(), dimensions_);
+        size_t n = sample.rows();
+        size_t k = centroid_count();
+        if (n < k) {
+            throw std::invalid_argument{
+                "expected at least " + std::to_string(k) + " vectors, not " + std::to_string(n)
+            };
+        }
+
+        VectorBatch<float> data = sample;
+        if (options_.metric == Metric::Cosine) {
+            normalize(data, {.threads = options_.threads});
+        }
+
+        size_t m = options_.subvectors;
+        size_t dsub = dimensions_ / m;
+        std::mt19937_64 prng{options_.seed};
+        std::vector<float> centroids(k * dimensions_);
+        std::vector<float> points(n * dsub);
+        for (size_t s = 0; s < m; s++) {
+            for (size_t i = 0; i < n; i++) {
+                const float* row = data.row(i).data() + s * dsub;
+                std::copy(row, row + dsub, points.data() + i * dsub);
+            }
+            kmeans(points, n, dsub, prng, centroids.data() + s * k * dsub);
+        }
+        centroids_ = std::move(centroids);
+    }
+
+    /// Returns the code for a vector.
+    std::vector<uint8_t> encode(std::span<const float> value) const {
+        check_trained();
+        check_vector_dimensions(value.size());
+        std::vector<uint8_t> code(code_size());
+        encode(value.data(), code.data());
+        return code;
+    }
+
+    /// Returns the code for a vector.
+    std::vector<uint8_t> encode(const Vector& value) const {
+        return encode(std::span<const float>{value.values()});
+    }
+
+    /// Returns the codes for a batch of vectors, encoding in parallel.
+    VectorBatch<uint8_t> encode(const VectorBatch<float>& values) const {
+        check_trained();
+        detail::check_dimensions(values.dimensions(), dimensions_);
+        VectorBatch<uint8_t> codes{code_size(), values.rows()};
+        auto encode_rows = [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                encode(values.row(i).data(), codes.row(i).data());
+            }
+        };
+        detail::parallel_for(values.rows(), options_.threads, encode_rows);
+        return codes;
+    }
+
+    /// Returns the vector for a code, which is normalized for cosine distance.
+    Vector decode(std::span<const uint8_t> code) const {
+        check_trained();
+        check_code_size(code.size());
+        size_t m = options_.subvectors;
+        size_t dsub = dimensions_ / m;
+        std::vector<float> result(dimensions_);
+        for (size_t s = 0; s < m; s++) {
+            const float* c = centroid(s, code_at(code.data(), s));
+            std::copy(c, c + dsub, result.data() + s * dsub);
+        }
+        return Vector{std::move(result)};
+    }
+
+    /// Returns the approximate distance between a query and a code, like for reranking codes
+    /// loaded from a table.
+    float distance(std::span<const float> query, std::span<const uint8_t> code) const {
+        check_code_size(code.size());
+        detail::PqTable table = distance_table(query);
+        float d = 0;
+        for (size_t s = 0; s < options_.subvectors; s++) {
+            d += table.values[s * centroid_count() + code_at(code.data(), s)];
+        }
+        return finish(d);
+    }
+
+  private:
+    friend class PqIndex;
+
+    // partial distances from a query to every centroid, which are squared for L2
+    detail::PqTable distance_table(std::span<const float> query) const {
+        check_trained();
+        check_vector_dimensions(query.size());
+
+        std::vector<float> normalized;
+        if (options_.metric == Metric::Cosine) {
+            normalized.assign(query.begin(), query.end());
+            normalize(std::span<float>{normalized});
+            query = normalized;
+        }
+
+        size_t m = options_.subvectors;
+        size_t k = centroid_count();
+        size_t dsub = dimensions_ / m;
+        detail::PqTable table;
+        table.values.resize(m * k);
+        for (size_t s = 0; s < m; s++) {
+            const float* q = query.data() + s * dsub;
+            for (size_t c = 0; c < k; c++) {
+                const float* v = centroid(s, c);
+                table.values[s * k + c] = options_.metric == Metric::L2
+                    ? detail::squared_l2(q, v, dsub)
+                    : -detail::dot(q, v, dsub);
+            }
+        }
+        // sums of 8-bit entries must fit in 16 bits
+        if (options_.bits == 4 && m <= 256) {
+            quantize(table);
+        }
+        return table;
+    }
+
+    // turns an internal distance into the distance for the metric
+    float finish(float d) const {
+        switch (options_.metric) {
+            case Metric::L2:
+                return std::sqrt(d);
+            case Metric::Cosine:
+                return 1 + d;
+            case Metric::InnerProduct:
+            case Metric::L1:
+            case Metric::Hamming:
+            case Metric::Jaccard:
+                break;
+        }
+        return d;
+    }
+
+    size_t centroid_count() const {
+        return size_t{1} << options_.bits;
+    }
+
+    const float* centroid(size_t subvector, size_t code) const {
+        size_t dsub = dimensions_ / options_.subvectors;
+        return centroids_.data() + (subvector * centroid_count() + code) * dsub;
+    }
+
+    size_t code_at(const uint8_t* code, size_t subvector) const {
+        if (options_.bits == 8) {
+            return code[subvector];
+        }
+        uint8_t byte = code[subvector / 2];
+        return subvector % 2 == 0 ? byte & 0x0f : byte >> 4;
+    }
+
+    void check_trained() const {
+        if (!trained()) {
+            throw std::logic_error{"product quantizer must be trained"};
+        }
+    }
+
+    void check_vector_dimensions(size_t dimensions) const {
+        if (dimensions != dimensions_) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(dimensions_) + " dimensions, not "
+                + std::to_string(dimensions)
+            };
+        }
+    }
+
+    void check_code_size(size_t size) const {
+        if (size != code_size()) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(code_size()) + " bytes, not " + std::to_string(size)
+            };
+        }
+    }
+
+    void encode(const float* value, uint8_t* code) const {
+        std::vector<float> normalized;
+        if (options_.metric == Metric::Cosine) {
+            normalized.assign(value, value + dimensions_);
+            normalize(std::span<float>{normalized});
+            value = normalized.data();
+        }
+
+        size_t m = options_.subvectors;
+        size_t dsub = dimensions_ / m;
+        std::fill(code, code + code_size(), uint8_t{0});
+        for (size_t s = 0; s < m; s++) {
+            size_t best = nearest(value + s * dsub, centroid(s, 0), centroid_count(), dsub);
+            if (options_.bits == 8) {
+                code[s] = static_cast<uint8_t>(best);
+            } else {
+                code[s / 2] = static_cast<uint8_t>(code[s / 2] | best << (s % 2 * 4));
+            }
+        }
+    }
+
+    static size_t nearest(const float* v, const float* centroids, size_t k, size_t dsub) {
+        size_t best = 0;
+        float best_distance = std::numeric_limits<float>::infinity();
+        for (size_t c = 0; c < k; c++) {
+            float d = detail::squared_l2(v, centroids + c * dsub, dsub);
+            if (d < best_distance) {
+                best = c;
+                best_distance = d;
+            }
+        }
+        return best;
+    }
+
+    // assigns in parallel and updates serially so results do not depend on the thread count
+    void kmeans(
+        const std::vector<float>& points,
+        size_t n,
+        size_t dsub,
+        std::mt19937_64& prng,
+        float* centroids
+    ) const {
+        size_t k = centroid_count();
+        auto point = [&](size_t i) { return points.data() + i * dsub; };
+
+        // start from distinct random points
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; i++) {
+            order[i] = i;
+        }
+        for (size_t c = 0; c < k; c++) {
+            size_t i = std::uniform_int_distribution<size_t>{c, n - 1}(prng);
+            std::swap(order[c], order[i]);
+            std::copy(point(order[c]), point(order[c]) + dsub, centroids + c * dsub);
+        }
+
+        std::uniform_int_distribution<size_t> any{0, n - 1};
+        std::vector<size_t> assignments(n, k);
+        std::vector<double> sums(k * dsub);
+        std::vector<size_t> counts(k);
+        for (size_t iteration = 0; iteration < options_.max_iterations; iteration++) {
+            size_t threads = detail::thread_count(options_.threads);
+            std::vector<size_t> changes(std::min(threads, n));
+            detail::parallel_for(n, threads, [&](size_t begin, size_t end, size_t t) {
+                for (size_t i = begin; i < end; i++) {
+                    size_t best = nearest(point(i), centroids, k, dsub);
+                    if (assignments[i] != best) {
+                        assignments[i] = best;
+                        changes[t]++;
+                    }
+                }
+            });
+
+            size_t changed = 0;
+            for (auto c : changes) {
+                changed += c;
+            }
+            if (changed == 0) {
+                break;
+            }
+
+            std::ranges::fill(sums, 0.0);
+            std::ranges::fill(counts, 0);
+            for (size_t i = 0; i < n; i++) {
+                double* s = sums.data() + assignments[i] * dsub;
+                const float* p = point(i);
+                for (size_t j = 0; j < dsub; j++) {
+                    s[j] += static_cast<double>(p[j]);
+                }
+                counts[assignments[i]]++;
+            }
+            for (size_t c = 0; c < k; c++) {
+                float* center = centroids + c * dsub;
+                if (counts[c] == 0) {
+                    // reseed empty clusters
+                    size_t i = any(prng);
+                    std::copy(point(i), point(i) + dsub, center);
+                } else {
+                    for (size_t j = 0; j < dsub; j++) {
+                        center[j] = static_cast<float>(
+                            sums[c * dsub + j] / static_cast<double>(counts[c])
+                        );
+                    }
+                }
+            }
+        }
+    }
+
+    // quantizes each 16-entry table to 8 bits with a shared scale so sums stay comparable,
+    // with the padding subvector of an odd count left as zeros
+    void quantize(detail::PqTable& table) const {
+        size_t m = options_.subvectors;
+        std::vector<float> mins(m);
+        float range = 0;
+        double total_min = 0;
+        double abs_min = 0;
+        for (size_t s = 0; s < m; s++) {
+            auto entries = std::span<const float>{table.values}.subspan(s * 16, 16);
+            auto [lo, hi] = std::ranges::minmax(entries);
+            mins[s] = lo;
+            range = std::max(range, hi - lo);
+            total_min += lo;
+            abs_min += std::fabs(lo);
+        }
+
+        double scale = range / 255.0;
+        table.quantized.assign(code_size() * 32, 0);
+        for (size_t s = 0; s < m; s++) {
+            for (size_t c = 0; c < 16; c++) {
+                double q = scale > 0 ? std::round((table.values[s * 16 + c] - mins[s]) / scale) : 0;
+                table.quantized[s * 16 + c] = static_cast<uint8_t>(std::min(q, 255.0));
+            }
+        }
+        table.scale = scale;
+        table.bias = total_min;
+        // each entry rounds by at most half a step, with room for float error in exact sums
+        table.slack = scale * (static_cast<double>(m) / 2 + 1)
+            + 1e-5 * (abs_min + scale * 255 * static_cast<double>(m));
+    }
+
+    size_t dimensions_;
+    PqOptions options_;
+    std::vector<float> centroids_;
+};
+
+/// An in-memory index that scans product quantization codes with asymmetric distances.
+///
+/// Each query builds a table of distances to the centroids, and codes are stored in blocks of
+/// 32 so 4-bit codes can be scanned with SIMD shuffles when AVX2 is available. Results match
+/// `ProductQuantizer::distance` for every code.
+class PqIndex {
+  public:
+    /// Creates an empty index.
+    explicit PqIndex(ProductQuantizer quantizer) : quantizer_{std::move(quantizer)} {
+        if (!quantizer_.trained()) {
+            throw std::logic_error{"product quantizer must be trained"};
+        }
+    }
+
+    /// Returns the quantizer.
+    const ProductQuantizer& quantizer() const {
+        return quantizer_;
+    }
+
+    /// Returns the number of vectors added.
+    size_t size() const {
+        return ids_.size();
+    }
+
+    /// Reserves space for a number of vectors.
+    void reserve(size_t n) {
+        ids_.reserve(n);
+        blocks_.reserve((n + block_size - 1) / block_size * block_size * quantizer_.code_size());
+    }
+
+    /// Adds a vector.
+    void add(int64_t id, const Vector& value) {
+        PGVECTOR_INSTRUMENT(Insert, "pq");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        push_code(id, quantizer_.encode(value).data());
+    }
+
+    /// Adds a batch of vectors, encoding in parallel.
+    void add(std::span<const int64_t> ids, const VectorBatch<float>& values) {
+        PGVECTOR_INSTRUMENT(Insert, "pq");
+        PGVECTOR_INSTRUMENT_SIZE(0, ids.size());
+
+        if (ids.size() != values.rows()) {
+            throw std::invalid_argument{"ids and values must be the same size"};
+        }
+        VectorBatch<uint8_t> codes = quantizer_.encode(values);
+        reserve(size() + ids.size());
+        for (size_t i = 0; i < ids.size(); i++) {
+            push_code(ids[i], codes.row(i).data());
+        }
+    }
+
+    /// Adds a code from `ProductQuantizer::encode`.
+    void add_code(int64_t id, std::span<const uint8_t> code) {
+        check_code_size(code.size());
+        push_code(id, code.data());
+    }
+
+    /// Adds a code loaded from a `bytea` column.
+    void add_code(int64_t id, std::span<const std::byte> code) {
+        add_code(id, {reinterpret_cast<const uint8_t*>(code.data()), code.size()});
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(const Vector& query, size_t k) const {
+        return search(std::span<const float>{query.values()}, k);
+    }
+
+    /// Returns the `k` nearest neighbors.
+    std::vector<Neighbor> search(std::span<const float> query, size_t k) const {
+        std::vector<detail::PqTable> tables;
+        tables.push_back(quantizer_.distance_table(query));
+        return std::move(run(tables, k).front());
+    }
+
+    /// Returns the `k` nearest neighbors for each query.
+    std::vector<std::vector<Neighbor>> search(const VectorBatch<float>& queries, size_t k) const {
+        detail::check_dimensions(queries.dimensions(), quantizer_.dimensions());
+        std::vector<detail::PqTable> tables(queries.rows());
+        auto build_tables = [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; i++) {
+                tables[i] = quantizer_.distance_table(queries.row(i));
+            }
+        };
+        detail::parallel_for(queries.rows(), quantizer_.options().threads, build_tables);
+        return run(tables, k);
+    }
+
+  private:
+    static constexpr size_t block_size = 32;
+
+    void check_code_size(size_t size) const {
+        if (size != quantizer_.code_size()) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(quantizer_.code_size()) + " bytes, not "
+                + std::to_string(size)
+            };
+        }
+    }
+
+    // stores byte j of the codes in a block together so a scan reads them with one load
+    void push_code(int64_t id, const uint8_t* code) {
+        size_t bytes = quantizer_.code_size();
+        size_t i = ids_.size();
+        if (i % block_size == 0) {
+            blocks_.resize(blocks_.size() + block_size * bytes);
+        }
+        uint8_t* block = blocks_.data() + i / block_size * block_size * bytes;
+        for (size_t j = 0; j < bytes; j++) {
+            block[j * block_size + i % block_size] = code[j];
+        }
+        ids_.push_back(id);
+    }
+
+    // sums table entries for each code in a block in subvector order like
+    // `ProductQuantizer::distance`
+    void accumulate(const detail::PqTable& table, const uint8_t* block, float* sums) const {
+        size_t m = quantizer_.options().subvectors;
+        const float* values = table.values.data();
+        if (quantizer_.options().bits == 8) {
+            for (size_t s = 0; s < m; s++) {
+                const float* t = values + s * 256;
+                const uint8_t* codes = block + s * block_size;
+                for (size_t v = 0; v < block_size; v++) {
+                    sums[v] += t[codes[v]];
+                }
+            }
+        } else {
+            for (size_t s = 0; s < m; s += 2) {
+                const float* t0 = values + s * 16;
+                const float* t1 = t0 + 16;
+                const uint8_t* codes = block + s / 2 * block_size;
+                for (size_t v = 0; v < block_size; v++) {
+                    sums[v] += t0[codes[v] & 0x0f];
+                }
+                if (s + 1 < m) {
+                    for (size_t v = 0; v < block_size; v++) {
+                        sums[v] += t1[codes[v] >> 4];
+                    }
+                }
+            }
+        }
+    }
+
+    // exact distance for one code in a block of 4-bit codes
+    float exact(const detail::PqTable& table, const uint8_t* block, size_t v) const {
+        size_t m = quantizer_.options().subvectors;
+        const float* values = table.values.data();
+        float d = 0;
+        for (size_t s = 0; s < m; s += 2) {
+            uint8_t code = block[s / 2 * block_size + v];
+            d += values[s * 16 + (code & 0x0f)];
+            if (s + 1 < m) {
+                d += values[(s + 1) * 16 + (code >> 4)];
+            }
+        }
+        return d;
+    }
+
+    void scan(const detail::PqTable& table, size_t begin, size_t end, TopK& top) const {
+        size_t bytes = quantizer_.code_size();
+        float threshold = top.threshold();
+        for (size_t b = begin; b < end; b++) {
+            const uint8_t* block = blocks_.data() + b * block_size * bytes;
+            const int64_t* ids = ids_.data() + b * block_size;
+            size_t count = std::min(block_size, ids_.size() - b * block_size);
+
+#if defined(__AVX2__)
+            // skip codes whose quantized sum rules them out before computing exact distances
+            if (!table.quantized.empty()) {
+                uint16_t sums[block_size];
+                detail::pq_fast_scan(block, table.quantized.data(), bytes, sums);
+                for (size_t v = 0; v < count; v++) {
+                    if (table.bound(sums[v]) > threshold) {
+                        continue;
+                    }
+                    float d = exact(table, block, v);
+                    if (!(d > threshold)) {
+                        top.push(ids[v], d);
+                        threshold = top.threshold();
+                    }
+                }
+                continue;
+            }
+#endif
+
+            float sums[block_size] = {};
+            accumulate(table, block, sums);
+            for (size_t v = 0; v < count; v++) {
+                if (!(sums[v] > threshold)) {
+                    top.push(ids[v], sums[v]);
+                    threshold = top.threshold();
+                }
+            }
+        }
+    }
+
+    // splits queries across threads, and also blocks when there are fewer queries than
+    // threads, then merges the per-thread heaps
+    std::vector<std::vector<Neighbor>> run(
+        const std::vector<detail::PqTable>& tables,
+        size_t k
+    ) const {
+        PGVECTOR_INSTRUMENT(Search, "pq");
+        PGVECTOR_INSTRUMENT_SIZE(0, tables.size());
+
+        size_t nq = tables.size();
+        if (k == 0) {
+            return std::vector<std::vector<Neighbor>>(nq);
+        }
+
+        size_t blocks = (size() + block_size - 1) / block_size;
+        size_t threads = detail::thread_count(quantizer_.options().threads);
+        size_t query_parts = std::max(std::min(nq, threads), size_t{1});
+        size_t data_parts = std::max(std::min(threads / query_parts, blocks), size_t{1});
+        size_t parts = query_parts * data_parts;
+
+        std::vector<std::vector<TopK>> partial(parts);
+        detail::parallel_for(parts, parts, [&](size_t begin, size_t end, size_t) {
+            for (size_t p = begin; p < end; p++) {
+                size_t qp = p / data_parts;
+                size_t dp = p % data_parts;
+                size_t q_begin = nq * qp / query_parts;
+                size_t q_end = nq * (qp + 1) / query_parts;
+                std::vector<TopK> tops(q_end - q_begin, TopK{k});
+                for (size_t q = q_begin; q < q_end; q++) {
+                    scan(
+                        tables[q], blocks * dp / data_parts, blocks * (dp + 1) / data_parts,
+                        tops[q - q_begin]
+                    );
+                }
+                partial[p] = std::move(tops);
+            }
+        });
+
+        std::vector<std::vector<Neighbor>> result;
+        result.reserve(nq);
+        for (size_t qp = 0; qp < query_parts; qp++) {
+            size_t q_begin = nq * qp / query_parts;
+            size_t q_end = nq * (qp + 1) / query_parts;
+            for (size_t q = q_begin; q < q_end; q++) {
+                TopK& top = partial[qp * data_parts][q - q_begin];
+                for (size_t dp = 1; dp < data_parts; dp++) {
+                    top.merge(partial[qp * data_parts + dp][q - q_begin]);
+                }
+                std::vector<Neighbor> neighbors = top.sorted();
+                for (auto& v : neighbors) {
+                    v.distance = quantizer_.finish(v.distance);
+                }
+                result.push_back(std::move(neighbors));
+            }
+        }
+        return result;
+    }
+
+    ProductQuantizer quantizer_;
+    std::vector<uint8_t> blocks_;
+    std::vector<int64_t> ids_;
+};
+} // namespace pgvector
@@ -6,19 +6,30 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstddef>
+#include <iterator>
 #include <limits>
 #include <ranges>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <pqxx/strconv>
 
+#include "batch.hpp"
+#include "fixed.hpp"
 #include "halfvec.hpp"
+#include "instrumentation.hpp"
+#include "multivec.hpp"
 #include "sparsevec.hpp"
 #include "vector.hpp"
 
@@ -26,38 +37,29 @@
 
 namespace pqxx {
 template<>
-inline constexpr std::string_view name_type<pgvector::Vector>() noexcept {
+inline constexpr std::string_view name_type<pgvector::VectorView>() noexcept {
     return "vector";
 };
 
 template<>
-struct nullness<pgvector::Vector> : no_null<pgvector::Vector> {};
+struct nullness<pgvector::VectorView> : no_null<pgvector::VectorView> {};
 
+// write-only since a view cannot own the values it decodes
 template<>
-struct string_traits<pgvector::Vector> {
-    static pgvector::Vector from_string(std::string_view text, ctx c = {}) {
-        if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
-            throw conversion_error{"Malformed vector literal"};
-        }
-
-        std::vector<float> values;
-        if (text.size() > 2) {
-            std::string_view inner = text.substr(1, text.size() - 2);
-            for (const auto& v : std::views::split(inner, ',')) {
-                std::string_view sv{v.begin(), v.end()};
-                values.push_back(pqxx::from_string<float>(sv, c));
-            }
-        }
-        return pgvector::Vector{std::move(values)};
-    }
+struct string_traits<pgvector::VectorView> {
+    static std::string_view to_buf(
+        std::span<char> buf,
+        const pgvector::VectorView& value,
+        ctx c = {}
+    ) {
+        PGVECTOR_INSTRUMENT(Encode, "vector");
 
-    static std::string_view to_buf(std::span<char> buf, const pgvector::Vector& value, ctx c = {}) {
         // confirm caller provided estimated buffer space
         if (buf.size() < size_buffer(value)) {
             throw conversion_overrun{"Not enough space in buffer for vector"};
         }
 
-        const std::vector<float>& values = value.values();
+        std::span<const float> values = value.values();
 
         // important! size_buffer cannot throw an exception on overflow
         // so perform this check before writing any data
@@ -80,11 +82,12 @@ struct string_traits<pgvector::Vector> {
 
         here += pqxx::into_buf(buf.subspan(here), "]", c);
 
+        PGVECTOR_INSTRUMENT_SIZE(here, values.size());
         return {std::data(buf), here};
     }
 
-    static size_t size_buffer(const pgvector::Vector& value) noexcept {
-        const std::vector<float>& values = value.values();
+    static size_t size_buffer(const pgvector::VectorView& value) noexcept {
+        std::span<const float> values = value.values();
 
         // cannot throw an exception here on overflow
         // so throw in into_buf
@@ -100,6 +103,44 @@ struct string_traits<pgvector::Vector> {
     }
 };
 
+template<>
+inline constexpr std::string_view name_type<pgvector::Vector>() noexcept {
+    return "vector";
+};
+
+template<>
+struct nullness<pgvector::Vector> : no_null<pgvector::Vector> {};
+
+template<>
+struct string_traits<pgvector::Vector> {
+    static pgvector::Vector from_string(std::string_view text, ctx c = {}) {
+        PGVECTOR_INSTRUMENT(Decode, "vector");
+
+        if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
+            throw conversion_error{"Malformed vector literal"};
+        }
+
+        std::vector<float> values;
+        if (text.size() > 2) {
+            std::string_view inner = text.substr(1, text.size() - 2);
+            for (const auto& v : std::views::split(inner, ',')) {
+                std::string_view sv{v.begin(), v.end()};
+                values.push_back(pqxx::from_string<float>(sv, c));
+            }
+        }
+        PGVECTOR_INSTRUMENT_SIZE(text.size(), values.size());
+        return pgvector::Vector{std::move(values)};
+    }
+
+    static std::string_view to_buf(std::span<char> buf, const pgvector::Vector& value, ctx c = {}) {
+        return string_traits<pgvector::VectorView>::to_buf(buf, pgvector::VectorView{value}, c);
+    }
+
+    static size_t size_buffer(const pgvector::Vector& value) noexcept {
+        return string_traits<pgvector::VectorView>::size_buffer(pgvector::VectorView{value});
+    }
+};
+
 template<>
 inline constexpr std::string_view name_type<pgvector::HalfVector>() noexcept {
     return "halfvec";
@@ -111,19 +152,22 @@ struct nullness<pgvector::HalfVector> : no_null<pgvector::HalfVector> {};
 template<>
 struct string_traits<pgvector::HalfVector> {
     static pgvector::HalfVector from_string(std::string_view text, ctx c = {}) {
+        PGVECTOR_INSTRUMENT(Decode, "halfvec");
+
         if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
             throw conversion_error{"Malformed halfvec literal"};
         }
 
-        std::vector<pgvector::Half> values;
+        std::vector<float> values;
         if (text.size() > 2) {
             std::string_view inner = text.substr(1, text.size() - 2);
             for (const auto& v : std::views::split(inner, ',')) {
                 std::string_view sv{v.begin(), v.end()};
-                values.push_back(static_cast<pgvector::Half>(pqxx::from_string<float>(sv, c)));
+                values.push_back(pqxx::from_string<float>(sv, c));
             }
         }
-        return pgvector::HalfVector{std::move(values)};
+        PGVECTOR_INSTRUMENT_SIZE(text.size(), values.size());
+        return pgvector::HalfVector{pgvector::to_half(values)};
     }
 
     static std::string_view to_buf(
@@ -131,6 +175,8 @@ struct string_traits<pgvector::HalfVector> {
         const pgvector::HalfVector& value,
         ctx c = {}
     ) {
+        PGVECTOR_INSTRUMENT(Encode, "halfvec");
+
         // confirm caller provided estimated buffer space
         if (buf.size() < size_buffer(value)) {
             throw conversion_overrun{"Not enough space in buffer for halfvec"};
@@ -147,18 +193,22 @@ struct string_traits<pgvector::HalfVector> {
         size_t here = 0;
         here += pqxx::into_buf(buf.subspan(here), "[", c);
 
-        // TODO use std::views::enumerate for C++23
-        size_t i = 0;
-        for (auto v : values) {
-            if (i != 0) {
-                here += pqxx::into_buf(buf.subspan(here), ",", c);
+        // convert in chunks so conversion can use SIMD without allocating
+        float chunk[256];
+        for (size_t start = 0; start < values.size(); start += std::size(chunk)) {
+            size_t n = std::min(std::size(chunk), values.size() - start);
+            pgvector::detail::convert(values.data() + start, chunk, n);
+            for (size_t i = 0; i < n; i++) {
+                if (start + i != 0) {
+                    here += pqxx::into_buf(buf.subspan(here), ",", c);
+                }
+                here += pqxx::into_buf(buf.subspan(here), chunk[i], c);
             }
-            here += pqxx::into_buf(buf.subspan(here), static_cast<float>(v), c);
-            i++;
         }
 
         here += pqxx::into_buf(buf.subspan(here), "]", c);
 
+        PGVECTOR_INSTRUMENT_SIZE(here, values.size());
         return {std::data(buf), here};
     }
 
@@ -190,6 +240,8 @@ struct nullness<pgvector::SparseVector> : no_null<pgvector::SparseVector> {};
 template<>
 struct string_traits<pgvector::SparseVector> {
     static pgvector::SparseVector from_string(std::string_view text, ctx c = {}) {
+        PGVECTOR_INSTRUMENT(Decode, "sparsevec");
+
         if (text.size() < 4 || text.front() != '{') {
             throw conversion_error{"Malformed sparsevec literal"};
         }
@@ -201,9 +253,16 @@ struct string_traits<pgvector::SparseVector> {
 
         int dimensions = pqxx::from_string<int>(text.substr(n + 2), c);
 
-        std::unordered_map<int, float> map;
+        // the server writes indices in order, so parse into arrays and fall back to a map only
+        // for unsorted or duplicate indices
+        std::vector<int> indices;
+        std::vector<float> values;
+        bool sorted = true;
         if (n > 1) {
             std::string_view inner = text.substr(1, n - 1);
+            size_t nnz = static_cast<size_t>(std::ranges::count(inner, ',')) + 1;
+            indices.reserve(nnz);
+            values.reserve(nnz);
             for (const auto& v : std::views::split(inner, ',')) {
                 std::string_view sv{v.begin(), v.end()};
 
@@ -220,11 +279,24 @@ struct string_traits<pgvector::SparseVector> {
                     index -= 1;
                 }
 
-                map.insert({index, value});
+                if (!indices.empty() && index <= indices.back()) {
+                    sorted = false;
+                }
+                indices.push_back(index);
+                values.push_back(value);
             }
         }
 
+        PGVECTOR_INSTRUMENT_SIZE(text.size(), indices.size());
         try {
+            if (sorted) {
+                return pgvector::SparseVector{std::move(indices), std::move(values), dimensions};
+            }
+            // keeps the first value for duplicate indices
+            std::unordered_map<int, float> map;
+            for (size_t i = 0; i < indices.size(); i++) {
+                map.insert({indices[i], values[i]});
+            }
             return pgvector::SparseVector{map, dimensions};
         } catch (const std::invalid_argument& e) {
             throw conversion_error{e.what()};
@@ -236,6 +308,8 @@ struct string_traits<pgvector::SparseVector> {
         const pgvector::SparseVector& value,
         ctx c = {}
     ) {
+        PGVECTOR_INSTRUMENT(Encode, "sparsevec");
+
         // confirm caller provided estimated buffer space
         if (buf.size() < size_buffer(value)) {
             throw conversion_overrun{"Not enough space in buffer for sparsevec"};
@@ -271,6 +345,7 @@ struct string_traits<pgvector::SparseVector> {
         here += pqxx::into_buf(buf.subspan(here), "}/", c);
         here += pqxx::into_buf(buf.subspan(here), dimensions, c);
 
+        PGVECTOR_INSTRUMENT_SIZE(here, nnz);
         return {std::data(buf), here};
     }
 
@@ -297,6 +372,263 @@ struct string_traits<pgvector::SparseVector> {
         return size;
     }
 };
+
+template<>
+inline constexpr std::string_view name_type<pgvector::MultiVector>() noexcept {
+    return "vector[]";
+};
+
+template<>
+struct nullness<pgvector::MultiVector> : no_null<pgvector::MultiVector> {};
+
+// elements are quoted when they contain commas, like {"[1,2]","[3,4]"} and {[1],[2]}
+template<>
+struct string_traits<pgvector::MultiVector> {
+    static pgvector::MultiVector from_string(std::string_view text, ctx c = {}) {
+        PGVECTOR_INSTRUMENT(Decode, "vector[]");
+
+        if (text.size() < 2 || text.front() != '{' || text.back() != '}') {
+            throw conversion_error{"Malformed vector[] literal"};
+        }
+
+        std::vector<float> values;
+        size_t dimensions = 0;
+        size_t tokens = 0;
+        std::string_view inner = text.substr(1, text.size() - 2);
+        while (!inner.empty()) {
+            std::string_view element;
+            if (inner.front() == '"') {
+                size_t end = inner.find('"', 1);
+                if (end == std::string_view::npos) {
+                    throw conversion_error{"Malformed vector[] literal"};
+                }
+                element = inner.substr(1, end - 1);
+                inner.remove_prefix(end + 1);
+            } else {
+                element = inner.substr(0, inner.find(','));
+                inner.remove_prefix(element.size());
+                if (element == "NULL") {
+                    throw conversion_error{"Unexpected null vector"};
+                }
+            }
+            if (!inner.empty()) {
+                if (inner.size() == 1 || inner.front() != ',') {
+                    throw conversion_error{"Malformed vector[] literal"};
+                }
+                inner.remove_prefix(1);
+            }
+
+            if (element.size() < 2 || element.front() != '[' || element.back() != ']') {
+                throw conversion_error{"Malformed vector literal"};
+            }
+            size_t n = 0;
+            if (element.size() > 2) {
+                std::string_view values_text = element.substr(1, element.size() - 2);
+                for (const auto& v : std::views::split(values_text, ',')) {
+                    std::string_view sv{v.begin(), v.end()};
+                    values.push_back(pqxx::from_string<float>(sv, c));
+                    n++;
+                }
+            }
+            if (tokens == 0) {
+                dimensions = n;
+            } else if (n != dimensions) {
+                throw conversion_error{
+                    "Expected " + std::to_string(dimensions) + " dimensions, not "
+                    + std::to_string(n)
+                };
+            }
+            tokens++;
+        }
+        PGVECTOR_INSTRUMENT_SIZE(text.size(), values.size());
+
+        pgvector::VectorBatch<float> batch{dimensions, tokens};
+        std::ranges::copy(values, batch.data());
+        return pgvector::MultiVector{std::move(batch)};
+    }
+
+    static std::string_view to_buf(
+        std::span<char> buf,
+        const pgvector::MultiVector& value,
+        ctx c = {}
+    ) {
+        PGVECTOR_INSTRUMENT(Encode, "vector[]");
+
+        // confirm caller provided estimated buffer space
+        if (buf.size() < size_buffer(value)) {
+            throw conversion_overrun{"Not enough space in buffer for vector[]"};
+        }
+
+        // important! size_buffer cannot throw an exception on overflow
+        // so perform this check before writing any data
+        if (value.dimensions() > 16000) {
+            throw conversion_overrun{"vector cannot have more than 16000 dimensions"};
+        }
+
+        size_t here = 0;
+        here += pqxx::into_buf(buf.subspan(here), "{", c);
+        for (size_t i = 0; i < value.size(); i++) {
+            if (i != 0) {
+                here += pqxx::into_buf(buf.subspan(here), ",", c);
+            }
+            here += pqxx::into_buf(buf.subspan(here), "\"[", c);
+            size_t j = 0;
+            for (auto v : value[i]) {
+                if (j != 0) {
+                    here += pqxx::into_buf(buf.subspan(here), ",", c);
+                }
+                here += pqxx::into_buf(buf.subspan(here), v, c);
+                j++;
+            }
+            here += pqxx::into_buf(buf.subspan(here), "]\"", c);
+        }
+        here += pqxx::into_buf(buf.subspan(here), "}", c);
+
+        PGVECTOR_INSTRUMENT_SIZE(here, value.size() * value.dimensions());
+        return {std::data(buf), here};
+    }
+
+    static size_t size_buffer(const pgvector::MultiVector& value) noexcept {
+        // cannot throw an exception here on overflow
+        // so throw in into_buf
+
+        size_t size = 0;
+        size += pqxx::size_buffer("{");
+        for (size_t i = 0; i < value.size(); i++) {
+            size += pqxx::size_buffer(",");
+            size += pqxx::size_buffer("\"[");
+            for (const auto v : value[i]) {
+                size += pqxx::size_buffer(",");
+                size += pqxx::size_buffer(v);
+            }
+            size += pqxx::size_buffer("]\"");
+        }
+        size += pqxx::size_buffer("}");
+        return size;
+    }
+};
+
+template<typename T, size_t N>
+struct nullness<pgvector::BasicFixedVector<T, N>> : no_null<pgvector::BasicFixedVector<T, N>> {};
+
+// name_type is not specialized since function templates cannot be partially specialized
+template<typename T, size_t N>
+struct string_traits<pgvector::BasicFixedVector<T, N>> {
+    static_assert(N <= 16000, "vector cannot have more than 16000 dimensions");
+
+    static constexpr std::string_view type = std::is_same_v<T, float> ? "vector" : "halfvec";
+
+    // brackets, commas, and up to 15 characters per element, like -1.00058055e-36
+    static constexpr size_t buffer_size = 2 + N * 15 + (N > 0 ? N - 1 : 0);
+
+    static pgvector::BasicFixedVector<T, N> from_string(std::string_view text, ctx c = {}) {
+        PGVECTOR_INSTRUMENT(Decode, type);
+
+        if (text.size() < 2 || text.front() != '[' || text.back() != ']') {
+            throw conversion_error{"Malformed " + std::string{type} + " literal"};
+        }
+
+        std::array<float, N> values{};
+        size_t n = 0;
+        if (text.size() > 2) {
+            std::string_view inner = text.substr(1, text.size() - 2);
+            for (const auto& v : std::views::split(inner, ',')) {
+                std::string_view sv{v.begin(), v.end()};
+                float value = pqxx::from_string<float>(sv, c);
+                if (n < N) {
+                    values[n] = value;
+                }
+                n++;
+            }
+        }
+        if (n != N) {
+            throw conversion_error{
+                "Expected " + std::to_string(N) + " dimensions, not " + std::to_string(n)
+            };
+        }
+        PGVECTOR_INSTRUMENT_SIZE(text.size(), N);
+
+        if constexpr (std::is_same_v<T, float>) {
+            return pgvector::BasicFixedVector<T, N>{values};
+        } else {
+            std::array<T, N> halves;
+            pgvector::detail::convert(values.data(), halves.data(), N);
+            return pgvector::BasicFixedVector<T, N>{halves};
+        }
+    }
+
+    static std::string_view to_buf(
+        std::span<char> buf,
+        const pgvector::BasicFixedVector<T, N>& value,
+        ctx = {}
+    ) {
+        PGVECTOR_INSTRUMENT(Encode, type);
+
+        if (buf.size() < buffer_size) {
+            throw conversion_overrun{"Not enough space in buffer for " + std::string{type}};
+        }
+
+        // writes shortest round-trip text like into_buf, with the size known up front
+        char* p = buf.data();
+        char* end = p + buf.size();
+        *p++ = '[';
+        for (size_t i = 0; i < N; i++) {
+            if (i != 0) {
+                *p++ = ',';
+            }
+            auto [ptr, ec] = std::to_chars(p, end, static_cast<float>(value.values()[i]));
+            if (ec != std::errc{}) {
+                throw conversion_overrun{"Not enough space in buffer for " + std::string{type}};
+            }
+            p = ptr;
+        }
+        *p++ = ']';
+
+        size_t here = static_cast<size_t>(p - buf.data());
+        PGVECTOR_INSTRUMENT_SIZE(here, N);
+        return {std::data(buf), here};
+    }
+
+    static constexpr size_t size_buffer(const pgvector::BasicFixedVector<T, N>&) noexcept {
+        return buffer_size;
+    }
+};
+
+template<size_t N>
+struct nullness<pgvector::FixedBitVector<N>> : no_null<pgvector::FixedBitVector<N>> {};
+
+template<size_t N>
+struct string_traits<pgvector::FixedBitVector<N>> {
+    static pgvector::FixedBitVector<N> from_string(std::string_view text, ctx = {}) {
+        if (text.size() != N) {
+            throw conversion_error{
+                "Expected " + std::to_string(N) + " dimensions, not " + std::to_string(text.size())
+            };
+        }
+        if (text.find_first_not_of("01") != std::string_view::npos) {
+            throw conversion_error{"Malformed bit literal"};
+        }
+        return pgvector::FixedBitVector<N>{text};
+    }
+
+    static std::string_view to_buf(
+        std::span<char> buf,
+        const pgvector::FixedBitVector<N>& value,
+        ctx = {}
+    ) {
+        if (buf.size() < N) {
+            throw conversion_overrun{"Not enough space in buffer for bit"};
+        }
+        for (size_t i = 0; i < N; i++) {
+            buf[i] = value.test(i) ? '1' : '0';
+        }
+        return {std::data(buf), N};
+    }
+
+    static constexpr size_t size_buffer(const pgvector::FixedBitVector<N>&) noexcept {
+        return N;
+    }
+};
 } // namespace pqxx
 
 /// @endcond
@@ -0,0 +1,134 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "sparsevec.hpp"
+
+namespace pgvector {
+/// How the mass of a sparse vector is measured.
+enum class Norm {
+    /// The sum of absolute values.
+    L1,
+
+    /// The sum of squared values.
+    L2
+};
+
+/// @cond
+namespace detail {
+// ranks NaN first so selection has a strict weak ordering
+inline float magnitude(float v) {
+    return std::isnan(v) ? std::numeric_limits<float>::infinity() : std::abs(v);
+}
+
+// keeps the k largest magnitudes, breaking ties by lower index, in one pass after selection
+inline SparseVector keep_largest(const SparseVector& value, size_t k) {
+    const std::vector<float>& values = value.values();
+    size_t n = values.size();
+    if (k >= n) {
+        return value;
+    }
+    if (k == 0) {
+        return SparseVector{std::vector<int>{}, std::vector<float>{}, value.dimensions()};
+    }
+
+    std::vector<float> magnitudes(n);
+    for (size_t i = 0; i < n; i++) {
+        magnitudes[i] = magnitude(values[i]);
+    }
+    auto kth_it = magnitudes.begin() + static_cast<std::ptrdiff_t>(k - 1);
+    std::nth_element(magnitudes.begin(), kth_it, magnitudes.end(), std::greater<>{});
+    float kth = *kth_it;
+    size_t ties = k;
+    for (auto m : magnitudes) {
+        if (m > kth) {
+            ties--;
+        }
+    }
+
+    const std::vector<int>& indices = value.indices();
+    std::vector<int> kept_indices;
+    std::vector<float> kept_values;
+    kept_indices.reserve(k);
+    kept_values.reserve(k);
+    for (size_t i = 0; i < n; i++) {
+        float m = magnitude(values[i]);
+        if (m > kth || (m == kth && ties > 0)) {
+            if (m == kth) {
+                ties--;
+            }
+            kept_indices.push_back(indices[i]);
+            kept_values.push_back(values[i]);
+        }
+    }
+    return SparseVector{std::move(kept_indices), std::move(kept_values), value.dimensions()};
+}
+} // namespace detail
+/// @endcond
+
+/// Returns the `k` elements with the largest absolute values, breaking ties by lower index.
+inline SparseVector prune_top_k(const SparseVector& value, size_t k) {
+    return detail::keep_largest(value, k);
+}
+
+/// Returns the fewest elements with the largest absolute values that make up a fraction of the
+/// total mass.
+inline SparseVector prune_mass(const SparseVector& value, double fraction, Norm norm = Norm::L1) {
+    if (!(fraction >= 0 && fraction <= 1)) {
+        throw std::invalid_argument{"fraction must be between 0 and 1"};
+    }
+    const std::vector<float>& values = value.values();
+    if (fraction == 1) {
+        return value;
+    }
+
+    std::vector<double> mass(values.size());
+    double total = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        double m = detail::magnitude(values[i]);
+        mass[i] = norm == Norm::L2 ? m * m : m;
+        total += mass[i];
+    }
+    std::ranges::sort(mass, std::greater<>{});
+
+    double target = fraction * total;
+    size_t k = 0;
+    double sum = 0;
+    while (k < mass.size() && sum < target) {
+        sum += mass[k];
+        k++;
+    }
+    return detail::keep_largest(value, k);
+}
+
+/// Returns the elements whose absolute values are greater than a threshold.
+inline SparseVector prune_threshold(const SparseVector& value, float threshold) {
+    if (!(threshold >= 0)) {
+        throw std::invalid_argument{"threshold must be greater than or equal to 0"};
+    }
+    const std::vector<int>& indices = value.indices();
+    const std::vector<float>& values = value.values();
+    std::vector<int> kept_indices;
+    std::vector<float> kept_values;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (detail::magnitude(values[i]) > threshold) {
+            kept_indices.push_back(indices[i]);
+            kept_values.push_back(values[i]);
+        }
+    }
+    return SparseVector{std::move(kept_indices), std::move(kept_values), value.dimensions()};
+}
+} // namespace pgvector
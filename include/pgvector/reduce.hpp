@@ -0,0 +1,536 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "batch.hpp"
+#include "distance.hpp"
+#include "halfvec.hpp"
+#include "math.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+
+namespace pgvector {
+/// Truncation options.
+struct TruncateOptions {
+    /// Whether to normalize truncated vectors to unit length.
+    bool normalize = true;
+
+    /// The number of threads for batches, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// PCA options.
+struct PcaOptions {
+    /// The number of threads, or zero for all hardware threads.
+    size_t threads = 0;
+};
+
+/// @cond
+namespace detail {
+inline void check_truncate(size_t dimensions, size_t available) {
+    if (dimensions == 0) {
+        throw std::invalid_argument{"dimensions must be greater than 0"};
+    }
+    if (dimensions > available) {
+        throw std::invalid_argument{
+            "expected at least " + std::to_string(dimensions) + " dimensions, not "
+            + std::to_string(available)
+        };
+    }
+}
+
+template<typename T>
+std::vector<T> truncate(std::span<const T> value, size_t dimensions, bool normalize) {
+    check_truncate(dimensions, value.size());
+    std::vector<T> result(value.begin(), value.begin() + static_cast<ptrdiff_t>(dimensions));
+    if (normalize) {
+        detail::normalize(result.data(), dimensions);
+    }
+    return result;
+}
+
+// rows per block when computing the covariance, which keeps a transposed block in cache
+inline constexpr size_t pca_block_size = 512;
+
+// returns the upper triangle of the covariance matrix, summing each element in the same
+// order for any number of threads so fits are reproducible
+inline std::vector<double> covariance(
+    const VectorBatch<float>& data,
+    std::span<const double> mean,
+    size_t threads
+) {
+    size_t n = data.rows();
+    size_t d = data.dimensions();
+    std::vector<double> cov(d * d);
+    std::vector<float> block(d * pca_block_size);
+    threads = std::min(thread_count(threads), d);
+    for (size_t start = 0; start < n; start += pca_block_size) {
+        size_t b = std::min(pca_block_size, n - start);
+        // center and transpose so each dimension is contiguous
+        for (size_t r = 0; r < b; r++) {
+            std::span<const float> row = data.row(start + r);
+            for (size_t i = 0; i < d; i++) {
+                block[i * b + r] = static_cast<float>(row[i] - mean[i]);
+            }
+        }
+        // interleave rows of the triangle across threads to balance work
+        parallel_for(threads, threads, [&](size_t, size_t, size_t t) {
+            for (size_t i = t; i < d; i += threads) {
+                const float* a = block.data() + i * b;
+                double* out = cov.data() + i * d;
+                for (size_t j = i; j < d; j++) {
+                    out[j] += dot(a, block.data() + j * b, b);
+                }
+            }
+        });
+    }
+    return cov;
+}
+
+// uses several sums so the compiler can vectorize without reordering
+inline double dot_double(const double* a, const double* b, size_t n) {
+    double s[4] = {0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t j = 0; j < 4; j++) {
+            s[j] += a[i + j] * b[i + j];
+        }
+    }
+    for (; i < n; i++) {
+        s[0] += a[i] * b[i];
+    }
+    return (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+// finds eigenvalues and eigenvectors of a symmetric matrix with Householder tridiagonalization
+// and the QL algorithm, based on the public domain JAMA library, with the matrix transposed so
+// loops are over contiguous memory
+//
+// w holds the upper triangle on input and eigenvectors as rows on output, with eigenvalues
+// returned unsorted
+inline std::vector<double> symmetric_eigen(std::vector<double>& w, size_t n, size_t threads) {
+    auto at = [&](size_t i, size_t j) -> double& {
+        return w[i * n + j];
+    };
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            at(i, j) = at(j, i);
+        }
+    }
+
+    std::vector<double> d(n);
+    std::vector<double> e(n);
+    for (size_t j = 0; j < n; j++) {
+        d[j] = at(j, n - 1);
+    }
+
+    // tridiagonalize
+    for (size_t i = n - 1; i > 0; i--) {
+        double scale = 0;
+        double h = 0;
+        for (size_t k = 0; k < i; k++) {
+            scale += std::fabs(d[k]);
+        }
+        if (scale == 0) {
+            e[i] = d[i - 1];
+            for (size_t j = 0; j < i; j++) {
+                d[j] = at(j, i - 1);
+                at(j, i) = 0;
+                at(i, j) = 0;
+            }
+        } else {
+            for (size_t k = 0; k < i; k++) {
+                d[k] /= scale;
+                h += d[k] * d[k];
+            }
+            double f = d[i - 1];
+            double g = std::sqrt(h);
+            if (f > 0) {
+                g = -g;
+            }
+            e[i] = scale * g;
+            h -= f * g;
+            d[i - 1] = f - g;
+            for (size_t j = 0; j < i; j++) {
+                e[j] = 0;
+            }
+            for (size_t j = 0; j < i; j++) {
+                f = d[j];
+                at(i, j) = f;
+                const double* row = &at(j, 0);
+                g = e[j] + row[j] * f + dot_double(row + j + 1, d.data() + j + 1, i - j - 1);
+                for (size_t k = j + 1; k < i; k++) {
+                    e[k] += row[k] * f;
+                }
+                e[j] = g;
+            }
+            f = 0;
+            for (size_t j = 0; j < i; j++) {
+                e[j] /= h;
+                f += e[j] * d[j];
+            }
+            double hh = f / (h + h);
+            for (size_t j = 0; j < i; j++) {
+                e[j] -= hh * d[j];
+            }
+            for (size_t j = 0; j < i; j++) {
+                f = d[j];
+                g = e[j];
+                for (size_t k = j; k < i; k++) {
+                    at(j, k) -= f * e[k] + g * d[k];
+                }
+                d[j] = at(j, i - 1);
+                at(j, i) = 0;
+            }
+        }
+        d[i] = h;
+    }
+
+    // accumulate transformations
+    for (size_t i = 0; i + 1 < n; i++) {
+        at(i, n - 1) = at(i, i);
+        at(i, i) = 1;
+        double h = d[i + 1];
+        if (h != 0) {
+            for (size_t k = 0; k <= i; k++) {
+                d[k] = at(i + 1, k) / h;
+            }
+            // rows are independent
+            size_t rows = i + 1;
+            size_t row_threads = batch_threads(threads, rows, rows);
+            parallel_for(rows, row_threads, [&](size_t begin, size_t end, size_t) {
+                for (size_t j = begin; j < end; j++) {
+                    double g = dot_double(&at(i + 1, 0), &at(j, 0), i + 1);
+                    for (size_t k = 0; k <= i; k++) {
+                        at(j, k) -= g * d[k];
+                    }
+                }
+            });
+        }
+        for (size_t k = 0; k <= i; k++) {
+            at(i + 1, k) = 0;
+        }
+    }
+    for (size_t j = 0; j < n; j++) {
+        d[j] = at(j, n - 1);
+        at(j, n - 1) = 0;
+    }
+    at(n - 1, n - 1) = 1;
+    e[0] = 0;
+
+    // diagonalize
+    for (size_t i = 1; i < n; i++) {
+        e[i - 1] = e[i];
+    }
+    e[n - 1] = 0;
+
+    struct Rotation {
+        size_t row;
+        double c;
+        double s;
+    };
+    std::vector<Rotation> rotations;
+
+    double f = 0;
+    double tst1 = 0;
+    double eps = std::numeric_limits<double>::epsilon();
+    for (size_t l = 0; l < n; l++) {
+        tst1 = std::max(tst1, std::fabs(d[l]) + std::fabs(e[l]));
+        size_t m = l;
+        // e[n - 1] is zero, so this stops
+        while (std::fabs(e[m]) > eps * tst1) {
+            m++;
+        }
+        if (m > l) {
+            do {
+                double g = d[l];
+                double p = (d[l + 1] - g) / (2 * e[l]);
+                double r = std::hypot(p, 1.0);
+                if (p < 0) {
+                    r = -r;
+                }
+                d[l] = e[l] / (p + r);
+                d[l + 1] = e[l] * (p + r);
+                double dl1 = d[l + 1];
+                double h = g - d[l];
+                for (size_t i = l + 2; i < n; i++) {
+                    d[i] -= h;
+                }
+                f += h;
+
+                p = d[m];
+                double c = 1;
+                double c2 = c;
+                double c3 = c;
+                double el1 = e[l + 1];
+                double s = 0;
+                double s2 = 0;
+                rotations.clear();
+                for (size_t i = m; i-- > l;) {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[i];
+                    h = c * p;
+                    r = std::hypot(p, e[i]);
+                    e[i + 1] = s * r;
+                    s = e[i] / r;
+                    c = p / r;
+                    p = c * d[i] - s * g;
+                    d[i + 1] = h + s * (c * g + s * d[i]);
+                    rotations.push_back({i, c, s});
+                }
+
+                // apply rotations to eigenvectors in the same order for each column, so
+                // columns can be split across threads
+                size_t rotation_threads = batch_threads(threads, rotations.size(), n);
+                parallel_for(n, rotation_threads, [&](size_t begin, size_t end, size_t) {
+                    for (const auto [row, rc, rs] : rotations) {
+                        double* v0 = &at(row, 0);
+                        double* v1 = &at(row + 1, 0);
+                        for (size_t k = begin; k < end; k++) {
+                            double t = v1[k];
+                            v1[k] = rs * v0[k] + rc * t;
+                            v0[k] = rc * v0[k] - rs * t;
+                        }
+                    }
+                });
+
+                p = -s * s2 * c3 * el1 * e[l] / dl1;
+                e[l] = s * p;
+                d[l] = c * p;
+            } while (std::fabs(e[l]) > eps * tst1);
+        }
+        d[l] += f;
+        e[l] = 0;
+    }
+    return d;
+}
+} // namespace detail
+/// @endcond
+
+/// Returns the first dimensions of a vector, like `subvector` on the server, normalized by
+/// default.
+///
+/// Use with Matryoshka embeddings, which are trained so prefixes are embeddings themselves.
+inline Vector truncate(
+    const Vector& value,
+    size_t dimensions,
+    const TruncateOptions& options = {}
+) {
+    return Vector{
+        detail::truncate(std::span<const float>{value.values()}, dimensions, options.normalize)
+    };
+}
+
+/// Returns the first dimensions of a half vector, normalized by default.
+inline HalfVector truncate(
+    const HalfVector& value,
+    size_t dimensions,
+    const TruncateOptions& options = {}
+) {
+    return HalfVector{
+        detail::truncate(std::span<const Half>{value.values()}, dimensions, options.normalize)
+    };
+}
+
+/// Returns the first dimensions of each vector in a batch, normalized by default.
+template<typename T>
+VectorBatch<T> truncate(
+    const VectorBatch<T>& batch,
+    size_t dimensions,
+    const TruncateOptions& options = {}
+) {
+    detail::check_truncate(dimensions, batch.dimensions());
+    VectorBatch<T> result{dimensions, batch.rows()};
+    size_t threads = detail::batch_threads(options.threads, batch.rows(), dimensions);
+    detail::parallel_for(batch.rows(), threads, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) {
+            std::span<T> row = result.row(i);
+            std::copy_n(batch.row(i).begin(), dimensions, row.begin());
+            if (options.normalize) {
+                detail::normalize(row.data(), dimensions);
+            }
+        }
+    });
+    return result;
+}
+
+/// Principal component analysis, which projects vectors onto the directions with the most
+/// variance.
+///
+/// Fitting is deterministic, giving the same components for the same vectors with any number
+/// of threads. Components are ordered by variance and signed so their largest element is
+/// positive.
+class Pca {
+  public:
+    /// Fits principal components to vectors.
+    Pca(const VectorBatch<float>& data, size_t components, const PcaOptions& options = {}) :
+        options_{options},
+        components_{data.dimensions()} {
+        size_t d = data.dimensions();
+        if (components == 0) {
+            throw std::invalid_argument{"components must be greater than 0"};
+        }
+        if (components > d) {
+            throw std::invalid_argument{"components must be at most the number of dimensions"};
+        }
+        if (data.rows() < 2) {
+            throw std::invalid_argument{"expected at least 2 vectors"};
+        }
+
+        std::vector<double> mean(d);
+        for (size_t r = 0; r < data.rows(); r++) {
+            std::span<const float> row = data.row(r);
+            for (size_t i = 0; i < d; i++) {
+                mean[i] += row[i];
+            }
+        }
+        for (auto& v : mean) {
+            v /= static_cast<double>(data.rows());
+        }
+        mean_.assign(mean.begin(), mean.end());
+
+        std::vector<double> w = detail::covariance(data, mean, options.threads);
+        std::vector<double> eigenvalues = detail::symmetric_eigen(w, d, options.threads);
+
+        // largest first, breaking ties by index so the order is stable
+        std::vector<size_t> order(d);
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return eigenvalues[a] > eigenvalues[b];
+        });
+
+        double scale = 1.0 / static_cast<double>(data.rows() - 1);
+        components_.reserve(components);
+        std::vector<float> component(d);
+        for (size_t c = 0; c < components; c++) {
+            const double* v = w.data() + order[c] * d;
+            size_t largest = 0;
+            for (size_t i = 1; i < d; i++) {
+                if (std::fabs(v[i]) > std::fabs(v[largest])) {
+                    largest = i;
+                }
+            }
+            double sign = v[largest] < 0 ? -1 : 1;
+            for (size_t i = 0; i < d; i++) {
+                component[i] = static_cast<float>(sign * v[i]);
+            }
+            components_.push_back(component);
+            explained_variance_.push_back(
+                static_cast<float>(std::max(eigenvalues[order[c]] * scale, 0.0))
+            );
+        }
+    }
+
+    /// Creates a PCA from components and a mean returned by another, like after storing them.
+    Pca(
+        const VectorBatch<float>& components,
+        std::span<const float> mean,
+        const PcaOptions& options = {}
+    ) :
+        options_{options},
+        components_{components},
+        mean_(mean.begin(), mean.end()) {
+        if (components.rows() == 0) {
+            throw std::invalid_argument{"components must be greater than 0"};
+        }
+        detail::check_dimensions(components.dimensions(), mean.size());
+    }
+
+    /// Returns the number of input dimensions.
+    size_t dimensions() const {
+        return components_.dimensions();
+    }
+
+    /// Returns the options.
+    const PcaOptions& options() const {
+        return options_;
+    }
+
+    /// Returns the components, one per row.
+    const VectorBatch<float>& components() const {
+        return components_;
+    }
+
+    /// Returns the mean of the fitted vectors.
+    std::span<const float> mean() const {
+        return mean_;
+    }
+
+    /// Returns the variance along each component, which is empty if created from components.
+    std::span<const float> explained_variance() const {
+        return explained_variance_;
+    }
+
+    /// Projects a vector onto the components.
+    std::vector<float> transform(std::span<const float> value) const {
+        check_dimensions(value.size());
+        std::vector<float> result(components_.rows());
+        std::vector<float> centered(dimensions());
+        project(value, centered, result);
+        return result;
+    }
+
+    /// Projects a vector onto the components.
+    Vector transform(const Vector& value) const {
+        return Vector{transform(std::span<const float>{value.values()})};
+    }
+
+    /// Projects vectors onto the components in parallel.
+    VectorBatch<float> transform(const VectorBatch<float>& values) const {
+        check_dimensions(values.dimensions());
+        VectorBatch<float> result{components_.rows(), values.rows()};
+        size_t threads = detail::batch_threads(
+            options_.threads, values.rows(), dimensions() * components_.rows()
+        );
+        detail::parallel_for(values.rows(), threads, [&](size_t begin, size_t end, size_t) {
+            std::vector<float> centered(dimensions());
+            for (size_t i = begin; i < end; i++) {
+                project(values.row(i), centered, result.row(i));
+            }
+        });
+        return result;
+    }
+
+  private:
+    void check_dimensions(size_t dimensions) const {
+        if (dimensions != this->dimensions()) {
+            throw std::invalid_argument{
+                "expected " + std::to_string(this->dimensions()) + " dimensions, not "
+                + std::to_string(dimensions)
+            };
+        }
+    }
+
+    void project(std::span<const float> value, std::span<float> centered, std::span<float> out)
+        const {
+        size_t d = dimensions();
+        for (size_t i = 0; i < d; i++) {
+            centered[i] = value[i] - mean_[i];
+        }
+        for (size_t c = 0; c < out.size(); c++) {
+            out[c] = detail::dot(components_.row(c).data(), centered.data(), d);
+        }
+    }
+
+    PcaOptions options_;
+    VectorBatch<float> components_;
+    std::vector<float> mean_;
+    std::vector<float> explained_variance_;
+};
+} // namespace pgvector
@@ -0,0 +1,291 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include "distance.hpp"
+#include "neighbor.hpp"
+#include "instrumentation.hpp"
+#include "pqxx.hpp"
+#include "sql.hpp"
+
+namespace pgvector {
+/// Scatter-gather search options.
+struct ScatterOptions {
+    /// The id column.
+    std::string id_column = "id";
+
+    /// The vector column.
+    std::string column = "embedding";
+
+    /// The distance metric, which determines the operator.
+    Metric metric = Metric::L2;
+
+    /// How long to wait for each shard, or zero to wait until all shards respond.
+    std::chrono::steady_clock::duration timeout{0};
+};
+
+/// How a shard responded to a search.
+enum class ShardStatus {
+    /// The shard returned its neighbors.
+    Ok,
+
+    /// The shard did not respond within the timeout and its search was canceled.
+    Timeout,
+
+    /// The shard could not be reached or the query failed.
+    Error
+};
+
+/// The response from one shard.
+struct ShardResult {
+    /// How the shard responded.
+    ShardStatus status = ShardStatus::Ok;
+
+    /// The nearest neighbors on the shard, sorted by distance.
+    std::vector<Neighbor> neighbors = {};
+
+    /// The error message, if any.
+    std::string error = {};
+
+    /// The time until the shard responded.
+    std::chrono::duration<double> time{0};
+};
+
+/// The merged result of a scatter-gather search.
+struct ScatterResult {
+    /// The nearest neighbors across responding shards, sorted by distance.
+    std::vector<Neighbor> neighbors;
+
+    /// The response from each shard, in the order of the connection strings.
+    std::vector<ShardResult> shards;
+
+    /// Returns whether any shard did not respond, so neighbors may be missing.
+    bool partial() const {
+        for (const auto& s : shards) {
+            if (s.status != ShardStatus::Ok) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+/// Searches a table sharded across independent servers and merges the results.
+///
+/// Each search sends the same query to every shard concurrently, one thread and connection per
+/// shard, and merges each shard's neighbors into a global top k as it responds. Ids should be
+/// unique across shards. Shards that fail or exceed the timeout are reported instead of
+/// failing the search. Connections are opened on first use and reopened after errors, so add
+/// `connect_timeout` to connection strings to bound the time to reach a server that is down.
+/// Searches on the same object run one at a time.
+class ScatterGather {
+  public:
+    /// Creates a search over a table on each server.
+    ScatterGather(
+        std::vector<std::string> conninfos,
+        std::string table,
+        const ScatterOptions& options = {}
+    ) :
+        table_{std::move(table)},
+        options_{options},
+        op_{detail::metric_operator(options.metric)} {
+        if (conninfos.empty()) {
+            throw std::invalid_argument{"expected at least one shard"};
+        }
+        shards_.reserve(conninfos.size());
+        for (auto& conninfo : conninfos) {
+            shards_.push_back(std::make_unique<Shard>());
+            shards_.back()->conninfo = std::move(conninfo);
+        }
+    }
+
+    ScatterGather(const ScatterGather&) = delete;
+    ScatterGather& operator=(const ScatterGather&) = delete;
+
+    /// Returns the number of shards.
+    size_t shards() const {
+        return shards_.size();
+    }
+
+    /// Returns the options.
+    const ScatterOptions& options() const {
+        return options_;
+    }
+
+    /// Returns the `k` nearest neighbors across all shards.
+    template<typename V>
+    ScatterResult search(const V& query, size_t k) {
+        PGVECTOR_INSTRUMENT(Search, "scatter");
+        PGVECTOR_INSTRUMENT_SIZE(0, 1);
+
+        std::lock_guard search_lock{search_mutex_};
+
+        size_t n = shards_.size();
+        ScatterResult result;
+        result.shards.resize(n);
+        TopK top{k};
+        std::mutex mutex;
+        std::condition_variable responded;
+        size_t pending = n;
+        std::atomic<bool> expired = false;
+
+        auto run = [&](size_t i) {
+            auto start = std::chrono::steady_clock::now();
+            ShardResult shard_result;
+            try {
+                shard_result.neighbors = query_shard(*shards_[i], query, k, expired);
+            } catch (const pqxx::query_cancelled& e) {
+                shard_result.status = ShardStatus::Timeout;
+                shard_result.error = e.what();
+            } catch (const std::exception& e) {
+                shard_result.status = ShardStatus::Error;
+                shard_result.error = e.what();
+                shards_[i]->conn.reset();
+            }
+            shard_result.time = std::chrono::steady_clock::now() - start;
+
+            std::lock_guard lock{mutex};
+            // drop results that arrive after the deadline so the timeout is honored
+            if (expired && shard_result.status == ShardStatus::Ok) {
+                shard_result.status = ShardStatus::Timeout;
+                shard_result.error = "timed out";
+                shard_result.neighbors.clear();
+            }
+            for (const auto& v : shard_result.neighbors) {
+                top.push(v.id, v.distance);
+            }
+            result.shards[i] = std::move(shard_result);
+            pending--;
+            responded.notify_one();
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            threads.emplace_back(run, i);
+        }
+
+        {
+            std::unique_lock lock{mutex};
+            auto done = [&] { return pending == 0; };
+            if (options_.timeout.count() > 0) {
+                auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+                if (!responded.wait_until(lock, deadline, done)) {
+                    expired = true;
+                }
+            } else {
+                responded.wait(lock, done);
+            }
+        }
+
+        // cancel queries still running so their threads can be joined
+        if (expired) {
+            for (auto& shard : shards_) {
+                std::lock_guard lock{shard->mutex};
+                if (shard->running) {
+                    try {
+                        shard->conn->cancel_query();
+                    } catch (...) {
+                        // the query will still stop at the server's statement_timeout
+                    }
+                }
+            }
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        result.neighbors = top.sorted();
+        return result;
+    }
+
+  private:
+    struct Shard {
+        std::string conninfo;
+        std::unique_ptr<pqxx::connection> conn;
+        // guards running so the conn can be canceled from another thread
+        std::mutex mutex;
+        bool running = false;
+    };
+
+    template<typename V>
+    std::vector<Neighbor> query_shard(
+        Shard& shard,
+        const V& query,
+        size_t k,
+        const std::atomic<bool>& expired
+    ) {
+        if (!shard.conn || !shard.conn->is_open()) {
+            shard.conn.reset();
+            auto conn = std::make_unique<pqxx::connection>(shard.conninfo);
+            if (options_.timeout.count() > 0) {
+                // also stop the query on the server in case the cancel request is lost
+                auto ms = std::chrono::ceil<std::chrono::milliseconds>(options_.timeout);
+                pqxx::nontransaction tx{*conn};
+                tx.exec("SET statement_timeout = " + std::to_string(ms.count()));
+            }
+            shard.conn = std::move(conn);
+        }
+
+        pqxx::nontransaction tx{*shard.conn};
+        std::string distance = detail::quote_name(options_.column) + " " + op_ + " $1";
+        std::string sql = "SELECT " + detail::quote_name(options_.id_column) + ", " + distance
+            + " FROM " + detail::quote_name(table_) + " ORDER BY " + distance + " LIMIT $2";
+        pqxx::params params{query, static_cast<int64_t>(k)};
+
+        {
+            std::lock_guard lock{shard.mutex};
+            // reported as a timeout by the caller
+            if (expired) {
+                return {};
+            }
+            shard.running = true;
+        }
+        pqxx::result rows;
+        try {
+            rows = tx.exec(sql, params);
+        } catch (...) {
+            std::lock_guard lock{shard.mutex};
+            shard.running = false;
+            throw;
+        }
+        {
+            std::lock_guard lock{shard.mutex};
+            shard.running = false;
+        }
+
+        std::vector<Neighbor> neighbors;
+        neighbors.reserve(rows.size());
+        for (const auto& row : rows) {
+            neighbors.push_back({row[0].as<int64_t>(), row[1].as<float>()});
+        }
+        return neighbors;
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::string table_;
+    ScatterOptions options_;
+    const char* op_;
+    std::mutex search_mutex_;
+};
+} // namespace pgvector
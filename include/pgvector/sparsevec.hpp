@@ -7,14 +7,118 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <ostream>
 #include <span>
 #include <stdexcept>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// @cond
+namespace pgvector::detail {
+// compares magnitudes as integers, which keeps NaN like other non-zero values
+inline bool above(float v, uint32_t threshold_bits) {
+    return (std::bit_cast<uint32_t>(v) & 0x7FFFFFFF) > threshold_bits;
+}
+
+// returns a bit for each element whose magnitude is above the threshold, also keeping NaN
+#if defined(__AVX__)
+inline constexpr size_t above_width = 8;
+
+inline unsigned above_mask(const float* p, float threshold) {
+    __m256 abs = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_loadu_ps(p));
+    __m256 cmp = _mm256_cmp_ps(abs, _mm256_set1_ps(threshold), _CMP_NLE_UQ);
+    return static_cast<unsigned>(_mm256_movemask_ps(cmp));
+}
+
+inline size_t above_count(unsigned mask) {
+    return static_cast<size_t>(std::popcount(mask));
+}
+#elif defined(__SSE2__)
+inline constexpr size_t above_width = 4;
+
+inline unsigned above_mask(const float* p, float threshold) {
+    __m128 abs = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_loadu_ps(p));
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpnle_ps(abs, _mm_set1_ps(threshold))));
+}
+
+// a nibble lookup, since popcount is a library call without -mpopcnt
+inline size_t above_count(unsigned mask) {
+    return static_cast<size_t>((0x4332322132212110 >> (mask * 4)) & 0xF);
+}
+#endif
+
+inline size_t count_above(const float* x, size_t n, float threshold) {
+    size_t i = 0;
+    size_t count = 0;
+#if defined(__AVX__) || defined(__SSE2__)
+    for (; i + above_width <= n; i += above_width) {
+        count += above_count(above_mask(x + i, threshold));
+    }
+#endif
+    uint32_t threshold_bits = std::bit_cast<uint32_t>(threshold + 0.0f);
+    for (; i < n; i++) {
+        count += above(x[i], threshold_bits) ? 1 : 0;
+    }
+    return count;
+}
+
+inline void compact_above(
+    const float* x,
+    size_t n,
+    float threshold,
+    int* indices,
+    float* values
+) {
+    size_t i = 0;
+    size_t j = 0;
+#if defined(__AVX512F__)
+    __m512 t = _mm512_set1_ps(threshold);
+    __m512i offsets = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    for (; i + 16 <= n; i += 16) {
+        __m512 v = _mm512_loadu_ps(x + i);
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_abs_ps(v), t, _CMP_NLE_UQ);
+        if (mask == 0) {
+            continue;
+        }
+        __m512i idx = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(i)), offsets);
+        _mm512_mask_compressstoreu_ps(values + j, mask, v);
+        _mm512_mask_compressstoreu_epi32(indices + j, mask, idx);
+        j += static_cast<size_t>(std::popcount(static_cast<unsigned>(mask)));
+    }
+#elif defined(__AVX__) || defined(__SSE2__)
+    // visit only the set bits, so runs of zeros cost one compare per block
+    for (; i + above_width <= n; i += above_width) {
+        for (unsigned mask = above_mask(x + i, threshold); mask != 0; mask &= mask - 1) {
+            size_t k = i + static_cast<size_t>(std::countr_zero(mask));
+            indices[j] = static_cast<int>(k);
+            values[j] = x[k];
+            j++;
+        }
+    }
+#endif
+    uint32_t threshold_bits = std::bit_cast<uint32_t>(threshold + 0.0f);
+    for (; i < n; i++) {
+        if (above(x[i], threshold_bits)) {
+            indices[j] = static_cast<int>(i);
+            values[j] = x[i];
+            j++;
+        }
+    }
+}
+} // namespace pgvector::detail
+/// @endcond
+
 namespace pgvector {
 /// A sparse vector.
 class SparseVector {
@@ -24,47 +128,56 @@ class SparseVector {
         SparseVector(std::span<const float>{value}) {}
 
     /// Creates a sparse vector from a span.
-    explicit SparseVector(std::span<const float> value) {
+    explicit SparseVector(std::span<const float> value) : SparseVector(value, 0.0f) {}
+
+    /// Creates a sparse vector from a dense vector, dropping elements whose absolute value is
+    /// not greater than a threshold.
+    SparseVector(const std::vector<float>& value, float threshold) :
+        SparseVector(std::span<const float>{value}, threshold) {}
+
+    /// Creates a sparse vector from a span, dropping elements whose absolute value is not
+    /// greater than a threshold.
+    SparseVector(std::span<const float> value, float threshold) {
         if (value.size() > std::numeric_limits<int>::max()) {
             throw std::invalid_argument{"sparsevec cannot have more than max int dimensions"};
         }
+        if (!(threshold >= 0)) {
+            throw std::invalid_argument{"threshold must be greater than or equal to 0"};
+        }
         dimensions_ = static_cast<int>(value.size());
 
-        // do not reserve capacity for indices/values since likely many zeros
-        // TODO use std::views::enumerate for C++23
-        size_t i = 0;
-        for (auto v : value) {
-            if (v != 0) {
-                indices_.push_back(static_cast<int>(i));
-                values_.push_back(v);
-            }
-            i++;
-        }
+        // count first so storage is allocated once
+        size_t n = detail::count_above(value.data(), value.size(), threshold);
+        indices_.resize(n);
+        values_.resize(n);
+        const float* x = value.data();
+        detail::compact_above(x, value.size(), threshold, indices_.data(), values_.data());
     }
 
     /// Creates a sparse vector from a map of non-zero elements.
     SparseVector(const std::unordered_map<int, float>& map, int dimensions) {
-        if (dimensions < 0) {
-            throw std::invalid_argument{"sparsevec cannot have negative dimensions"};
-        }
-        dimensions_ = dimensions;
-
-        // could probably reserve capacity for indices since not expecting zeros
+        indices_.reserve(map.size());
+        values_.reserve(map.size());
         for (const auto& [i, v] : map) {
-            if (i < 0 || i >= dimensions) {
-                throw std::invalid_argument{"sparsevec index out of bounds"};
-            }
-
-            if (v != 0) {
-                indices_.push_back(i);
-            }
+            indices_.push_back(i);
+            values_.push_back(v);
         }
-        std::ranges::sort(indices_);
+        init(dimensions);
+    }
 
-        values_.reserve(indices_.size());
-        for (const auto i : indices_) {
-            values_.push_back(map.at(i));
-        }
+    /// Creates a sparse vector from indices and values, sorting them by index if needed.
+    SparseVector(std::span<const int> indices, std::span<const float> values, int dimensions) :
+        indices_(indices.begin(), indices.end()),
+        values_(values.begin(), values.end()) {
+        init(dimensions);
+    }
+
+    /// Creates a sparse vector from indices and values without copying, sorting them by index if
+    /// needed.
+    SparseVector(std::vector<int>&& indices, std::vector<float>&& values, int dimensions) :
+        indices_(std::move(indices)),
+        values_(std::move(values)) {
+        init(dimensions);
     }
 
     /// Returns the number of dimensions.
@@ -103,6 +216,97 @@ class SparseVector {
         return os;
     }
 
+  private:
+    // validates sorted input in one pass, and sorts other input first
+    void init(int dimensions) {
+        if (dimensions < 0) {
+            throw std::invalid_argument{"sparsevec cannot have negative dimensions"};
+        }
+        if (indices_.size() != values_.size()) {
+            throw std::invalid_argument{"sparsevec indices and values must have the same size"};
+        }
+        dimensions_ = dimensions;
+
+        size_t n = indices_.size();
+        size_t zeros = 0;
+        bool sorted = true;
+        for (size_t i = 0; i < n; i++) {
+            int index = indices_[i];
+            if (index < 0 || index >= dimensions) {
+                throw std::invalid_argument{"sparsevec index out of bounds"};
+            }
+            if (i > 0 && index <= indices_[i - 1]) {
+                if (index == indices_[i - 1]) {
+                    throw std::invalid_argument{"sparsevec cannot have duplicate indices"};
+                }
+                sorted = false;
+            }
+            if (values_[i] == 0) {
+                zeros++;
+            }
+        }
+
+        if (!sorted) {
+            std::vector<std::pair<int, float>> pairs(n);
+            for (size_t i = 0; i < n; i++) {
+                pairs[i] = {indices_[i], values_[i]};
+            }
+            std::ranges::sort(pairs, {}, &std::pair<int, float>::first);
+            for (size_t i = 0; i < n; i++) {
+                if (i > 0 && pairs[i].first == pairs[i - 1].first) {
+                    throw std::invalid_argument{"sparsevec cannot have duplicate indices"};
+                }
+                indices_[i] = pairs[i].first;
+                values_[i] = pairs[i].second;
+            }
+        }
+
+        // zeros are not stored
+        if (zeros > 0) {
+            size_t j = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (values_[i] != 0) {
+                    indices_[j] = indices_[i];
+                    values_[j] = values_[i];
+                    j++;
+                }
+            }
+            indices_.resize(j);
+            values_.resize(j);
+        }
+    }
+
+    int dimensions_;
+    std::vector<int> indices_;
+    std::vector<float> values_;
+};
+
+/// Builds a sparse vector one non-zero element at a time.
+class SparseVectorBuilder {
+  public:
+    /// Creates a builder.
+    explicit SparseVectorBuilder(int dimensions) : dimensions_{dimensions} {}
+
+    /// Reserves space for elements.
+    void reserve(size_t n) {
+        indices_.reserve(n);
+        values_.reserve(n);
+    }
+
+    /// Adds an element, ideally in order of index.
+    void push_back(int index, float value) {
+        indices_.push_back(index);
+        values_.push_back(value);
+    }
+
+    /// Returns the sparse vector and clears the builder.
+    SparseVector build() {
+        SparseVector result{std::move(indices_), std::move(values_), dimensions_};
+        indices_.clear();
+        values_.clear();
+        return result;
+    }
+
   private:
     int dimensions_;
     std::vector<int> indices_;
@@ -0,0 +1,40 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+/// @cond
+
+namespace pgvector::detail {
+// quotes an identifier like quote_ident on the server, without needing a connection
+inline std::string quote_name(std::string_view name) {
+    std::string result = "\"";
+    for (char c : name) {
+        if (c == '"') {
+            result += '"';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+// quotes a string literal like quote_literal on the server, for standard_conforming_strings
+inline std::string quote_literal(std::string_view value) {
+    std::string result = "'";
+    for (char c : value) {
+        if (c == '\'') {
+            result += '\'';
+        }
+        result += c;
+    }
+    return result + "'";
+}
+} // namespace pgvector::detail
+
+/// @endcond
@@ -0,0 +1,251 @@
+/*
+ * pgvector-cpp v0.3.0
+ * https://github.com/pgvector/pgvector-cpp
+ * MIT License
+ */
+
+#pragma once
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define PGVECTOR_HAS_MMAP 1
+#endif
+
+namespace pgvector {
+/// How records in a file will be read.
+enum class VecsAccess {
+    /// In order, so pages are read ahead aggressively.
+    Sequential,
+
+    /// In any order, like queries or ground truth lookups.
+    Random
+};
+
+/// A read-only fvecs, bvecs, or ivecs file.
+///
+/// Each record is a little-endian int32 number of dimensions followed by that many values. The
+/// file is memory-mapped on POSIX systems, so records are views into the mapping and nothing is
+/// copied, and read into memory otherwise.
+template<typename T>
+class VecsFile {
+    static_assert(
+        std::is_same_v<T, float> || std::is_same_v<T, uint8_t> || std::is_same_v<T, int32_t>,
+        "VecsFile requires float, uint8_t, or int32_t"
+    );
+
+  public:
+    /// The element type.
+    using value_type = T;
+
+    /// Opens a file.
+    explicit VecsFile(const std::string& path, VecsAccess access = VecsAccess::Sequential) {
+        open(path, access);
+        try {
+            validate();
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    VecsFile(const VecsFile&) = delete;
+    VecsFile& operator=(const VecsFile&) = delete;
+
+    /// Moves a file.
+    VecsFile(VecsFile&& other) noexcept {
+        swap(other);
+    }
+
+    /// Moves a file.
+    VecsFile& operator=(VecsFile&& other) noexcept {
+        VecsFile tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~VecsFile() {
+        release();
+    }
+
+    /// Returns the number of records.
+    size_t rows() const {
+        return rows_;
+    }
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return dimensions_;
+    }
+
+    /// Returns whether the file has no records.
+    bool empty() const {
+        return rows_ == 0;
+    }
+
+    /// Returns a record, checking its header.
+    std::span<const T> row(size_t i) const {
+        if (i >= rows_) {
+            throw std::out_of_range{"record out of range"};
+        }
+        const unsigned char* p = data_ + i * record_;
+        if (static_cast<size_t>(header(p)) != dimensions_) {
+            throw std::runtime_error{
+                "invalid vecs file: record " + std::to_string(i) + " has different dimensions"
+            };
+        }
+        return {reinterpret_cast<const T*>(p + 4), dimensions_};
+    }
+
+    /// Returns a record, checking its header.
+    std::span<const T> operator[](size_t i) const {
+        return row(i);
+    }
+
+  private:
+    static int32_t header(const unsigned char* p) {
+        uint32_t v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+            | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        return static_cast<int32_t>(v);
+    }
+
+    void open(const std::string& path, VecsAccess access) {
+#ifdef PGVECTOR_HAS_MMAP
+        // values can only be viewed in place when the host is little-endian
+        if constexpr (std::endian::native == std::endian::little) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::system_error{errno, std::generic_category(), "could not open " + path};
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                int error = errno;
+                close(fd);
+                throw std::system_error{error, std::generic_category(), "could not stat " + path};
+            }
+            size_ = static_cast<size_t>(st.st_size);
+            if (size_ > 0) {
+                void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    int error = errno;
+                    close(fd);
+                    throw std::system_error{
+                        error, std::generic_category(), "could not map " + path
+                    };
+                }
+                int advice = access == VecsAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM;
+                madvise(p, size_, advice);
+                data_ = static_cast<const unsigned char*>(p);
+                mapped_ = true;
+            }
+            close(fd);
+            return;
+        }
+#endif
+        static_cast<void>(access);
+        read(path);
+    }
+
+    // checks the first header and the size, since checking every header would read every page
+    void validate() {
+        if (size_ == 0) {
+            return;
+        }
+        if (size_ < 4) {
+            throw std::runtime_error{"invalid vecs file: truncated header"};
+        }
+        int32_t dimensions = header(data_);
+        if (dimensions <= 0) {
+            throw std::runtime_error{"invalid vecs file: dimensions must be greater than 0"};
+        }
+        dimensions_ = static_cast<size_t>(dimensions);
+        record_ = 4 + dimensions_ * sizeof(T);
+        if (size_ % record_ != 0) {
+            throw std::runtime_error{"invalid vecs file: truncated record"};
+        }
+        rows_ = size_ / record_;
+    }
+
+    void release() {
+#ifdef PGVECTOR_HAS_MMAP
+        if (mapped_) {
+            munmap(const_cast<unsigned char*>(data_), size_);
+            mapped_ = false;
+        }
+#endif
+    }
+
+    void read(const std::string& path) {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        if (!file.is_open()) {
+            throw std::runtime_error{"could not open " + path};
+        }
+        size_ = static_cast<size_t>(file.tellg());
+        file.seekg(0);
+        buffer_ = std::make_unique<unsigned char[]>(size_);
+        auto size = static_cast<std::streamsize>(size_);
+        if (!file.read(reinterpret_cast<char*>(buffer_.get()), size)) {
+            throw std::runtime_error{"could not read " + path};
+        }
+        data_ = buffer_.get();
+
+        // convert values to native byte order
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            if (size_ >= 4) {
+                size_t record = 4 + static_cast<size_t>(header(data_)) * sizeof(T);
+                for (size_t offset = 0; record > 4 && offset + record <= size_; offset += record) {
+                    for (size_t j = offset + 4; j < offset + record; j += sizeof(T)) {
+                        std::swap(buffer_[j], buffer_[j + 3]);
+                        std::swap(buffer_[j + 1], buffer_[j + 2]);
+                    }
+                }
+            }
+        }
+    }
+
+    void swap(VecsFile& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(mapped_, other.mapped_);
+        std::swap(buffer_, other.buffer_);
+        std::swap(dimensions_, other.dimensions_);
+        std::swap(record_, other.record_);
+        std::swap(rows_, other.rows_);
+    }
+
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::unique_ptr<unsigned char[]> buffer_;
+    size_t dimensions_ = 0;
+    size_t record_ = 0;
+    size_t rows_ = 0;
+};
+
+/// A read-only fvecs file.
+using FvecsFile = VecsFile<float>;
+
+/// A read-only bvecs file.
+using BvecsFile = VecsFile<uint8_t>;
+
+/// A read-only ivecs file.
+using IvecsFile = VecsFile<int32_t>;
+} // namespace pgvector
+
+#undef PGVECTOR_HAS_MMAP
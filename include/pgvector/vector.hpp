@@ -16,6 +16,9 @@ namespace pgvector {
 /// A vector.
 class Vector {
   public:
+    /// The element type.
+    using value_type = float;
+
     /// Creates a vector from a `std::vector`.
     explicit Vector(const std::vector<float>& value) : value_{value} {}
 
@@ -58,4 +61,30 @@ class Vector {
   private:
     std::vector<float> value_;
 };
+
+/// A view of vector values owned elsewhere, like a record in a memory-mapped file.
+class VectorView {
+  public:
+    /// The element type.
+    using value_type = float;
+
+    /// Creates a view of a span.
+    explicit VectorView(std::span<const float> value) : value_{value} {}
+
+    /// Creates a view of a vector.
+    explicit VectorView(const Vector& value) : value_{value.values()} {}
+
+    /// Returns the number of dimensions.
+    size_t dimensions() const {
+        return value_.size();
+    }
+
+    /// Returns the values.
+    std::span<const float> values() const {
+        return value_;
+    }
+
+  private:
+    std::span<const float> value_;
+};
 } // namespace pgvector
@@ -0,0 +1,45 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+
+#include "helper.hpp"
+
+using pgvector::VectorBatch;
+
+namespace {
+void test_push_back() {
+    VectorBatch<float> batch{3};
+    assert_equal(batch.empty(), true);
+    batch.push_back(std::vector<float>{1, 2, 3});
+    batch.push_back(std::vector<float>{4, 5, 6});
+    assert_equal(batch.rows(), 2u);
+    assert_equal(batch.dimensions(), 3u);
+    assert_equal(batch[1][0], 4.0f);
+    assert_equal(batch.row(0)[2], 3.0f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { batch.push_back(std::vector<float>{1, 2}); }, "expected 3 dimensions, not 2"
+    );
+}
+
+void test_zeros() {
+    VectorBatch<float> batch{4, 2};
+    assert_equal(batch.rows(), 2u);
+    assert_equal(batch[1][3], 0.0f);
+    batch[1][3] = 5;
+    assert_equal(batch.data()[7], 5.0f);
+}
+
+void test_aligned() {
+    VectorBatch<float> batch{3, 5};
+    assert_equal(reinterpret_cast<uintptr_t>(batch.data()) % 64, 0u);
+}
+} // namespace
+
+void test_batch() {
+    test_push_back();
+    test_zeros();
+    test_aligned();
+}
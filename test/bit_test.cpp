@@ -0,0 +1,34 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pgvector/bit.hpp>
+
+#include "helper.hpp"
+
+namespace {
+void test_pack_bits() {
+    assert_equal(pgvector::pack_bits("101") == std::vector<uint8_t>{0b10100000}, true);
+    assert_equal(pgvector::pack_bits("111111111") == std::vector<uint8_t>{0xff, 0x80}, true);
+    assert_equal(pgvector::pack_bits("").empty(), true);
+
+    assert_exception<std::invalid_argument>(
+        [] { pgvector::pack_bits("102"); }, "invalid bit string"
+    );
+}
+
+void test_unpack_bits() {
+    assert_equal(pgvector::unpack_bits(std::vector<uint8_t>{0b10100000}, 3), "101");
+    assert_equal(pgvector::unpack_bits(pgvector::pack_bits("110010011"), 9), "110010011");
+
+    assert_exception<std::invalid_argument>(
+        [] { pgvector::unpack_bits(std::vector<uint8_t>{0}, 9); }, "not enough bytes for dimensions"
+    );
+}
+} // namespace
+
+void test_bit() {
+    test_pack_bits();
+    test_unpack_bits();
+}
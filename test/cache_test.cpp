@@ -0,0 +1,149 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <pgvector/cache.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::CacheOptions;
+using pgvector::Metric;
+using pgvector::Neighbor;
+using pgvector::QueryCache;
+using pgvector::QueryKey;
+
+namespace {
+void test_get_put() {
+    QueryCache cache;
+    pgvector::Vector query{{1, 2, 3}};
+    QueryKey key{.metric = Metric::L2, .k = 2};
+
+    assert_equal(cache.get(query, key).has_value(), false);
+    cache.put(query, key, {{1, 0.5}, {2, 1}});
+    auto result = cache.get(query, key);
+    assert_equal(result.has_value(), true);
+    assert_equal(result->size(), 2u);
+    assert_equal((*result)[1], Neighbor{2, 1});
+    assert_equal(cache.size(), 1u);
+
+    auto stats = cache.stats();
+    assert_equal(stats.hits, 1u);
+    assert_equal(stats.misses, 1u);
+    assert_equal(stats.hit_ratio(), 0.5);
+}
+
+void test_key() {
+    QueryCache cache;
+    pgvector::Vector query{{1, 2, 3}};
+    cache.put(query, QueryKey{.k = 2, .filter = "a = 1"}, {{1, 0.5}});
+
+    auto hit = [&](const QueryKey& key) {
+        return cache.get(query, key).has_value();
+    };
+    assert_equal(hit(QueryKey{.k = 2, .filter = "a = 1"}), true);
+    assert_equal(hit(QueryKey{.k = 3, .filter = "a = 1"}), false);
+    assert_equal(hit(QueryKey{.k = 2, .filter = "a = 2"}), false);
+    assert_equal(hit(QueryKey{.k = 2, .filter = "a = 1", .profile = "ef=100"}), false);
+    assert_equal(hit(QueryKey{.metric = Metric::Cosine, .k = 2, .filter = "a = 1"}), false);
+    assert_equal(cache.get(pgvector::Vector{{1, 2, 4}}, QueryKey{.k = 2}).has_value(), false);
+}
+
+void test_types() {
+    QueryCache cache;
+    QueryKey key;
+    cache.put(pgvector::HalfVector{{1, 2, 3}}, key, {{1, 0}});
+    cache.put(pgvector::SparseVector{{{0, 1}, {2, 3}}, 3}, key, {{2, 0}});
+    cache.put(std::string{"101"}, key, {{3, 0}});
+
+    assert_equal(cache.get(pgvector::HalfVector{{1, 2, 3}}, key)->front().id, 1);
+    assert_equal(cache.get(pgvector::SparseVector{{{0, 1}, {2, 3}}, 3}, key)->front().id, 2);
+    assert_equal(cache.get(pgvector::SparseVector{{{0, 1}, {2, 3}}, 4}, key).has_value(), false);
+    assert_equal(cache.get(std::string{"101"}, key)->front().id, 3);
+    assert_equal(cache.get(pgvector::Vector{{1, 2, 3}}, key).has_value(), false);
+}
+
+void test_search() {
+    QueryCache cache;
+    pgvector::Vector query{{1, 2, 3}};
+    int calls = 0;
+    auto search = [&] {
+        calls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        return std::vector<Neighbor>{{1, 0}};
+    };
+
+    cache.search(query, QueryKey{}, search);
+    auto result = cache.search(query, QueryKey{}, search);
+    assert_equal(calls, 1);
+    assert_equal(result.front(), Neighbor{1, 0});
+    assert_equal(cache.stats().saved >= std::chrono::milliseconds{1}, true);
+}
+
+void test_evict() {
+    QueryCache cache{CacheOptions{.max_bytes = 1000, .shards = 1}};
+    for (int i = 0; i < 100; i++) {
+        float x = static_cast<float>(i);
+        cache.put(pgvector::Vector{{x}}, QueryKey{}, {{i, 0}});
+    }
+    assert_equal(cache.bytes() <= 1000, true);
+    assert_equal(cache.size() < 100, true);
+    assert_equal(cache.stats().evictions, 100 - cache.size());
+
+    // least recently used first
+    assert_equal(cache.get(pgvector::Vector{{99}}, QueryKey{}).has_value(), true);
+    assert_equal(cache.get(pgvector::Vector{{0}}, QueryKey{}).has_value(), false);
+
+    // too large to cache
+    pgvector::Vector large{std::vector<float>(1000)};
+    cache.put(large, QueryKey{}, {});
+    assert_equal(cache.get(large, QueryKey{}).has_value(), false);
+}
+
+void test_ttl() {
+    QueryCache cache{CacheOptions{.ttl = std::chrono::milliseconds{5}}};
+    pgvector::Vector query{{1, 2, 3}};
+    cache.put(query, QueryKey{}, {{1, 0}});
+    assert_equal(cache.get(query, QueryKey{}).has_value(), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    assert_equal(cache.get(query, QueryKey{}).has_value(), false);
+    assert_equal(cache.size(), 0u);
+}
+
+void test_threads() {
+    QueryCache cache{CacheOptions{.max_bytes = 100000}};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache] {
+            for (int i = 0; i < 1000; i++) {
+                pgvector::Vector query{{static_cast<float>(i % 50)}};
+                cache.search(query, QueryKey{}, [i] {
+                    return std::vector<Neighbor>{{i % 50, 0}};
+                });
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto stats = cache.stats();
+    assert_equal(stats.hits + stats.misses, 4000u);
+    assert_equal(cache.get(pgvector::Vector{{7}}, QueryKey{})->front().id, 7);
+}
+} // namespace
+
+void test_cache() {
+    test_get_put();
+    test_key();
+    test_types();
+    test_search();
+    test_evict();
+    test_ttl();
+    test_threads();
+}
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <pgvector/compact.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/sparsevec.hpp>
+
+#include "helper.hpp"
+
+using pgvector::CompactSparseVector;
+using pgvector::CompactValues;
+using pgvector::SparseVector;
+
+namespace {
+SparseVector random_sparse(int dimensions, size_t nnz, uint64_t seed) {
+    std::mt19937_64 prng{seed};
+    std::uniform_int_distribution<int> index{0, dimensions - 1};
+    std::uniform_real_distribution<float> value{-1, 1};
+    std::vector<float> dense(static_cast<size_t>(dimensions));
+    for (size_t i = 0; i < nnz; i++) {
+        dense[static_cast<size_t>(index(prng))] = value(prng);
+    }
+    return SparseVector{dense};
+}
+
+void test_roundtrip() {
+    std::vector<int> indices{0, 5, 127, 128, 30000};
+    SparseVector vec{std::move(indices), std::vector<float>{1, -2, 3, 4, 5}, 30522};
+    CompactSparseVector compact{vec};
+    assert_equal(compact.dimensions(), 30522);
+    assert_equal(compact.nnz(), 5u);
+    assert_equal(compact.format() == CompactValues::Float32, true);
+    assert_equal(compact.decode(), vec);
+
+    // 5 header bytes, 20 value bytes, and 1 + 1 + 1 + 1 + 3 index bytes
+    assert_equal(compact.bytes().size(), 32u);
+}
+
+void test_float16() {
+    SparseVector vec{std::vector<int>{1, 2, 3}, std::vector<float>{1, -0.5f, 0.1f}, 4};
+    CompactSparseVector compact{vec, CompactValues::Float16};
+    assert_equal(compact.format() == CompactValues::Float16, true);
+    SparseVector decoded = compact.decode();
+    assert_equal(decoded.indices() == vec.indices(), true);
+    assert_equal(decoded.values()[0], 1.0f);
+    assert_equal(decoded.values()[1], -0.5f);
+    assert_equal(decoded.values()[2], 0.0999755859375f);
+}
+
+void test_empty() {
+    SparseVector vec{std::vector<float>{0, 0, 0}};
+    CompactSparseVector compact{vec};
+    assert_equal(compact.nnz(), 0u);
+    assert_equal(compact.decode(), vec);
+    assert_equal(pgvector::inner_product(compact, vec), 0.0f);
+}
+
+void test_inner_product() {
+    for (uint64_t seed = 0; seed < 10; seed++) {
+        SparseVector a = random_sparse(1000, 100, seed);
+        SparseVector b = random_sparse(1000, 200, seed + 100);
+        CompactSparseVector compact{a};
+        float expected = pgvector::inner_product(a, b);
+        assert_equal(pgvector::inner_product(compact, b), expected);
+
+        std::vector<float> dense(1000);
+        for (size_t i = 0; i < b.indices().size(); i++) {
+            dense[static_cast<size_t>(b.indices()[i])] = b.values()[i];
+        }
+        assert_equal(pgvector::inner_product(compact, std::span<const float>{dense}), expected);
+    }
+
+    assert_exception<std::invalid_argument>(
+        [] {
+            CompactSparseVector compact{SparseVector{std::vector<float>{1, 2}}};
+            pgvector::inner_product(compact, SparseVector{std::vector<float>{1, 2, 3}});
+        },
+        "different vector dimensions"
+    );
+}
+
+void test_bytes() {
+    CompactSparseVector compact{random_sparse(30522, 200, 1)};
+    std::vector<uint8_t> bytes(compact.bytes().begin(), compact.bytes().end());
+    CompactSparseVector copy{std::span<const uint8_t>{bytes}};
+    assert_equal(copy == compact, true);
+
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    assert_exception<std::invalid_argument>(
+        [&] { CompactSparseVector{std::span<const uint8_t>{truncated}}; },
+        "invalid compact sparse vector"
+    );
+
+    std::vector<uint8_t> extra = bytes;
+    extra.push_back(0);
+    assert_exception<std::invalid_argument>(
+        [&] { CompactSparseVector{std::span<const uint8_t>{extra}}; },
+        "invalid compact sparse vector"
+    );
+
+    // index out of bounds
+    std::vector<uint8_t> invalid{2, 1, 0, 0, 0, 128, 63, 2};
+    assert_exception<std::invalid_argument>(
+        [&] { CompactSparseVector{std::span<const uint8_t>{invalid}}; },
+        "invalid compact sparse vector"
+    );
+}
+} // namespace
+
+void test_compact() {
+    test_roundtrip();
+    test_float16();
+    test_empty();
+    test_inner_product();
+    test_bytes();
+}
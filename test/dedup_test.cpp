@@ -0,0 +1,94 @@
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pgvector/dedup.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::DedupMode;
+using pgvector::DedupOptions;
+using pgvector::Deduplicator;
+
+namespace {
+void test_hash_set() {
+    Deduplicator<pgvector::Vector> dedup;
+    assert_equal(dedup.insert(pgvector::Vector{{1, 2, 3}}), true);
+    assert_equal(dedup.insert(pgvector::Vector{{1, 2, 3}}), false);
+    assert_equal(dedup.insert(pgvector::Vector{{4, 5, 6}}), true);
+    assert_equal(dedup.unique(), 2u);
+    assert_equal(dedup.duplicates(), 1u);
+
+    dedup.clear();
+    assert_equal(dedup.insert(pgvector::Vector{{1, 2, 3}}), true);
+}
+
+void test_capacity() {
+    Deduplicator<pgvector::Vector> dedup{DedupOptions{.capacity = 2}};
+    assert_equal(dedup.insert(pgvector::Vector{{1}}), true);
+    assert_equal(dedup.insert(pgvector::Vector{{2}}), true);
+    assert_equal(dedup.insert(pgvector::Vector{{3}}), true);
+
+    // oldest forgotten
+    assert_equal(dedup.insert(pgvector::Vector{{3}}), false);
+    assert_equal(dedup.insert(pgvector::Vector{{2}}), false);
+    assert_equal(dedup.insert(pgvector::Vector{{1}}), true);
+}
+
+void test_bloom_filter() {
+    Deduplicator<pgvector::Vector> dedup{
+        DedupOptions{.mode = DedupMode::BloomFilter, .capacity = 1000}
+    };
+    size_t unique = 0;
+    for (int i = 0; i < 1000; i++) {
+        unique += dedup.insert(pgvector::Vector{{static_cast<float>(i)}});
+    }
+    // allow a few false positives
+    assert_equal(unique >= 990, true);
+    for (int i = 0; i < 1000; i++) {
+        assert_equal(dedup.insert(pgvector::Vector{{static_cast<float>(i)}}), false);
+    }
+}
+
+void test_types() {
+    Deduplicator<pgvector::HalfVector> half;
+    assert_equal(half.insert(pgvector::HalfVector{{1, 2}}), true);
+    assert_equal(half.insert(pgvector::HalfVector{{1, 2}}), false);
+
+    Deduplicator<pgvector::SparseVector> sparse;
+    assert_equal(sparse.insert(pgvector::SparseVector{{{0, 1}}, 3}), true);
+    assert_equal(sparse.insert(pgvector::SparseVector{std::vector<float>{1, 0, 0}}), false);
+
+    Deduplicator<std::string> bits;
+    assert_equal(bits.insert("101"), true);
+    assert_equal(bits.insert("101"), false);
+    assert_equal(bits.insert("100"), true);
+}
+
+void test_options() {
+    assert_exception<std::invalid_argument>(
+        [] { Deduplicator<pgvector::Vector>{DedupOptions{.capacity = 0}}; },
+        "capacity must be greater than 0"
+    );
+    assert_exception<std::invalid_argument>(
+        [] {
+            Deduplicator<pgvector::Vector>{
+                DedupOptions{.mode = DedupMode::BloomFilter, .false_positive_rate = 0}
+            };
+        },
+        "false_positive_rate must be between 0 and 1"
+    );
+}
+} // namespace
+
+void test_dedup() {
+    test_hash_set();
+    test_capacity();
+    test_bloom_filter();
+    test_types();
+    test_options();
+}
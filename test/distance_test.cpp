@@ -0,0 +1,118 @@
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/distance.hpp>
+#include <pgvector/bit.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::Metric;
+
+namespace {
+void test_l2_distance() {
+    std::vector<float> a{1, 2, 3};
+    std::vector<float> b{4, 6, 3};
+    assert_equal(pgvector::l2_distance(a, b), 5.0f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::l2_distance(a, std::vector<float>{1, 2}); },
+        "different vector dimensions"
+    );
+}
+
+void test_inner_product() {
+    std::vector<float> a{1, 2, 3};
+    std::vector<float> b{4, 5, 6};
+    assert_equal(pgvector::inner_product(a, b), 32.0f);
+}
+
+void test_cosine_distance() {
+    std::vector<float> a{1, 1};
+    std::vector<float> b{-1, -1};
+    assert_equal(pgvector::cosine_distance(a, a), 0.0f);
+    assert_equal(pgvector::cosine_distance(a, b), 2.0f);
+    assert_equal(std::isnan(pgvector::cosine_distance(a, std::vector<float>{0, 0})), true);
+}
+
+void test_l1_distance() {
+    std::vector<float> a{1, 2, 3};
+    std::vector<float> b{0, 4, 3};
+    assert_equal(pgvector::l1_distance(a, b), 3.0f);
+}
+
+void test_long() {
+    // cover both the SIMD and remainder loops
+    std::vector<float> a(37);
+    std::vector<float> b(37);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = static_cast<float>(i);
+        b[i] = static_cast<float>(i) + 1;
+    }
+    assert_equal(pgvector::l2_distance(a, b), std::sqrt(37.0f));
+    assert_equal(pgvector::l1_distance(a, b), 37.0f);
+    assert_equal(pgvector::inner_product(a, b), 16872.0f);
+}
+
+void test_distance_vector() {
+    pgvector::Vector a{{1, 2, 3}};
+    pgvector::Vector b{{4, 5, 6}};
+    assert_equal(pgvector::distance(Metric::L2, a, b), std::sqrt(27.0f));
+    assert_equal(pgvector::distance(Metric::InnerProduct, a, b), -32.0f);
+    assert_equal(pgvector::distance(Metric::L1, a, b), 9.0f);
+}
+
+void test_distance_halfvec() {
+    pgvector::HalfVector a{std::vector<pgvector::Half>(20, 1)};
+    pgvector::HalfVector b{std::vector<pgvector::Half>(20, 2)};
+    assert_equal(pgvector::distance(Metric::L2, a, b), std::sqrt(20.0f));
+    assert_equal(pgvector::distance(Metric::InnerProduct, a, b), -40.0f);
+    assert_equal(pgvector::distance(Metric::Cosine, a, b), 0.0f);
+    assert_equal(pgvector::distance(Metric::L1, a, b), 20.0f);
+}
+
+void test_distance_sparsevec() {
+    pgvector::SparseVector a{{1, 0, 2, 0}};
+    pgvector::SparseVector b{{0, 3, 2, 1}};
+    assert_equal(pgvector::distance(Metric::L2, a, b), std::sqrt(11.0f));
+    assert_equal(pgvector::distance(Metric::InnerProduct, a, b), -4.0f);
+    assert_equal(pgvector::distance(Metric::L1, a, b), 5.0f);
+    assert_equal(pgvector::distance(Metric::Cosine, a, a), 0.0f);
+    assert_equal(pgvector::inner_product(a, b), 4.0f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::distance(Metric::L2, a, pgvector::SparseVector{{1, 2}}); },
+        "different sparsevec dimensions"
+    );
+}
+
+void test_distance_bit() {
+    auto a = pgvector::pack_bits("1010111100");
+    auto b = pgvector::pack_bits("1110001101");
+    assert_equal(pgvector::hamming_distance(a, b), 4.0f);
+    assert_equal(pgvector::jaccard_distance(a, b), 0.5f);
+    assert_equal(pgvector::distance(Metric::Hamming, a, b), 4.0f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::distance(Metric::L2, a, b); },
+        "bit vectors require hamming or jaccard distance"
+    );
+}
+} // namespace
+
+void test_distance() {
+    test_l2_distance();
+    test_inner_product();
+    test_cosine_distance();
+    test_l1_distance();
+    test_long();
+    test_distance_vector();
+    test_distance_halfvec();
+    test_distance_sparsevec();
+    test_distance_bit();
+}
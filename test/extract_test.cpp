@@ -0,0 +1,109 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <pgvector/extract.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+#include "helper.hpp"
+
+using pgvector::ExtractedVectors;
+using pgvector::Half;
+using pgvector::VectorBatch;
+
+namespace {
+const std::string conninfo = "dbname=pgvector_cpp_test";
+
+void setup() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
+    tx.exec("DROP TABLE IF EXISTS extract_items");
+    tx.exec(
+        "CREATE TABLE extract_items (id bigint PRIMARY KEY, embedding vector, "
+        "half_embedding halfvec)"
+    );
+    tx.exec(
+        "INSERT INTO extract_items SELECT i, ARRAY[i, i + 0.5, -i], ARRAY[i, 1.5, -i] "
+        "FROM generate_series(1, 1000) i"
+    );
+}
+
+void test_vector() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    pqxx::result result = tx.exec("SELECT id, embedding FROM extract_items ORDER BY id");
+
+    for (size_t threads : {1, 4}) {
+        VectorBatch<float> batch = pgvector::extract_vectors(result, 1, {.threads = threads});
+        assert_equal(batch.dimensions(), 3u);
+        assert_equal(batch.rows(), 1000u);
+        for (size_t i = 0; i < batch.rows(); i++) {
+            auto expected = result[static_cast<int>(i)][1].as<pgvector::Vector>();
+            assert_equal(pgvector::Vector{batch[i]}, expected);
+        }
+    }
+
+    // braced options are not mistaken for a column
+    assert_equal(pgvector::extract_vectors(result, 1, {4}).rows(), 1000u);
+}
+
+void test_ids() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    pqxx::result result = tx.exec("SELECT embedding, id FROM extract_items ORDER BY id DESC");
+
+    ExtractedVectors<float> extracted = pgvector::extract_vectors_with_ids(result, 1, 0);
+    assert_equal(extracted.ids.size(), 1000u);
+    assert_equal(extracted.ids[0], int64_t{1000});
+    assert_equal(extracted.ids[999], int64_t{1});
+    assert_equal(pgvector::Vector{extracted.vectors[999]}, pgvector::Vector{{1, 1.5f, -1}});
+}
+
+void test_halfvec() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    pqxx::result result = tx.exec("SELECT half_embedding FROM extract_items ORDER BY id LIMIT 2");
+
+    VectorBatch<Half> batch = pgvector::extract_vectors<pgvector::HalfVector>(result, 0);
+    assert_equal(batch.rows(), 2u);
+    assert_equal(pgvector::HalfVector{batch[1]}, pgvector::HalfVector{{2, 1.5f, -2}});
+}
+
+void test_empty() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    pqxx::result result = tx.exec("SELECT id, embedding FROM extract_items WHERE id < 0");
+
+    assert_equal(pgvector::extract_vectors(result, 1).rows(), 0u);
+    assert_equal(pgvector::extract_vectors_with_ids(result, 0, 1).ids.size(), 0u);
+}
+
+void test_invalid() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+
+    pqxx::result result = tx.exec("SELECT '[1,2]'::vector UNION ALL SELECT '[1,2,3]'::vector");
+    assert_exception<pqxx::conversion_error>(
+        [&] { pgvector::extract_vectors(result, 0); }, "Expected 2 dimensions, not 3"
+    );
+
+    result = tx.exec("SELECT '[1,2]'::vector UNION ALL SELECT NULL::vector");
+    assert_exception<pqxx::conversion_error>(
+        [&] { pgvector::extract_vectors(result, 0); }, "Unexpected null vector"
+    );
+}
+} // namespace
+
+void test_extract() {
+    setup();
+    test_vector();
+    test_ids();
+    test_halfvec();
+    test_empty();
+    test_invalid();
+}
@@ -0,0 +1,123 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <pgvector/distance.hpp>
+#include <pgvector/fixed.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::FixedBitVector;
+using pgvector::FixedHalfVector;
+using pgvector::FixedVector;
+using pgvector::Metric;
+
+namespace {
+void test_constructor_array() {
+    FixedVector<3> vec{{1, 2, 3}};
+    assert_equal(vec.dimensions(), 3u);
+    assert_equal(vec.values()[2], 3.0f);
+}
+
+void test_constructor_span() {
+    std::vector<float> values{1, 2, 3};
+    FixedVector<3> vec{std::span<const float>{values}};
+    assert_equal(vec, FixedVector<3>{{1, 2, 3}});
+
+    assert_exception<std::invalid_argument>(
+        [&] { FixedVector<4>{std::span<const float>{values}}; }, "expected 4 dimensions, not 3"
+    );
+}
+
+void test_constructor_default() {
+    assert_equal(FixedVector<3>{}, FixedVector<3>{{0, 0, 0}});
+    assert_equal(FixedBitVector<3>{}, FixedBitVector<3>{"000"});
+}
+
+void test_layout() {
+    static_assert(std::is_trivially_copyable_v<FixedVector<128>>);
+    static_assert(std::is_trivially_copyable_v<FixedHalfVector<128>>);
+    static_assert(std::is_trivially_copyable_v<FixedBitVector<128>>);
+    static_assert(sizeof(FixedVector<3>) == 12);
+    static_assert(sizeof(FixedVector<128>) == 512);
+    static_assert(alignof(FixedVector<128>) == 32);
+    static_assert(sizeof(FixedHalfVector<128>) == 256);
+    static_assert(sizeof(FixedBitVector<10>) == 2);
+
+    std::vector<FixedVector<128>> vectors(3);
+    auto* first = reinterpret_cast<const char*>(&vectors[0]);
+    assert_equal(reinterpret_cast<const char*>(&vectors[2]) - first, 1024);
+}
+
+template<size_t N, size_t M>
+concept has_distance = requires(const FixedVector<N>& a, const FixedVector<M>& b) {
+    pgvector::distance(Metric::L2, a, b);
+};
+
+void test_distance() {
+    FixedVector<20> a;
+    FixedVector<20> b;
+    std::array<float, 20> x;
+    std::array<float, 20> y;
+    for (size_t i = 0; i < 20; i++) {
+        x[i] = static_cast<float>(i);
+        y[i] = static_cast<float>(20 - i) * 0.5f;
+    }
+    a = FixedVector<20>{x};
+    b = FixedVector<20>{y};
+    pgvector::Vector va{std::span<const float>{x}};
+    pgvector::Vector vb{std::span<const float>{y}};
+    for (auto metric : {Metric::L2, Metric::InnerProduct, Metric::Cosine, Metric::L1}) {
+        assert_equal(pgvector::distance(metric, a, b), pgvector::distance(metric, va, vb));
+    }
+
+    FixedHalfVector<3> h{{1, 2, 3}};
+    FixedHalfVector<3> h2{{4, 5, 6}};
+    assert_equal(pgvector::distance(Metric::InnerProduct, h, h2), -32.0f);
+
+    // dimensions are checked at compile time
+    static_assert(has_distance<3, 3>);
+    static_assert(!has_distance<3, 4>);
+}
+
+void test_bit() {
+    FixedBitVector<10> a{"1010000001"};
+    FixedBitVector<10> b{"1110000000"};
+    assert_equal(a.values() == std::array<uint8_t, 2>{0xA0, 0x40}, true);
+    assert_equal(a.test(0), true);
+    assert_equal(a.test(1), false);
+    assert_equal(pgvector::distance(Metric::Hamming, a, b), 2.0f);
+    assert_equal(pgvector::distance(Metric::Jaccard, a, b), 0.5f);
+
+    assert_exception<std::invalid_argument>(
+        [] { FixedBitVector<3>{"10"}; }, "expected 3 dimensions, not 2"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { FixedBitVector<3>{"102"}; }, "invalid bit string"
+    );
+}
+
+void test_string() {
+    std::ostringstream oss;
+    oss << FixedVector<3>{{1, 2, 3}} << " " << FixedHalfVector<2>{{1.5f, 2}} << " "
+        << FixedBitVector<3>{"101"};
+    assert_equal(oss.str(), "[1,2,3] [1.5,2] 101");
+}
+} // namespace
+
+void test_fixed() {
+    test_constructor_array();
+    test_constructor_span();
+    test_constructor_default();
+    test_layout();
+    test_distance();
+    test_bit();
+    test_string();
+}
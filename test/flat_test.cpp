@@ -0,0 +1,160 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/flat.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::FlatIndex;
+using pgvector::Metric;
+using pgvector::Neighbor;
+
+namespace {
+void test_search() {
+    FlatIndex<pgvector::Vector> index{3};
+    index.add(1, pgvector::Vector{{1, 1, 1}});
+    index.add(2, pgvector::Vector{{2, 2, 2}});
+    index.add(3, pgvector::Vector{{1, 1, 2}});
+    assert_equal(index.size(), 3u);
+
+    auto result = index.search(pgvector::Vector{{1, 1, 1}}, 2);
+    assert_equal(result.size(), 2u);
+    assert_equal(result[0], Neighbor{1, 0});
+    assert_equal(result[1], Neighbor{3, 1});
+
+    assert_equal(index.search(pgvector::Vector{{1, 1, 1}}, 0).empty(), true);
+    std::vector<pgvector::Vector> queries{pgvector::Vector{{1, 1, 1}}, pgvector::Vector{{2, 2, 2}}};
+    auto results = index.search(queries, 0);
+    assert_equal(results.size(), 2u);
+    assert_equal(results[1].empty(), true);
+}
+
+void test_metrics() {
+    std::vector<pgvector::Vector> vectors{
+        pgvector::Vector{{1, 0}}, pgvector::Vector{{5, 5}}, pgvector::Vector{{-1, 2}}
+    };
+    pgvector::Vector query{{3, 3}};
+    for (auto metric : {Metric::L2, Metric::InnerProduct, Metric::Cosine, Metric::L1}) {
+        FlatIndex<pgvector::Vector> index{2, {.metric = metric}};
+        for (size_t i = 0; i < vectors.size(); i++) {
+            index.add(static_cast<int64_t>(i), vectors[i]);
+        }
+        auto result = index.search(query, 3);
+        assert_equal(result.size(), 3u);
+        for (const auto& v : result) {
+            float expected = pgvector::distance(metric, query, vectors[static_cast<size_t>(v.id)]);
+            assert_equal(std::fabs(v.distance - expected) < 1e-6f, true);
+        }
+    }
+}
+
+void test_halfvec() {
+    FlatIndex<pgvector::HalfVector> index{3};
+    index.add(1, pgvector::HalfVector{{1, 1, 1}});
+    index.add(2, pgvector::HalfVector{{2, 2, 2}});
+    assert_equal(index.search(pgvector::HalfVector{{2, 2, 2}}, 1)[0], Neighbor{2, 0});
+}
+
+void test_sparsevec() {
+    FlatIndex<pgvector::SparseVector> index{4, {.metric = Metric::InnerProduct}};
+    index.add(1, pgvector::SparseVector{{1, 0, 2, 0}});
+    index.add(2, pgvector::SparseVector{{0, 3, 0, 1}});
+    index.add(3, pgvector::SparseVector{{0, 0, 0, 0}});
+    auto result = index.search(pgvector::SparseVector{{1, 1, 1, 1}}, 3);
+    assert_equal(result[0], Neighbor{2, -4});
+    assert_equal(result[1], Neighbor{1, -3});
+    assert_equal(result[2], Neighbor{3, 0});
+
+    FlatIndex<pgvector::SparseVector> index2{4};
+    index2.add(1, pgvector::SparseVector{{1, 0, 2, 0}});
+    index2.add(2, pgvector::SparseVector{{0, 3, 0, 1}});
+    assert_equal(index2.search(pgvector::SparseVector{{0, 3, 0, 0}}, 1)[0], Neighbor{2, 1});
+
+    assert_exception<std::invalid_argument>(
+        [&] { index2.add(3, pgvector::SparseVector{{1, 2}}); }, "expected 4 dimensions, not 2"
+    );
+}
+
+void test_bit() {
+    FlatIndex<std::string> index{3, {.metric = Metric::Hamming}};
+    index.add(1, "101");
+    index.add(2, "111");
+    index.add(3, "000");
+    auto result = index.search("111", 3);
+    assert_equal(result[0], Neighbor{2, 0});
+    assert_equal(result[1], Neighbor{1, 1});
+    assert_equal(result[2], Neighbor{3, 3});
+
+    FlatIndex<std::string> index2{3, {.metric = Metric::Jaccard}};
+    index2.add(1, "100");
+    index2.add(2, "110");
+    assert_equal(index2.search("111", 1)[0].id, 2);
+
+    assert_exception<std::invalid_argument>(
+        [] { FlatIndex<std::string>(3, {.metric = Metric::L2}); },
+        "bit vectors require hamming or jaccard distance"
+    );
+}
+
+void test_threads() {
+    // compare a single thread with queries and vectors split across threads
+    std::mt19937_64 prng;
+    std::uniform_real_distribution<float> dist{0, 1};
+    size_t dimensions = 10;
+    pgvector::VectorBatch<float> vectors{dimensions, 1000};
+    pgvector::VectorBatch<float> queries{dimensions, 3};
+    for (size_t i = 0; i < vectors.rows() * dimensions; i++) {
+        vectors.data()[i] = dist(prng);
+    }
+    for (size_t i = 0; i < queries.rows() * dimensions; i++) {
+        queries.data()[i] = dist(prng);
+    }
+    std::vector<int64_t> ids;
+    for (size_t i = 0; i < vectors.rows(); i++) {
+        ids.push_back(static_cast<int64_t>(i));
+    }
+
+    FlatIndex<pgvector::Vector> index{dimensions, {.threads = 1}};
+    index.add(ids, vectors);
+    FlatIndex<pgvector::Vector> index2{dimensions, {.threads = 8}};
+    index2.add(ids, vectors);
+
+    auto result = index.search(queries, 10);
+    auto result2 = index2.search(queries, 10);
+    assert_equal(result.size(), 3u);
+    assert_equal(result == result2, true);
+    assert_equal(result[0].size(), 10u);
+}
+
+void test_errors() {
+    assert_exception<std::invalid_argument>(
+        [] { FlatIndex<pgvector::Vector>(3, {.metric = Metric::Hamming}); },
+        "hamming and jaccard distance require bit vectors"
+    );
+
+    FlatIndex<pgvector::Vector> index{3};
+    assert_exception<std::invalid_argument>(
+        [&] { index.add(1, pgvector::Vector{{1, 1}}); }, "expected 3 dimensions, not 2"
+    );
+}
+} // namespace
+
+void test_flat() {
+    test_search();
+    test_metrics();
+    test_halfvec();
+    test_sparsevec();
+    test_bit();
+    test_threads();
+    test_errors();
+}
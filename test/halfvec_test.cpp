@@ -1,3 +1,7 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <span>
 #include <sstream>
 #include <vector>
@@ -34,6 +38,38 @@ void test_values() {
     assert_equal(vec.values() == std::vector<pgvector::Half>{1, 2, 3}, true);
 }
 
+void test_size() {
+    assert_equal(sizeof(pgvector::Half), 2u);
+}
+
+void test_to_half() {
+    std::vector<float> values{1, -2.5f, 0.1f, 65504, 65520, 1e-7f, 1e-8f, -0.0f, 3.14159f, 2049};
+    std::vector<pgvector::Half> halves = pgvector::to_half(values);
+    std::vector<float> result = pgvector::to_float(halves);
+    std::vector<float> expected{
+        1, -2.5f, 0.0999755859375f, 65504, INFINITY, 1.1920928955078125e-7f, 0, -0.0f,
+        3.140625f, 2048
+    };
+    assert_equal(result == expected, true);
+    assert_equal(std::signbit(result[7]), true);
+    assert_equal(std::isnan(pgvector::to_float(pgvector::to_half(std::vector{NAN}))[0]), true);
+}
+
+void test_to_float() {
+    // every half except NaN round trips, including vectorized and remaining elements
+    std::vector<pgvector::Half> halves;
+    for (uint32_t bits = 0; bits < 65536; bits++) {
+        if ((bits & 0x7C00) != 0x7C00 || (bits & 0x3FF) == 0) {
+            halves.push_back(std::bit_cast<pgvector::Half>(static_cast<uint16_t>(bits)));
+        }
+    }
+    halves.pop_back();
+    std::vector<pgvector::Half> result = pgvector::to_half(pgvector::to_float(halves));
+    for (size_t i = 0; i < halves.size(); i++) {
+        assert_equal(std::bit_cast<uint16_t>(result[i]), std::bit_cast<uint16_t>(halves[i]));
+    }
+}
+
 void test_string() {
     HalfVector vec{{1, 2, 3}};
     std::ostringstream oss;
@@ -48,5 +84,8 @@ void test_halfvec() {
     test_constructor_empty();
     test_dimensions();
     test_values();
+    test_size();
+    test_to_half();
+    test_to_float();
     test_string();
 }
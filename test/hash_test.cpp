@@ -0,0 +1,124 @@
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <pgvector/halfvec.hpp>
+#include <pgvector/hash.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::hash128;
+using pgvector::hash64;
+
+namespace {
+void test_bytes() {
+    // XXH64 test vectors
+    assert_equal(pgvector::detail::hash_bytes(""), 0xEF46DB3751D8E999u);
+    assert_equal(pgvector::detail::hash_bytes("a"), 0xD24EC4F1A98C6E5Bu);
+    assert_equal(pgvector::detail::hash_bytes("abc"), 0x44BC2CF5AD770999u);
+}
+
+void test_streaming() {
+    std::string data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(static_cast<char>(i * 7));
+    }
+    for (size_t split : {0, 1, 13, 31, 32, 33, 500}) {
+        pgvector::detail::Xxh64 state{42};
+        state.update(data.data(), split);
+        state.update(data.data() + split, data.size() - split);
+        assert_equal(state.digest(), pgvector::detail::hash_bytes(data, 42));
+    }
+}
+
+void test_vector() {
+    pgvector::Vector a{{1, 2, 3}};
+    assert_equal(hash64(a), hash64(pgvector::Vector{{1, 2, 3}}));
+    assert_equal(hash64(a) != hash64(pgvector::Vector{{1, 2, 4}}), true);
+    assert_equal(hash64(a) != hash64(a, 1), true);
+
+    // stable across platforms
+    float values[] = {1, 2, 3};
+    unsigned char bytes[12];
+    for (size_t i = 0; i < 3; i++) {
+        auto bits = std::bit_cast<uint32_t>(values[i]);
+        for (size_t j = 0; j < 4; j++) {
+            bytes[i * 4 + j] = static_cast<unsigned char>(bits >> (8 * j));
+        }
+    }
+    assert_equal(hash64(a), pgvector::detail::hash_bytes(bytes, sizeof(bytes)));
+
+    // consistent with operator==
+    assert_equal(hash64(pgvector::Vector{{-0.0f}}), hash64(pgvector::Vector{{0.0f}}));
+
+    // longer than a chunk
+    std::vector<float> large(1000, 1);
+    pgvector::Vector b{large};
+    large[999] = 2;
+    assert_equal(hash64(b) != hash64(pgvector::Vector{large}), true);
+}
+
+void test_halfvec() {
+    pgvector::HalfVector a{{1, 2, 3}};
+    assert_equal(hash64(a), hash64(pgvector::HalfVector{{1, 2, 3}}));
+    assert_equal(hash64(a) != hash64(pgvector::HalfVector{{1, 2, 4}}), true);
+}
+
+void test_sparsevec() {
+    pgvector::SparseVector a{{{0, 1}, {2, 3}}, 3};
+    assert_equal(hash64(a), hash64(pgvector::SparseVector{std::vector<float>{1, 0, 3}}));
+    assert_equal(hash64(a) != hash64(pgvector::SparseVector{{{0, 1}, {2, 3}}, 4}), true);
+    assert_equal(hash64(a) != hash64(pgvector::SparseVector{{{0, 1}, {1, 3}}, 3}), true);
+}
+
+void test_bits() {
+    assert_equal(hash64("101"), hash64(std::string{"101"}));
+    assert_equal(hash64("101") != hash64("1010"), true);
+}
+
+void test_hash128() {
+    pgvector::Vector a{{1, 2, 3}};
+    auto h = hash128(a);
+    assert_equal(h == hash128(pgvector::Vector{{1, 2, 3}}), true);
+    assert_equal(h.low, hash64(a));
+    assert_equal(h.low != h.high, true);
+    assert_equal(hash128(a, 1) == h, false);
+    pgvector::HalfVector half{{1, 2, 3}};
+    assert_equal(hash128(half).low, hash64(half));
+    pgvector::SparseVector sparse{{{0, 1}}, 3};
+    assert_equal(hash128(sparse).low, hash64(sparse));
+    assert_equal(hash128("101").low, hash64("101"));
+}
+
+void test_std_hash() {
+    std::unordered_set<pgvector::Vector> vectors;
+    vectors.insert(pgvector::Vector{{1, 2, 3}});
+    vectors.insert(pgvector::Vector{{1, 2, 3}});
+    vectors.insert(pgvector::Vector{{4, 5, 6}});
+    assert_equal(vectors.size(), 2u);
+
+    std::unordered_map<pgvector::SparseVector, int> sparse;
+    sparse[pgvector::SparseVector{{{0, 1}}, 3}] = 1;
+    assert_equal(sparse.at(pgvector::SparseVector{{{0, 1}}, 3}), 1);
+
+    std::unordered_set<pgvector::HalfVector> half;
+    half.insert(pgvector::HalfVector{{1, 2, 3}});
+    assert_equal(half.contains(pgvector::HalfVector{{1, 2, 3}}), true);
+}
+} // namespace
+
+void test_hash() {
+    test_bytes();
+    test_streaming();
+    test_vector();
+    test_halfvec();
+    test_sparsevec();
+    test_bits();
+    test_hash128();
+    test_std_hash();
+}
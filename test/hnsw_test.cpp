@@ -0,0 +1,164 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <pgvector/halfvec.hpp>
+#include <pgvector/hnsw.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::HnswIndex;
+using pgvector::HnswOptions;
+using pgvector::Metric;
+
+namespace {
+std::vector<std::vector<float>> random_vectors(size_t rows, size_t dimensions) {
+    std::mt19937_64 prng;
+    std::uniform_real_distribution<float> dist{0, 1};
+    std::vector<std::vector<float>> vectors(rows, std::vector<float>(dimensions));
+    for (auto& v : vectors) {
+        for (auto& x : v) {
+            x = dist(prng);
+        }
+    }
+    return vectors;
+}
+
+void test_search() {
+    HnswIndex<pgvector::Vector> index{3, 10};
+    index.add(1, pgvector::Vector{{1, 1, 1}});
+    index.add(2, pgvector::Vector{{2, 2, 2}});
+    index.add(3, pgvector::Vector{{1, 1, 2}});
+    assert_equal(index.size(), 3u);
+
+    auto result = index.search(pgvector::Vector{{1, 1, 1}}, 2);
+    assert_equal(result.size(), 2u);
+    assert_equal(result[0], pgvector::Neighbor{1, 0});
+    assert_equal(result[1], pgvector::Neighbor{3, 1});
+}
+
+void test_search_empty() {
+    HnswIndex<pgvector::Vector> index{3, 10};
+    assert_equal(index.search(pgvector::Vector{{1, 1, 1}}, 5).empty(), true);
+}
+
+void test_search_zero() {
+    HnswIndex<pgvector::Vector> index{3, 10};
+    index.add(1, pgvector::Vector{{1, 1, 1}});
+    assert_equal(index.search(pgvector::Vector{{1, 1, 1}}, 0).empty(), true);
+
+    pgvector::TopK top{0};
+    assert_equal(top.push(1, 0), false);
+    assert_equal(top.threshold() < 0, true);
+    assert_equal(top.sorted().empty(), true);
+}
+
+void test_metrics() {
+    HnswIndex<pgvector::Vector> index{2, 10, {.metric = Metric::InnerProduct}};
+    index.add(1, pgvector::Vector{{1, 1}});
+    index.add(2, pgvector::Vector{{2, 2}});
+    auto result = index.search(pgvector::Vector{{1, 1}}, 1);
+    assert_equal(result[0], pgvector::Neighbor{2, -4});
+
+    HnswIndex<pgvector::Vector> index2{2, 10, {.metric = Metric::Cosine}};
+    index2.add(1, pgvector::Vector{{1, 0}});
+    index2.add(2, pgvector::Vector{{5, 5}});
+    auto result2 = index2.search(pgvector::Vector{{3, 3}}, 1);
+    assert_equal(result2[0].id, 2);
+
+    HnswIndex<pgvector::Vector> index3{2, 10, {.metric = Metric::L1}};
+    index3.add(1, pgvector::Vector{{1, 1}});
+    index3.add(2, pgvector::Vector{{3, 3}});
+    auto result3 = index3.search(pgvector::Vector{{3, 2}}, 1);
+    assert_equal(result3[0], pgvector::Neighbor{2, 1});
+}
+
+void test_halfvec() {
+    HnswIndex<pgvector::HalfVector> index{3, 10};
+    index.add(1, pgvector::HalfVector{{1, 1, 1}});
+    index.add(2, pgvector::HalfVector{{2, 2, 2}});
+    auto result = index.search(pgvector::HalfVector{{2, 2, 2}}, 1);
+    assert_equal(result[0], pgvector::Neighbor{2, 0});
+}
+
+void test_recall() {
+    size_t dimensions = 16;
+    auto vectors = random_vectors(1000, dimensions);
+    HnswIndex<pgvector::Vector> index{dimensions, vectors.size()};
+    for (size_t i = 0; i < vectors.size(); i++) {
+        index.add(static_cast<int64_t>(i), pgvector::Vector{vectors[i]});
+    }
+
+    // each vector should find itself
+    size_t found = 0;
+    for (size_t i = 0; i < vectors.size(); i++) {
+        auto result = index.search(pgvector::Vector{vectors[i]}, 1);
+        if (!result.empty() && result[0].id == static_cast<int64_t>(i)) {
+            found++;
+        }
+    }
+    assert_equal(found >= 990, true);
+}
+
+void test_concurrent() {
+    size_t dimensions = 8;
+    auto vectors = random_vectors(400, dimensions);
+    HnswIndex<pgvector::Vector> index{dimensions, vectors.size()};
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < vectors.size(); i += 4) {
+                index.add(static_cast<int64_t>(i), pgvector::Vector{vectors[i]});
+                index.search(pgvector::Vector{vectors[i]}, 5);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    assert_equal(index.size(), vectors.size());
+    assert_equal(index.search(pgvector::Vector{vectors[0]}, 10).size(), 10u);
+}
+
+void test_load() {
+    std::vector<std::tuple<int64_t, pgvector::Vector>> rows{
+        {1, pgvector::Vector{{1, 1, 1}}}, {2, pgvector::Vector{{2, 2, 2}}}
+    };
+    HnswIndex<pgvector::Vector> index{3, 10};
+    index.load(rows);
+    assert_equal(index.size(), 2u);
+}
+
+void test_errors() {
+    HnswIndex<pgvector::Vector> index{3, 1};
+    assert_exception<std::invalid_argument>(
+        [&] { index.add(1, pgvector::Vector{{1, 1}}); }, "expected 3 dimensions, not 2"
+    );
+    index.add(1, pgvector::Vector{{1, 1, 1}});
+    assert_exception<std::length_error>(
+        [&] { index.add(2, pgvector::Vector{{1, 1, 1}}); }, "hnsw index is full"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { HnswIndex<pgvector::Vector>(3, 1, {.m = 1}); }, "m must be between 2 and 100"
+    );
+}
+} // namespace
+
+void test_hnsw() {
+    test_search();
+    test_search_empty();
+    test_search_zero();
+    test_metrics();
+    test_halfvec();
+    test_recall();
+    test_concurrent();
+    test_load();
+    test_errors();
+}
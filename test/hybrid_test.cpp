@@ -0,0 +1,138 @@
+#include <string>
+#include <vector>
+
+#include <pgvector/hybrid.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/sparsevec.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+#include "helper.hpp"
+
+using pgvector::Fusion;
+using pgvector::HybridOptions;
+using pgvector::HybridResult;
+using pgvector::HybridSearch;
+using pgvector::Retriever;
+
+namespace {
+const std::string conninfo = "dbname=pgvector_cpp_test";
+
+void setup() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
+    tx.exec("DROP TABLE IF EXISTS hybrid_documents");
+    tx.exec(
+        "CREATE TABLE hybrid_documents (id bigint PRIMARY KEY, content text, "
+        "embedding vector(3), sparse_embedding sparsevec(3))"
+    );
+    tx.exec(
+        "INSERT INTO hybrid_documents VALUES "
+        "(1, 'The dog is barking', '[1,0,0]', '{1:1}/3'), "
+        "(2, 'The cat is purring', '[0,1,0]', '{2:1}/3'), "
+        "(3, 'The bear is growling', '[0,0,1]', '{3:1}/3')"
+    );
+    tx.exec("DROP TABLE IF EXISTS hybrid_notes");
+    tx.exec(
+        "CREATE TABLE hybrid_notes (note_id bigint PRIMARY KEY, content text, embedding vector(3))"
+    );
+    tx.exec(
+        "INSERT INTO hybrid_notes VALUES "
+        "(10, 'The dog is barking', '[1,0,0]'), (20, 'The bear is growling', '[0,0,1]')"
+    );
+}
+
+void test_rrf() {
+    HybridSearch search{conninfo};
+    std::vector<Retriever> retrievers{
+        pgvector::semantic_retriever(
+            "hybrid_documents", "embedding", pgvector::Vector{{0.9f, 0.1f, 0}}, 20
+        ),
+        pgvector::keyword_retriever("hybrid_documents", "content", "growling bear", 20)
+    };
+    auto results = search.search(retrievers, 2);
+    assert_equal(results.size(), 2u);
+    // ranked last by semantic search and first by keyword search
+    assert_equal(results[0], HybridResult{3, 1.0 / 63 + 1.0 / 61});
+    assert_equal(results[1], HybridResult{1, 1.0 / 61});
+
+    // connections are reused
+    results = search.search(retrievers, 2);
+    assert_equal(results.size(), 2u);
+}
+
+void test_weighted() {
+    HybridSearch search{conninfo, HybridOptions{.fusion = Fusion::Weighted}};
+    Retriever semantic = pgvector::semantic_retriever(
+        "hybrid_documents", "embedding", pgvector::Vector{{1, 1, 0}}, 20, pgvector::Metric::L2
+    );
+    semantic.weight = 0.5;
+    Retriever sparse = pgvector::semantic_retriever(
+        "hybrid_documents",
+        "sparse_embedding",
+        pgvector::SparseVector{std::vector<float>{0, 0, 1}},
+        20,
+        pgvector::Metric::InnerProduct
+    );
+    auto results = search.search({semantic, sparse}, 3);
+    assert_equal(results.size(), 3u);
+    // sparse scores are scaled to 1 for the match and 0 otherwise
+    assert_equal(results[0], HybridResult{3, 1});
+    assert_equal(results[1], HybridResult{1, 0.5});
+    assert_equal(results[2], HybridResult{2, 0.5});
+}
+
+void test_custom() {
+    HybridSearch search{conninfo};
+    Retriever recent{
+        .sql = "SELECT id, id FROM hybrid_documents ORDER BY id DESC LIMIT $1",
+        .params = pqxx::params{2},
+        .weight = 2
+    };
+    auto results = search.search({recent}, 5);
+    assert_equal(results.size(), 2u);
+    assert_equal(results[0], HybridResult{3, 2.0 / 61});
+    assert_equal(results[1], HybridResult{2, 2.0 / 62});
+}
+
+void test_id_column() {
+    HybridSearch search{conninfo};
+    std::vector<Retriever> retrievers{
+        pgvector::semantic_retriever(
+            "hybrid_notes", "embedding", pgvector::Vector{{1, 0, 0}}, 20, pgvector::Metric::L2,
+            "note_id"
+        ),
+        pgvector::keyword_retriever("hybrid_notes", "content", "bear", 20, "english", "note_id")
+    };
+    auto results = search.search(retrievers, 2);
+    assert_equal(results.size(), 2u);
+    assert_equal(results[0], HybridResult{20, 1.0 / 62 + 1.0 / 61});
+    assert_equal(results[1], HybridResult{10, 1.0 / 61});
+}
+
+void test_empty() {
+    HybridSearch search{conninfo};
+    auto results = search.search(
+        {pgvector::keyword_retriever("hybrid_documents", "content", "unicorn", 20)}, 5
+    );
+    assert_equal(results.empty(), true);
+    assert_equal(search.search({}, 5).empty(), true);
+}
+
+void test_error() {
+    HybridSearch search{conninfo};
+    Retriever missing{.sql = "SELECT id, score FROM missing"};
+    assert_exception<pqxx::undefined_table>([&] { search.search({missing}, 5); });
+}
+} // namespace
+
+void test_hybrid() {
+    setup();
+    test_rrf();
+    test_weighted();
+    test_custom();
+    test_id_column();
+    test_empty();
+    test_error();
+}
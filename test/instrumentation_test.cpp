@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <pgvector/flat.hpp>
+#include <pgvector/hnsw.hpp>
+#include <pgvector/instrumentation.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+#include "helper.hpp"
+
+using pgvector::Metrics;
+using pgvector::Operation;
+
+namespace {
+class TestObserver : public pgvector::Observer {
+  public:
+    void record(const pgvector::Event& event) override {
+        std::lock_guard lock{mutex_};
+        events.push_back(event);
+    }
+
+    std::vector<pgvector::Event> events;
+
+  private:
+    std::mutex mutex_;
+};
+
+void test_percentile() {
+    Metrics metrics;
+    assert_equal(metrics.percentile(0.5), 0u);
+
+    metrics.count = 4;
+    metrics.histogram[3] = 3;
+    metrics.histogram[10] = 1;
+    assert_equal(metrics.percentile(0), 7u);
+    assert_equal(metrics.percentile(0.5), 7u);
+    assert_equal(metrics.percentile(0.75), 7u);
+    assert_equal(metrics.percentile(0.99), 1023u);
+    assert_equal(metrics.percentile(1), 1023u);
+}
+
+#ifdef PGVECTOR_INSTRUMENTATION
+void test_observer() {
+    TestObserver observer;
+    pgvector::set_observer(&observer);
+
+    pgvector::Vector vector{{1, 2, 3}};
+    std::string text = pqxx::to_string(vector);
+    pqxx::from_string<pgvector::Vector>(text);
+
+    pgvector::FlatIndex<pgvector::Vector> index{3};
+    index.add(1, vector);
+    index.search(vector, 1);
+
+    pgvector::set_observer(nullptr);
+
+    assert_equal(observer.events.size(), 4u);
+    assert_equal(observer.events[0].operation == Operation::Encode, true);
+    assert_equal(observer.events[0].name, std::string_view{"vector"});
+    assert_equal(observer.events[0].bytes, text.size());
+    assert_equal(observer.events[0].elements, 3u);
+    assert_equal(observer.events[1].operation == Operation::Decode, true);
+    assert_equal(observer.events[1].bytes, text.size());
+    assert_equal(observer.events[1].elements, 3u);
+    assert_equal(observer.events[2].operation == Operation::Insert, true);
+    assert_equal(observer.events[2].name, std::string_view{"flat"});
+    assert_equal(observer.events[3].operation == Operation::Search, true);
+    assert_equal(observer.events[3].elements, 1u);
+}
+
+void test_exception() {
+    TestObserver observer;
+    pgvector::set_observer(&observer);
+    try {
+        pqxx::from_string<pgvector::Vector>("[1,2");
+    } catch (const pqxx::conversion_error&) {
+    }
+    pgvector::set_observer(nullptr);
+
+    assert_equal(observer.events.size(), 0u);
+}
+
+void test_metrics() {
+    pgvector::reset_metrics();
+
+    pgvector::HnswIndex<pgvector::Vector> index{2, 100};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&index, t] {
+            for (int i = 0; i < 10; i++) {
+                float x = static_cast<float>(t * 10 + i);
+                index.add(t * 10 + i, pgvector::Vector{{x, x}});
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    index.search(pgvector::Vector{{1, 1}}, 5);
+
+    Metrics insert = pgvector::metrics(Operation::Insert);
+    assert_equal(insert.count, 40u);
+    assert_equal(insert.elements, 40u);
+    uint64_t total = 0;
+    for (auto v : insert.histogram) {
+        total += v;
+    }
+    assert_equal(total, 40u);
+    assert_equal(pgvector::metrics(Operation::Search).count, 1u);
+
+    pgvector::reset_metrics();
+    assert_equal(pgvector::metrics(Operation::Insert).count, 0u);
+}
+
+void test_short_lived_threads() {
+    pgvector::reset_metrics();
+
+    pgvector::FlatIndex<pgvector::Vector> index{2};
+    for (int i = 0; i < 200; i++) {
+        std::thread thread{[&index, i] {
+            float x = static_cast<float>(i);
+            index.add(i, pgvector::Vector{{x, x}});
+        }};
+        thread.join();
+    }
+
+    // exited threads are folded into the totals and removed
+    auto& registry = pgvector::detail::metrics_registry();
+    {
+        std::lock_guard lock{registry.mutex};
+        assert_equal(registry.threads.size() <= 1, true);
+    }
+    assert_equal(pgvector::metrics(Operation::Insert).count, 200u);
+
+    pgvector::reset_metrics();
+    assert_equal(pgvector::metrics(Operation::Insert).count, 0u);
+}
+#endif
+} // namespace
+
+void test_instrumentation() {
+    test_percentile();
+#ifdef PGVECTOR_INSTRUMENTATION
+    test_observer();
+    test_exception();
+    test_metrics();
+    test_short_lived_threads();
+#endif
+}
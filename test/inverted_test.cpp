@@ -0,0 +1,196 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/flat.hpp>
+#include <pgvector/inverted.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/sparsevec.hpp>
+
+#include "helper.hpp"
+
+using pgvector::InvertedIndex;
+using pgvector::Neighbor;
+using pgvector::SparseVector;
+
+namespace {
+std::vector<SparseVector> random_vectors(size_t n, int dimensions, float negative, uint32_t seed) {
+    std::mt19937 gen{seed};
+    // skew terms like text so some lists are long and others short
+    std::geometric_distribution<int> term{0.02};
+    std::uniform_real_distribution<float> value{0, 1};
+    std::bernoulli_distribution flip{negative};
+    std::vector<SparseVector> result;
+    for (size_t i = 0; i < n; i++) {
+        pgvector::SparseVectorBuilder builder{dimensions};
+        std::vector<bool> seen(static_cast<size_t>(dimensions));
+        for (int j = 0; j < 20; j++) {
+            int index = term(gen) % dimensions;
+            if (!seen[static_cast<size_t>(index)]) {
+                seen[static_cast<size_t>(index)] = true;
+                builder.push_back(index, flip(gen) ? -value(gen) : value(gen) + 0.01f);
+            }
+        }
+        result.push_back(builder.build());
+    }
+    return result;
+}
+
+void test_search() {
+    InvertedIndex index{4};
+    index.add(1, SparseVector{{1, 0, 2, 0}});
+    index.add(2, SparseVector{{0, 3, 0, 1}});
+    index.add(3, SparseVector{{1, 1, 1, 0}});
+    index.build();
+    assert_equal(index.size(), 3u);
+
+    auto result = index.search(SparseVector{{1, 1, 0, 0}}, 3);
+    assert_equal(result.size(), 3u);
+    assert_equal(result[0], Neighbor{2, -3});
+    assert_equal(result[1], Neighbor{3, -2});
+    assert_equal(result[2], Neighbor{1, -1});
+
+    // only vectors that share a dimension with the query
+    assert_equal(index.search(SparseVector{{0, 0, 0, 1}}, 3).size(), 1u);
+    assert_equal(index.search(SparseVector{{0, 0, 0, 0}}, 3).size(), 0u);
+    assert_equal(index.search(SparseVector{{1, 1, 0, 0}}, 0).size(), 0u);
+}
+
+void test_ties() {
+    InvertedIndex index{3, {.block_size = 2}};
+    for (int64_t id = 10; id > 0; id--) {
+        index.add(id, SparseVector{{1, 0, 1}});
+    }
+    index.build();
+    auto result = index.search(SparseVector{{1, 0, 0}}, 3);
+    assert_equal(result[0], Neighbor{1, -1});
+    assert_equal(result[1], Neighbor{2, -1});
+    assert_equal(result[2], Neighbor{3, -1});
+}
+
+void test_matches_flat() {
+    int dimensions = 500;
+    auto vectors = random_vectors(3000, dimensions, 0, 1);
+    auto queries = random_vectors(50, dimensions, 0, 2);
+
+    pgvector::FlatIndex<SparseVector> flat{
+        static_cast<size_t>(dimensions), {.metric = pgvector::Metric::InnerProduct}
+    };
+    for (size_t i = 0; i < vectors.size(); i++) {
+        flat.add(static_cast<int64_t>(i), vectors[i]);
+    }
+
+    for (size_t block_size : {1, 16, 128}) {
+        for (size_t threads : {1, 3}) {
+            InvertedIndex index{
+                static_cast<size_t>(dimensions), {.block_size = block_size, .threads = threads}
+            };
+            for (size_t i = 0; i < vectors.size(); i++) {
+                index.add(static_cast<int64_t>(i), vectors[i]);
+            }
+            index.build();
+            for (size_t k : {1, 10, 100}) {
+                assert_equal(index.search(queries, k) == flat.search(queries, k), true);
+            }
+        }
+    }
+}
+
+void test_negative() {
+    int dimensions = 200;
+    auto vectors = random_vectors(1000, dimensions, 0.3f, 3);
+    auto queries = random_vectors(20, dimensions, 0.3f, 4);
+
+    InvertedIndex index{static_cast<size_t>(dimensions), {.block_size = 8}};
+    for (size_t i = 0; i < vectors.size(); i++) {
+        index.add(static_cast<int64_t>(i), vectors[i]);
+    }
+    index.build();
+
+    for (const auto& query : queries) {
+        // brute force over vectors that share a dimension, adding in query order
+        pgvector::TopK top{10};
+        for (size_t i = 0; i < vectors.size(); i++) {
+            const auto& indices = vectors[i].indices();
+            const auto& values = vectors[i].values();
+            float score = 0;
+            bool overlap = false;
+            size_t j = 0;
+            for (size_t q = 0; q < query.indices().size(); q++) {
+                while (j < indices.size() && indices[j] < query.indices()[q]) {
+                    j++;
+                }
+                if (j < indices.size() && indices[j] == query.indices()[q]) {
+                    score += query.values()[q] * values[j];
+                    overlap = true;
+                }
+            }
+            if (overlap) {
+                top.push(static_cast<int64_t>(i), -score);
+            }
+        }
+        assert_equal(index.search(query, 10) == top.sorted(), true);
+    }
+}
+
+void test_build() {
+    InvertedIndex index{2};
+    assert_equal(index.built(), true);
+    assert_equal(index.search(SparseVector{{1, 0}}, 1).size(), 0u);
+
+    index.add(1, SparseVector{{1, 0}});
+    assert_equal(index.built(), false);
+    assert_exception<std::logic_error>(
+        [&] { index.search(SparseVector{{1, 0}}, 1); }, "inverted index must be built"
+    );
+
+    index.build();
+    index.add(2, SparseVector{{2, 0}});
+    index.build();
+    assert_equal(index.search(SparseVector{{1, 0}}, 1)[0], Neighbor{2, -2});
+}
+
+void test_batch() {
+    InvertedIndex index{2};
+    std::vector<int64_t> ids{1, 2};
+    std::vector<SparseVector> values{SparseVector{{1, 0}}, SparseVector{{0, 1}}};
+    index.add(ids, values);
+    index.build();
+    assert_equal(index.size(), 2u);
+
+    std::vector<SparseVector> queries{SparseVector{{0, 1}}, SparseVector{{1, 0}}};
+    auto result = index.search(queries, 1);
+    assert_equal(result[0][0].id, 2);
+    assert_equal(result[1][0].id, 1);
+
+    std::vector<int64_t> ids2{3};
+    assert_exception<std::invalid_argument>(
+        [&] { index.add(ids2, values); }, "ids and values must be the same size"
+    );
+}
+
+void test_invalid() {
+    InvertedIndex index{4};
+    assert_exception<std::invalid_argument>(
+        [&] { index.add(1, SparseVector{{1, 2}}); }, "expected 4 dimensions, not 2"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { index.search(SparseVector{{1, 2}}, 1); }, "expected 4 dimensions, not 2"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { InvertedIndex(4, {.block_size = 0}); }, "block_size must be greater than 0"
+    );
+}
+} // namespace
+
+void test_inverted() {
+    test_search();
+    test_ties();
+    test_matches_flat();
+    test_negative();
+    test_build();
+    test_batch();
+    test_invalid();
+}
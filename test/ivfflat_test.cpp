@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/halfvec.hpp>
+#include <pgvector/ivfflat.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::IvfflatIndex;
+using pgvector::Metric;
+
+namespace {
+std::vector<pgvector::Vector> random_vectors(size_t rows, size_t dimensions) {
+    std::mt19937_64 prng;
+    std::uniform_real_distribution<float> dist{0, 1};
+    std::vector<pgvector::Vector> vectors;
+    for (size_t i = 0; i < rows; i++) {
+        std::vector<float> v(dimensions);
+        for (auto& x : v) {
+            x = dist(prng);
+        }
+        vectors.emplace_back(std::move(v));
+    }
+    return vectors;
+}
+
+void test_search() {
+    IvfflatIndex<pgvector::Vector> index{3, {.lists = 2}};
+    std::vector<pgvector::Vector> vectors{
+        pgvector::Vector{{1, 1, 1}}, pgvector::Vector{{2, 2, 2}}, pgvector::Vector{{1, 1, 2}}
+    };
+    index.train(vectors);
+    assert_equal(index.trained(), true);
+    for (size_t i = 0; i < vectors.size(); i++) {
+        index.add(static_cast<int64_t>(i + 1), vectors[i]);
+    }
+    assert_equal(index.size(), 3u);
+
+    auto result = index.search(pgvector::Vector{{1, 1, 1}}, 2, 2);
+    assert_equal(result.size(), 2u);
+    assert_equal(result[0], pgvector::Neighbor{1, 0});
+    assert_equal(result[1], pgvector::Neighbor{3, 1});
+    assert_equal(index.search(pgvector::Vector{{1, 1, 1}}, 0, 2).empty(), true);
+}
+
+void test_probes() {
+    auto vectors = random_vectors(1000, 8);
+    IvfflatIndex<pgvector::Vector> index{8, {.lists = 10, .threads = 2}};
+    index.train(vectors);
+
+    std::vector<int64_t> ids;
+    for (size_t i = 0; i < vectors.size(); i++) {
+        ids.push_back(static_cast<int64_t>(i));
+    }
+    index.add(ids, vectors);
+    assert_equal(index.size(), 1000u);
+
+    size_t total = 0;
+    for (auto s : index.list_sizes()) {
+        total += s;
+    }
+    assert_equal(total, 1000u);
+
+    // each vector should find itself in its own list
+    for (size_t i = 0; i < 100; i++) {
+        auto result = index.search(vectors[i], 1);
+        assert_equal(result[0].id, static_cast<int64_t>(i));
+    }
+
+    // searching all lists is exact
+    auto result = index.search(vectors[0], 1000, 10);
+    assert_equal(result.size(), 1000u);
+}
+
+void test_metrics() {
+    std::vector<pgvector::Vector> vectors{pgvector::Vector{{1, 0}}, pgvector::Vector{{5, 5}}};
+
+    IvfflatIndex<pgvector::Vector> index{2, {.metric = Metric::Cosine, .lists = 1}};
+    index.train(vectors);
+    index.add(1, vectors[0]);
+    index.add(2, vectors[1]);
+    assert_equal(index.search(pgvector::Vector{{3, 3}}, 1)[0].id, 2);
+
+    IvfflatIndex<pgvector::Vector> index2{2, {.metric = Metric::InnerProduct, .lists = 1}};
+    index2.train(vectors);
+    index2.add(1, vectors[0]);
+    index2.add(2, vectors[1]);
+    assert_equal(index2.search(pgvector::Vector{{1, 0}}, 1)[0], pgvector::Neighbor{2, -5});
+}
+
+void test_halfvec() {
+    std::vector<pgvector::HalfVector> vectors{
+        pgvector::HalfVector{{1, 1, 1}}, pgvector::HalfVector{{2, 2, 2}}
+    };
+    IvfflatIndex<pgvector::HalfVector> index{3, {.lists = 2}};
+    index.train(vectors);
+    index.add(1, vectors[0]);
+    index.add(2, vectors[1]);
+    assert_equal(index.search(vectors[1], 1, 2)[0], pgvector::Neighbor{2, 0});
+}
+
+void test_errors() {
+    IvfflatIndex<pgvector::Vector> index{3};
+    assert_exception<std::logic_error>(
+        [&] { index.add(1, pgvector::Vector{{1, 1, 1}}); }, "ivfflat index must be trained"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { IvfflatIndex<pgvector::Vector>(3, {.metric = Metric::L1}); },
+        "ivfflat does not support L1 distance"
+    );
+
+    std::vector<pgvector::Vector> sample{pgvector::Vector{{1, 1, 1}}};
+    index.train(sample);
+    index.add(1, sample[0]);
+    assert_exception<std::logic_error>(
+        [&] { index.train(sample); }, "ivfflat index must be empty to train"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { IvfflatIndex<pgvector::Vector>(3, {.lists = 0}); }, "lists must be between 1 and 32768"
+    );
+}
+} // namespace
+
+void test_ivfflat() {
+    test_search();
+    test_probes();
+    test_metrics();
+    test_halfvec();
+    test_errors();
+}
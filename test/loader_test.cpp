@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include <pgvector/loader.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+#include "helper.hpp"
+
+using pgvector::BulkLoader;
+using pgvector::LoaderOptions;
+
+namespace {
+const std::string conninfo = "dbname=pgvector_cpp_test";
+
+void setup() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
+    tx.exec("DROP TABLE IF EXISTS loader_items");
+    tx.exec("CREATE TABLE loader_items (id bigint PRIMARY KEY, embedding vector(3))");
+}
+
+int64_t count() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    return tx.exec("SELECT COUNT(*) FROM loader_items").one_row()[0].as<int64_t>();
+}
+
+void test_load() {
+    setup();
+
+    BulkLoader<int64_t, pgvector::Vector> loader{
+        conninfo, "loader_items", {"id", "embedding"},
+        LoaderOptions{.connections = 3, .batch_size = 10, .max_pending_rows = 50}
+    };
+    for (int64_t i = 0; i < 1000; i++) {
+        float x = static_cast<float>(i);
+        loader.write_values(i, pgvector::Vector{{x, x, x}});
+    }
+    loader.after_load("CREATE INDEX ON loader_items USING hnsw (embedding vector_l2_ops)");
+    auto stats = loader.complete();
+
+    assert_equal(stats.rows, 1000u);
+    assert_equal(stats.rows_per_second() > 0, true);
+    assert_equal(stats.after_load_time.count() > 0, true);
+    assert_equal(count(), 1000);
+
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    auto embedding = tx.exec("SELECT embedding FROM loader_items WHERE id = 7")
+                         .one_row()[0]
+                         .as<pgvector::Vector>();
+    assert_equal(embedding, pgvector::Vector{{7, 7, 7}});
+}
+
+void test_schema() {
+    pqxx::connection conn{conninfo};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE SCHEMA IF NOT EXISTS loader_schema");
+    tx.exec("DROP TABLE IF EXISTS loader_schema.items");
+    tx.exec("CREATE TABLE loader_schema.items (id bigint PRIMARY KEY)");
+
+    BulkLoader<int64_t> loader{
+        conninfo, "items", {"id"}, LoaderOptions{.connections = 2, .schema = "loader_schema"}
+    };
+    loader.write_values(1);
+    loader.write_values(2);
+    loader.complete();
+    assert_equal(
+        tx.exec("SELECT COUNT(*) FROM loader_schema.items").one_row()[0].as<int64_t>(), 2
+    );
+}
+
+void test_error() {
+    setup();
+
+    BulkLoader<int64_t, pgvector::Vector> loader{
+        conninfo, "loader_items", {"id", "embedding"}, LoaderOptions{.connections = 2}
+    };
+    // duplicate primary keys
+    loader.write_values(1, pgvector::Vector{{1, 1, 1}});
+    loader.write_values(1, pgvector::Vector{{1, 1, 1}});
+    assert_exception<pqxx::unique_violation>([&] { loader.complete(); });
+    assert_equal(count(), 0);
+}
+
+void test_abort() {
+    setup();
+    {
+        BulkLoader<int64_t, pgvector::Vector> loader{
+            conninfo, "loader_items", {"id", "embedding"}
+        };
+        loader.write_values(1, pgvector::Vector{{1, 1, 1}});
+    }
+    assert_equal(count(), 0);
+}
+
+void test_options() {
+    assert_exception<std::invalid_argument>(
+        [] {
+            BulkLoader<int64_t>{conninfo, "loader_items", {"id"}, LoaderOptions{.connections = 0}};
+        },
+        "connections must be greater than 0"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { BulkLoader<int64_t>{conninfo, "loader_items", {"id", "embedding"}}; },
+        "expected one column per value"
+    );
+}
+} // namespace
+
+void test_loader() {
+    test_load();
+    test_schema();
+    test_error();
+    test_abort();
+    test_options();
+}
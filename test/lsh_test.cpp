@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/bit.hpp>
+#include <pgvector/lsh.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::SimHash;
+using pgvector::SimHashOptions;
+
+namespace {
+std::vector<pgvector::Vector> random_vectors(size_t n, size_t dimensions, std::mt19937_64& prng) {
+    std::normal_distribution<float> dist;
+    std::vector<pgvector::Vector> vectors;
+    for (size_t i = 0; i < n; i++) {
+        std::vector<float> v(dimensions);
+        for (auto& x : v) {
+            x = dist(prng);
+        }
+        vectors.emplace_back(std::move(v));
+    }
+    return vectors;
+}
+
+void test_signature() {
+    SimHash lsh{3, SimHashOptions{.bits = 16}};
+    auto signature = lsh.signature(pgvector::Vector{{1, 2, 3}});
+    assert_equal(signature.size(), 2u);
+
+    // scale does not change the signature
+    assert_equal(signature == lsh.signature(pgvector::Vector{{2, 4, 6}}), true);
+
+    // opposite vectors have opposite signatures
+    auto opposite = lsh.signature(pgvector::Vector{{-1, -2, -3}});
+    assert_equal(pgvector::hamming_distance(signature, opposite), 16.0f);
+
+    // deterministic
+    SimHash other{3, SimHashOptions{.bits = 16}};
+    assert_equal(signature == other.signature(pgvector::Vector{{1, 2, 3}}), true);
+
+    assert_equal(pgvector::unpack_bits(signature, 16).size(), 16u);
+}
+
+void test_signatures() {
+    std::mt19937_64 prng{1};
+    auto vectors = random_vectors(100, 16, prng);
+    SimHash lsh{16, SimHashOptions{.bits = 100, .bands = 10, .threads = 4}};
+
+    auto signatures = lsh.signatures(vectors);
+    assert_equal(signatures.rows(), 100u);
+    assert_equal(signatures.dimensions(), 13u);
+
+    pgvector::VectorBatch<float> batch{16};
+    for (const auto& v : vectors) {
+        batch.push_back(v.values());
+    }
+    auto batch_signatures = lsh.signatures(batch);
+    for (size_t i = 0; i < vectors.size(); i++) {
+        auto expected = lsh.signature(vectors[i]);
+        assert_equal(std::ranges::equal(signatures.row(i), expected), true);
+        assert_equal(std::ranges::equal(batch_signatures.row(i), expected), true);
+    }
+}
+
+void test_group() {
+    std::mt19937_64 prng{1};
+    std::normal_distribution<float> noise{0, 0.001f};
+    auto originals = random_vectors(50, 32, prng);
+
+    // each original followed by two near-duplicates
+    std::vector<pgvector::Vector> vectors;
+    for (const auto& v : originals) {
+        vectors.push_back(v);
+        for (int j = 0; j < 2; j++) {
+            std::vector<float> copy = v.values();
+            for (auto& x : copy) {
+                x += noise(prng);
+            }
+            vectors.emplace_back(std::move(copy));
+        }
+    }
+
+    SimHash lsh{32, SimHashOptions{.threads = 4}};
+    auto groups = lsh.group(vectors);
+    assert_equal(groups.size(), 150u);
+    for (size_t i = 0; i < originals.size(); i++) {
+        assert_equal(groups[i * 3], i * 3);
+        assert_equal(groups[i * 3 + 1], i * 3);
+        assert_equal(groups[i * 3 + 2], i * 3);
+    }
+}
+
+void test_group_chain() {
+    // A and B are far apart but both close to C, and all share the first band
+    pgvector::VectorBatch<uint8_t> signatures{2};
+    signatures.push_back(std::vector<uint8_t>{0x00, 0x00});
+    signatures.push_back(std::vector<uint8_t>{0x00, 0xff});
+    signatures.push_back(std::vector<uint8_t>{0x00, 0x0f});
+
+    SimHash lsh{4, SimHashOptions{.bits = 16, .bands = 2, .max_distance = 4}};
+    auto groups = lsh.group(signatures);
+    assert_equal(groups[0], 0u);
+    assert_equal(groups[1], 0u);
+    assert_equal(groups[2], 0u);
+}
+
+void test_group_random() {
+    // compare with linking every close pair that shares a band
+    std::mt19937_64 prng{2};
+    pgvector::VectorBatch<uint8_t> signatures{2};
+    for (size_t i = 0; i < 300; i++) {
+        uint64_t v = prng();
+        signatures.push_back(
+            std::vector<uint8_t>{static_cast<uint8_t>(v), static_cast<uint8_t>(v >> 8)}
+        );
+    }
+    SimHash lsh{4, SimHashOptions{.bits = 16, .bands = 4, .max_distance = 2, .threads = 2}};
+    auto groups = lsh.group(signatures);
+
+    size_t n = signatures.rows();
+    auto bits = [&](size_t i) { return signatures[i][0] << 8 | signatures[i][1]; };
+    std::vector<size_t> expected(n);
+    for (size_t i = 0; i < n; i++) {
+        expected[i] = i;
+    }
+    auto find = [&](size_t i) {
+        while (expected[i] != i) {
+            i = expected[i];
+        }
+        return i;
+    };
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < i; j++) {
+            int x = bits(i) ^ bits(j);
+            bool shared = (x & 0xf) == 0 || (x & 0xf0) == 0 || (x & 0xf00) == 0
+                || (x & 0xf000) == 0;
+            if (shared && std::popcount(static_cast<unsigned>(x)) <= 2) {
+                size_t ri = find(i);
+                size_t rj = find(j);
+                expected[std::max(ri, rj)] = std::min(ri, rj);
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        assert_equal(groups[i], find(i));
+    }
+}
+
+void test_options() {
+    assert_exception<std::invalid_argument>(
+        [] { SimHash{3, SimHashOptions{.bits = 64, .bands = 3}}; },
+        "bands must divide bits into at most 64 bits each"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { SimHash{3, SimHashOptions{.bits = 128, .bands = 1}}; },
+        "bands must divide bits into at most 64 bits each"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { SimHash{0}; }, "dimensions must be greater than 0"
+    );
+
+    SimHash lsh{3};
+    assert_exception<std::invalid_argument>(
+        [&] { lsh.signature(pgvector::Vector{{1, 2}}); }, "different vector dimensions"
+    );
+}
+} // namespace
+
+void test_lsh() {
+    test_signature();
+    test_signatures();
+    test_group();
+    test_group_chain();
+    test_group_random();
+    test_options();
+}
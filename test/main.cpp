@@ -1,15 +1,87 @@
 // Test ODR
+#include <pgvector/batch.hpp>
+#include <pgvector/bit.hpp>
+#include <pgvector/cache.hpp>
+#include <pgvector/compact.hpp>
+#include <pgvector/dedup.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/extract.hpp>
+#include <pgvector/fixed.hpp>
+#include <pgvector/flat.hpp>
+#include <pgvector/hash.hpp>
+#include <pgvector/hnsw.hpp>
+#include <pgvector/hybrid.hpp>
+#include <pgvector/instrumentation.hpp>
+#include <pgvector/inverted.hpp>
+#include <pgvector/ivfflat.hpp>
+#include <pgvector/loader.hpp>
+#include <pgvector/lsh.hpp>
+#include <pgvector/math.hpp>
+#include <pgvector/multivec.hpp>
+#include <pgvector/pq.hpp>
 #include <pgvector/pqxx.hpp>
+#include <pgvector/prune.hpp>
+#include <pgvector/reduce.hpp>
+#include <pgvector/scatter.hpp>
+#include <pgvector/vecs.hpp>
 
 void test_vector();
 void test_halfvec();
 void test_sparsevec();
+void test_distance();
+void test_hnsw();
+void test_ivfflat();
+void test_flat();
+void test_bit();
+void test_batch();
+void test_instrumentation();
+void test_cache();
+void test_hash();
+void test_dedup();
+void test_lsh();
+void test_vecs();
+void test_loader();
+void test_scatter();
+void test_hybrid();
+void test_prune();
+void test_compact();
+void test_inverted();
+void test_fixed();
+void test_extract();
+void test_math();
+void test_reduce();
+void test_pq();
+void test_multivec();
 void test_pqxx();
 
 int main() {
     test_vector();
     test_halfvec();
     test_sparsevec();
+    test_distance();
+    test_hnsw();
+    test_ivfflat();
+    test_flat();
+    test_bit();
+    test_batch();
+    test_instrumentation();
+    test_cache();
+    test_hash();
+    test_dedup();
+    test_lsh();
+    test_vecs();
+    test_loader();
+    test_scatter();
+    test_hybrid();
+    test_prune();
+    test_compact();
+    test_inverted();
+    test_fixed();
+    test_extract();
+    test_math();
+    test_reduce();
+    test_pq();
+    test_multivec();
     test_pqxx();
     return 0;
 }
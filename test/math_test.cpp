@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/math.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::Half;
+using pgvector::HalfVector;
+using pgvector::Vector;
+using pgvector::VectorBatch;
+
+namespace {
+VectorBatch<float> random_batch(size_t rows, size_t dimensions) {
+    std::mt19937 gen{1};
+    std::uniform_real_distribution<float> dist{-1, 1};
+    VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows; i++) {
+        for (auto& v : batch[i]) {
+            v = dist(gen);
+        }
+    }
+    return batch;
+}
+
+void assert_near(float actual, float expected) {
+    assert_equal(std::fabs(actual - expected) <= 1e-5f * std::max(1.0f, std::fabs(expected)), true);
+}
+
+void test_norm() {
+    std::vector<float> a{3, 4};
+    assert_equal(pgvector::norm(a), 5.0f);
+
+    std::vector<Half> b{3, 4};
+    assert_equal(pgvector::norm(b), 5.0f);
+
+    VectorBatch<float> batch = random_batch(2000, 67);
+    for (size_t threads : {1, 4}) {
+        std::vector<float> norms = pgvector::norms(batch, {.threads = threads});
+        assert_equal(norms.size(), 2000u);
+        for (size_t i = 0; i < batch.rows(); i++) {
+            assert_equal(norms[i], pgvector::norm(batch[i]));
+        }
+    }
+}
+
+void test_normalize() {
+    std::vector<float> a{3, 4};
+    pgvector::normalize(a);
+    assert_equal(a == std::vector<float>{0.6f, 0.8f}, true);
+
+    // zero vectors are unchanged
+    std::vector<float> zero(3);
+    pgvector::normalize(zero);
+    assert_equal(zero == std::vector<float>(3), true);
+
+    assert_equal(pgvector::normalize(Vector{{3, 4}}), Vector{{0.6f, 0.8f}});
+    HalfVector h = pgvector::normalize(HalfVector{{0, 3, 0, 4}});
+    assert_equal(static_cast<float>(h.values()[3]), static_cast<float>(static_cast<Half>(0.8f)));
+
+    // matches single vectors with and without threads
+    VectorBatch<float> batch = random_batch(3000, 100);
+    VectorBatch<float> expected = batch;
+    for (size_t i = 0; i < expected.rows(); i++) {
+        pgvector::normalize(expected[i]);
+    }
+    pgvector::normalize(batch, {.threads = 4});
+    for (size_t i = 0; i < batch.rows(); i++) {
+        assert_equal(std::ranges::equal(batch[i], expected[i]), true);
+        assert_near(pgvector::norm(batch[i]), 1);
+    }
+}
+
+void test_arithmetic() {
+    // long enough to use SIMD with a remainder
+    std::vector<float> a(19);
+    std::vector<float> b(19);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = static_cast<float>(i);
+        b[i] = 0.5f;
+    }
+    pgvector::add(a, b);
+    assert_equal(a[18], 18.5f);
+    pgvector::subtract(a, b);
+    assert_equal(a[18], 18.0f);
+    pgvector::scale(a, 2);
+    assert_equal(a[18], 36.0f);
+    assert_equal(a[0], 0.0f);
+
+    std::vector<Half> h(19, Half{1});
+    std::vector<Half> h2(19, Half{2});
+    pgvector::add(h, h2);
+    pgvector::scale(h, 0.5f);
+    pgvector::subtract(h, h2);
+    assert_equal(static_cast<float>(h[18]), -0.5f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::add(a, std::vector<float>(2)); }, "different vector dimensions"
+    );
+}
+
+void test_arithmetic_batch() {
+    VectorBatch<float> batch = random_batch(1000, 70);
+    VectorBatch<float> expected = batch;
+    std::vector<float> center(70, 0.25f);
+
+    pgvector::subtract(batch, center, {.threads = 4});
+    pgvector::scale(batch, 3, {.threads = 4});
+    pgvector::add(batch, center, {.threads = 4});
+    for (size_t i = 0; i < expected.rows(); i++) {
+        pgvector::subtract(expected[i], center);
+        pgvector::scale(expected[i], 3);
+        pgvector::add(expected[i], center);
+        assert_equal(std::ranges::equal(batch[i], expected[i]), true);
+    }
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::add(batch, std::vector<float>(2)); }, "different vector dimensions"
+    );
+}
+
+void test_mean() {
+    std::vector<Vector> values{Vector{{1, 2}}, Vector{{3, 6}}};
+    assert_equal(pgvector::mean(values), Vector{{2, 4}});
+
+    std::vector<float> weights{3, 1};
+    assert_equal(pgvector::mean(values, weights), Vector{{1.5f, 3}});
+
+    VectorBatch<Half> halves{2};
+    halves.push_back(std::vector<Half>{1, 2});
+    halves.push_back(std::vector<Half>{3, 6});
+    assert_equal(pgvector::mean(halves), Vector{{2, 4}});
+
+    // threads sum separately
+    VectorBatch<float> batch = random_batch(5000, 50);
+    std::vector<double> expected(50);
+    for (size_t i = 0; i < batch.rows(); i++) {
+        for (size_t j = 0; j < 50; j++) {
+            expected[j] += batch[i][j];
+        }
+    }
+    for (size_t threads : {1, 4}) {
+        Vector result = pgvector::mean(batch, {}, {.threads = threads});
+        for (size_t j = 0; j < 50; j++) {
+            assert_near(result.values()[j], static_cast<float>(expected[j] / 5000));
+        }
+    }
+}
+
+void test_mean_invalid() {
+    std::vector<Vector> values{Vector{{1, 2}}, Vector{{3, 6}}};
+    assert_exception<std::invalid_argument>(
+        [] { pgvector::mean(std::vector<Vector>{}); }, "expected at least one vector"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::mean(values, std::vector<float>{1}); },
+        "weights and values must be the same size"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::mean(values, std::vector<float>{1, -1}); }, "weights must not sum to zero"
+    );
+    values.push_back(Vector{{1}});
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::mean(values); }, "different vector dimensions"
+    );
+}
+} // namespace
+
+void test_math() {
+    test_norm();
+    test_normalize();
+    test_arithmetic();
+    test_arithmetic_batch();
+    test_mean();
+    test_mean_invalid();
+}
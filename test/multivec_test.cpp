@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/multivec.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::MultiVector;
+using pgvector::Neighbor;
+using pgvector::Vector;
+using pgvector::VectorBatch;
+
+namespace {
+MultiVector random_multivector(size_t tokens, size_t dimensions, std::mt19937_64& gen) {
+    std::uniform_real_distribution<float> dist{-1, 1};
+    VectorBatch<float> batch{dimensions, tokens};
+    for (size_t i = 0; i < tokens; i++) {
+        for (auto& v : batch[i]) {
+            v = dist(gen);
+        }
+    }
+    return MultiVector{std::move(batch)};
+}
+
+// the definition, with the same inner products as the rest of the library
+float expected_max_sim(const MultiVector& query, const MultiVector& document) {
+    float sum = 0;
+    for (size_t i = 0; i < query.size(); i++) {
+        float best = -std::numeric_limits<float>::infinity();
+        for (size_t j = 0; j < document.size(); j++) {
+            best = std::max(best, pgvector::inner_product(query[i], document[j]));
+        }
+        sum += best;
+    }
+    return sum;
+}
+
+void test_multivector() {
+    std::vector<Vector> tokens{Vector{{1, 2, 3}}, Vector{{4, 5, 6}}};
+    MultiVector value{tokens};
+    assert_equal(value.dimensions(), 3u);
+    assert_equal(value.size(), 2u);
+    assert_equal(value.empty(), false);
+    assert_equal(Vector{value[1]}, tokens[1]);
+    assert_equal(value.tokens().rows(), 2u);
+    assert_equal(value, MultiVector{std::span<const Vector>{tokens}});
+
+    MultiVector empty;
+    assert_equal(empty.size(), 0u);
+    assert_equal(empty.empty(), true);
+
+    tokens.push_back(Vector{{1, 2}});
+    assert_exception<std::invalid_argument>(
+        [&] { MultiVector{tokens}; }, "expected 3 dimensions, not 2"
+    );
+}
+
+void test_max_sim() {
+    std::vector<Vector> query_tokens{Vector{{1, 0}}, Vector{{0, 1}}};
+    std::vector<Vector> document_tokens{Vector{{2, 1}}, Vector{{-1, 3}}};
+    MultiVector query{query_tokens};
+    MultiVector document{document_tokens};
+    // max(2, -1) + max(1, 3)
+    assert_equal(pgvector::max_sim(query, document), 5.0f);
+
+    // token and dimension counts that exercise each part of the kernel
+    std::mt19937_64 gen{1};
+    for (size_t dimensions : {1, 7, 8, 16, 43, 128}) {
+        for (size_t tokens : {1, 3, 4, 9}) {
+            MultiVector q = random_multivector(tokens, dimensions, gen);
+            MultiVector d = random_multivector(tokens + 2, dimensions, gen);
+            assert_equal(pgvector::max_sim(q, d), expected_max_sim(q, d));
+        }
+    }
+}
+
+void test_max_sim_empty() {
+    std::mt19937_64 gen{2};
+    MultiVector query = random_multivector(3, 4, gen);
+    float score = pgvector::max_sim(query, MultiVector{});
+    assert_equal(std::isinf(score) && score < 0, true);
+    assert_equal(pgvector::max_sim(MultiVector{4}, query), 0.0f);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::max_sim(query, random_multivector(2, 5, gen)); },
+        "different vector dimensions"
+    );
+}
+
+void test_max_sim_batch() {
+    std::mt19937_64 gen{3};
+    MultiVector query = random_multivector(32, 64, gen);
+    std::vector<MultiVector> documents;
+    for (size_t i = 0; i < 200; i++) {
+        documents.push_back(random_multivector(10 + i % 50, 64, gen));
+    }
+
+    for (size_t threads : {1, 4}) {
+        std::vector<float> scores = pgvector::max_sim(query, documents, {.threads = threads});
+        assert_equal(scores.size(), documents.size());
+        for (size_t i = 0; i < documents.size(); i++) {
+            assert_equal(scores[i], pgvector::max_sim(query, documents[i]));
+        }
+    }
+}
+
+void test_rerank() {
+    std::mt19937_64 gen{4};
+    MultiVector query = random_multivector(8, 16, gen);
+    std::vector<MultiVector> documents;
+    std::vector<int64_t> ids;
+    for (size_t i = 0; i < 100; i++) {
+        documents.push_back(random_multivector(5 + i % 7, 16, gen));
+        ids.push_back(static_cast<int64_t>(i) + 1000);
+    }
+    documents.push_back(MultiVector{});
+    ids.push_back(1);
+
+    std::vector<float> scores = pgvector::max_sim(query, documents);
+    std::vector<Neighbor> neighbors = pgvector::rerank(query, ids, documents, 5, {.threads = 2});
+    assert_equal(neighbors.size(), 5u);
+    std::vector<float> sorted = scores;
+    std::ranges::sort(sorted, std::greater{});
+    for (size_t i = 0; i < 5; i++) {
+        assert_equal(neighbors[i].distance, -sorted[i]);
+        assert_equal(scores[static_cast<size_t>(neighbors[i].id - 1000)], sorted[i]);
+    }
+
+    // documents without tokens rank last
+    std::vector<Neighbor> all = pgvector::rerank(query, ids, documents, documents.size());
+    assert_equal(all.back().id, 1);
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::rerank(query, std::vector<int64_t>{1}, documents, 5); },
+        "ids and documents must be the same size"
+    );
+}
+} // namespace
+
+void test_multivec() {
+    test_multivector();
+    test_max_sim();
+    test_max_sim_empty();
+    test_max_sim_batch();
+    test_rerank();
+}
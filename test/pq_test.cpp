@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/distance.hpp>
+#include <pgvector/math.hpp>
+#include <pgvector/neighbor.hpp>
+#include <pgvector/pq.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::Metric;
+using pgvector::Neighbor;
+using pgvector::PqIndex;
+using pgvector::ProductQuantizer;
+using pgvector::TopK;
+using pgvector::Vector;
+using pgvector::VectorBatch;
+
+namespace {
+// vectors around a few clusters so codes are informative
+VectorBatch<float> random_data(size_t rows, size_t dimensions, uint64_t seed) {
+    std::mt19937_64 gen{seed};
+    std::normal_distribution<float> dist;
+    VectorBatch<float> centers{dimensions, 16};
+    for (size_t i = 0; i < centers.rows(); i++) {
+        for (auto& v : centers[i]) {
+            v = dist(gen);
+        }
+    }
+    VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows; i++) {
+        std::span<const float> center = centers[i % centers.rows()];
+        for (size_t j = 0; j < dimensions; j++) {
+            batch[i][j] = center[j] + 0.3f * dist(gen);
+        }
+    }
+    return batch;
+}
+
+std::vector<int64_t> sequence(size_t n) {
+    std::vector<int64_t> ids(n);
+    for (size_t i = 0; i < n; i++) {
+        ids[i] = static_cast<int64_t>(i);
+    }
+    return ids;
+}
+
+template<typename T>
+VectorBatch<T> head(const VectorBatch<T>& batch, size_t n) {
+    VectorBatch<T> result{batch.dimensions()};
+    for (size_t i = 0; i < n; i++) {
+        result.push_back(batch[i]);
+    }
+    return result;
+}
+
+// brute force over the codes with the quantizer
+std::vector<Neighbor> expected_neighbors(
+    const ProductQuantizer& quantizer,
+    const VectorBatch<uint8_t>& codes,
+    std::span<const float> query,
+    size_t k
+) {
+    TopK top{k};
+    for (size_t i = 0; i < codes.rows(); i++) {
+        top.push(static_cast<int64_t>(i), quantizer.distance(query, codes[i]));
+    }
+    return top.sorted();
+}
+
+void test_quantizer() {
+    VectorBatch<float> data = random_data(2000, 32, 1);
+    ProductQuantizer quantizer{32, {.subvectors = 8, .bits = 8}};
+    assert_equal(quantizer.trained(), false);
+    assert_equal(quantizer.code_size(), 8u);
+    quantizer.train(data);
+    assert_equal(quantizer.trained(), true);
+    assert_equal(quantizer.centroids().size(), 256u * 32);
+
+    // decoded vectors are close to the originals
+    Vector value{data[5]};
+    std::vector<uint8_t> code = quantizer.encode(value);
+    assert_equal(code.size(), 8u);
+    Vector decoded = quantizer.decode(code);
+    float error = pgvector::distance(Metric::L2, value, decoded);
+    assert_equal(error < 0.5f * pgvector::norm(value.values()), true);
+    assert_equal(std::fabs(quantizer.distance(value.values(), code) - error) < 1e-4f, true);
+
+    // batches match single vectors
+    VectorBatch<uint8_t> codes = quantizer.encode(data);
+    assert_equal(codes.dimensions(), 8u);
+    assert_equal(std::ranges::equal(codes[5], code), true);
+}
+
+void test_quantizer_4bit() {
+    VectorBatch<float> data = random_data(500, 30, 2);
+    ProductQuantizer quantizer{30, {.subvectors = 5, .bits = 4}};
+    assert_equal(quantizer.code_size(), 3u);
+    quantizer.train(data);
+
+    // low bits hold the first subvector in each byte, and the unused high bits are zero
+    std::vector<uint8_t> code = quantizer.encode(data[9]);
+    assert_equal(code[2] >> 4, 0);
+    Vector decoded = quantizer.decode(code);
+    for (size_t s = 0; s < 5; s++) {
+        size_t c = s % 2 == 0 ? code[s / 2] & 0x0f : code[s / 2] >> 4;
+        const float* centroid = quantizer.centroids().data() + (s * 16 + c) * 6;
+        assert_equal(decoded.values()[s * 6], centroid[0]);
+    }
+}
+
+void test_reproducible() {
+    VectorBatch<float> data = random_data(1000, 16, 3);
+    ProductQuantizer a{16, {.subvectors = 4, .bits = 4, .threads = 1, .seed = 7}};
+    ProductQuantizer b{16, {.subvectors = 4, .bits = 4, .threads = 3, .seed = 7}};
+    a.train(data);
+    b.train(data);
+    assert_equal(std::ranges::equal(a.centroids(), b.centroids()), true);
+
+    // stored centroids give the same codes
+    ProductQuantizer c{16, a.centroids(), {.subvectors = 4, .bits = 4}};
+    assert_equal(std::ranges::equal(c.encode(data[3]), a.encode(data[3])), true);
+}
+
+void test_index(Metric metric, size_t bits, size_t subvectors) {
+    VectorBatch<float> data = random_data(1000, 24, 4);
+    VectorBatch<float> queries = random_data(20, 24, 5);
+    ProductQuantizer quantizer{
+        24, {.metric = metric, .subvectors = subvectors, .bits = bits, .threads = 2}
+    };
+    quantizer.train(data);
+    VectorBatch<uint8_t> codes = quantizer.encode(data);
+
+    // ragged last block
+    size_t n = 1000 - 7;
+    PqIndex index{quantizer};
+    index.add(sequence(n), head(data, n));
+    assert_equal(index.size(), n);
+    VectorBatch<uint8_t> added = head(codes, n);
+
+    std::vector<std::vector<Neighbor>> results = index.search(queries, 10);
+    for (size_t i = 0; i < queries.rows(); i++) {
+        std::vector<Neighbor> expected = expected_neighbors(quantizer, added, queries[i], 10);
+        assert_equal(results[i] == expected, true);
+        assert_equal(index.search(queries[i], 10) == expected, true);
+    }
+}
+
+void test_index_metrics() {
+    for (size_t bits : {4, 8}) {
+        test_index(Metric::L2, bits, 8);
+        test_index(Metric::InnerProduct, bits, 6);
+        test_index(Metric::Cosine, bits, 3);
+    }
+}
+
+void test_add_code() {
+    VectorBatch<float> data = random_data(300, 8, 6);
+    ProductQuantizer quantizer{8, {.subvectors = 4, .bits = 4}};
+    quantizer.train(data);
+
+    PqIndex index{quantizer};
+    index.add(1, Vector{data[0]});
+    std::vector<uint8_t> code = quantizer.encode(data[1]);
+    index.add_code(2, code);
+    std::vector<std::byte> bytes(code.size());
+    std::ranges::transform(code, bytes.begin(), [](uint8_t v) { return std::byte{v}; });
+    index.add_code(3, bytes);
+
+    std::vector<Neighbor> neighbors = index.search(Vector{data[1]}, 3);
+    assert_equal(neighbors[0].id, 2);
+    assert_equal(neighbors[1].id, 3);
+    assert_equal(neighbors[0].distance, neighbors[1].distance);
+
+    assert_equal(index.search(Vector{data[1]}, 0).empty(), true);
+    assert_equal(index.search(head(data, 2), 0)[1].empty(), true);
+
+    assert_exception<std::invalid_argument>(
+        [&] { index.add_code(4, std::vector<uint8_t>{1}); }, "expected 2 bytes, not 1"
+    );
+}
+
+void test_invalid() {
+    assert_exception<std::invalid_argument>(
+        [] { ProductQuantizer(0); }, "dimensions must be greater than 0"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { ProductQuantizer(10, {.subvectors = 4}); },
+        "subvectors must divide the number of dimensions"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { ProductQuantizer(8, {.bits = 6}); }, "bits must be 4 or 8"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { ProductQuantizer(8, {.metric = Metric::L1}); },
+        "product quantization does not support L1 distance"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { ProductQuantizer(8, std::vector<float>(10)); }, "expected 2048 centroid values, not 10"
+    );
+
+    ProductQuantizer quantizer{8, {.subvectors = 2, .bits = 4}};
+    assert_exception<std::logic_error>(
+        [&] { quantizer.encode(std::vector<float>(8)); }, "product quantizer must be trained"
+    );
+    assert_exception<std::logic_error>(
+        [&] { PqIndex{quantizer}; }, "product quantizer must be trained"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { quantizer.train(random_data(10, 8, 7)); }, "expected at least 16 vectors, not 10"
+    );
+
+    quantizer.train(random_data(100, 8, 7));
+    assert_exception<std::invalid_argument>(
+        [&] { quantizer.encode(std::vector<float>(4)); }, "expected 8 dimensions, not 4"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { quantizer.decode(std::vector<uint8_t>(2)); }, "expected 1 bytes, not 2"
+    );
+    PqIndex index{quantizer};
+    assert_exception<std::invalid_argument>(
+        [&] { index.add(std::vector<int64_t>{1}, VectorBatch<float>{8}); },
+        "ids and values must be the same size"
+    );
+}
+} // namespace
+
+void test_pq() {
+    test_quantizer();
+    test_quantizer_4bit();
+    test_reproducible();
+    test_index_metrics();
+    test_add_code();
+    test_invalid();
+}
@@ -8,7 +8,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include <pgvector/fixed.hpp>
 #include <pgvector/halfvec.hpp>
+#include <pgvector/multivec.hpp>
 #include <pgvector/pqxx.hpp>
 #include <pgvector/sparsevec.hpp>
 #include <pgvector/vector.hpp>
@@ -22,7 +24,7 @@ void setup(pqxx::connection& conn) {
     tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
     tx.exec("DROP TABLE IF EXISTS items");
     tx.exec(
-        "CREATE TABLE items (id serial PRIMARY KEY, embedding vector(3), half_embedding halfvec(3), binary_embedding bit(3), sparse_embedding sparsevec(3))"
+        "CREATE TABLE items (id serial PRIMARY KEY, embedding vector(3), half_embedding halfvec(3), binary_embedding bit(3), sparse_embedding sparsevec(3), multi_embedding vector(3)[])"
     );
 }
 
@@ -132,6 +134,43 @@ void test_sparsevec_nnz(pqxx::connection& conn) {
     );
 }
 
+void test_fixed(pqxx::connection& conn) {
+    before_each(conn);
+
+    pqxx::nontransaction tx{conn};
+    pgvector::FixedVector<3> embedding{{1, 2, 3}};
+    pgvector::FixedHalfVector<3> half_embedding{{4, 5, 6}};
+    pgvector::FixedBitVector<3> binary_embedding{"101"};
+    tx.exec(
+        "INSERT INTO items (embedding, half_embedding, binary_embedding) VALUES ($1, $2, $3)",
+        {embedding, half_embedding, binary_embedding}
+    );
+
+    pqxx::result res = tx.exec("SELECT embedding, half_embedding, binary_embedding FROM items");
+    assert_equal(res.at(0).at(0).as<pgvector::FixedVector<3>>(), embedding);
+    assert_equal(res.at(0).at(1).as<pgvector::FixedHalfVector<3>>(), half_embedding);
+    assert_equal(res.at(0).at(2).as<pgvector::FixedBitVector<3>>(), binary_embedding);
+
+    assert_exception<pqxx::conversion_error>(
+        [&] { return res.at(0).at(0).as<pgvector::FixedVector<4>>(); },
+        "Expected 4 dimensions, not 3"
+    );
+}
+
+void test_multivector(pqxx::connection& conn) {
+    before_each(conn);
+
+    pqxx::nontransaction tx{conn};
+    std::vector<pgvector::Vector> tokens{pgvector::Vector{{1, 2, 3}}, pgvector::Vector{{4, 5, 6}}};
+    pgvector::MultiVector embedding{tokens};
+    tx.exec("INSERT INTO items (multi_embedding) VALUES ($1), ($2)", {embedding, std::nullopt});
+
+    pqxx::result res = tx.exec("SELECT multi_embedding FROM items ORDER BY id");
+    assert_equal(res.at(0).at(0).as<pgvector::MultiVector>(), embedding);
+    assert_equal(res.at(0).at(0).as<std::string>(), "{\"[1,2,3]\",\"[4,5,6]\"}");
+    assert_equal(res.at(1).at(0).as<std::optional<pgvector::MultiVector>>().has_value(), false);
+}
+
 void test_stream(pqxx::connection& conn) {
     before_each(conn);
 
@@ -156,10 +195,13 @@ void test_stream_to(pqxx::connection& conn) {
     pqxx::stream_to stream = pqxx::stream_to::table(tx, {"items"}, {"embedding"});
     stream.write_values(pgvector::Vector{{1, 2, 3}});
     stream.write_values(pgvector::Vector{{4, 5, 6}});
+    std::vector<float> values{7, 8, 9};
+    stream.write_values(pgvector::VectorView{values});
     stream.complete();
     pqxx::result res = tx.exec("SELECT embedding FROM items ORDER BY id");
     assert_equal(res.at(0).at(0).as<std::string>(), "[1,2,3]");
     assert_equal(res.at(1).at(0).as<std::string>(), "[4,5,6]");
+    assert_equal(res.at(2).at(0).as<std::string>(), "[7,8,9]");
 }
 
 void test_precision(pqxx::connection& conn) {
@@ -183,6 +225,19 @@ void test_vector_to_string() {
     );
 }
 
+void test_vector_view_to_string() {
+    std::vector<float> values{1, 2, 3};
+    pgvector::VectorView view{values};
+    assert_equal(pqxx::to_string(view), "[1,2,3]");
+    assert_equal(pqxx::size_buffer(view), 55u);
+
+    std::vector<float> large(16001);
+    assert_exception<pqxx::conversion_overrun>(
+        [&] { pqxx::to_string(pgvector::VectorView{large}); },
+        "vector cannot have more than 16000 dimensions"
+    );
+}
+
 void test_vector_from_string() {
     assert_equal(pqxx::from_string<pgvector::Vector>("[1,2,3]"), pgvector::Vector{{1, 2, 3}});
 
@@ -218,16 +273,64 @@ void test_vector_from_string() {
     );
 }
 
+void test_multivector_to_string() {
+    std::vector<pgvector::Vector> tokens{pgvector::Vector{{1, 2}}, pgvector::Vector{{3, 4}}};
+    assert_equal(pqxx::to_string(pgvector::MultiVector{tokens}), "{\"[1,2]\",\"[3,4]\"}");
+    assert_equal(pqxx::to_string(pgvector::MultiVector{}), "{}");
+
+    std::vector<pgvector::Vector> large{pgvector::Vector{std::vector<float>(16001)}};
+    assert_exception<pqxx::conversion_overrun>(
+        [&] { pqxx::to_string(pgvector::MultiVector{large}); },
+        "vector cannot have more than 16000 dimensions"
+    );
+}
+
+void test_multivector_from_string() {
+    std::vector<pgvector::Vector> tokens{pgvector::Vector{{1, 2}}, pgvector::Vector{{3, 4}}};
+    assert_equal(
+        pqxx::from_string<pgvector::MultiVector>("{\"[1,2]\",\"[3,4]\"}"),
+        pgvector::MultiVector{tokens}
+    );
+    assert_equal(pqxx::from_string<pgvector::MultiVector>("{}"), pgvector::MultiVector{});
+
+    // the server only quotes elements with commas
+    std::vector<pgvector::Vector> single{pgvector::Vector{{1}}, pgvector::Vector{{2}}};
+    assert_equal(
+        pqxx::from_string<pgvector::MultiVector>("{[1],[2]}"), pgvector::MultiVector{single}
+    );
+
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("[1,2]"); },
+        "Malformed vector[] literal"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("{\"[1,2]}"); },
+        "Malformed vector[] literal"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("{\"[1,2]\",}"); },
+        "Malformed vector[] literal"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("{\"1,2\"}"); },
+        "Malformed vector literal"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("{\"[1,2]\",NULL}"); },
+        "Unexpected null vector"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { auto _ = pqxx::from_string<pgvector::MultiVector>("{\"[1,2]\",\"[3,4,5]\"}"); },
+        "Expected 2 dimensions, not 3"
+    );
+}
+
 void test_halfvec_to_string() {
     assert_equal(pqxx::to_string(pgvector::HalfVector{{1, 2, 3}}), "[1,2,3]");
-#if __STDCPP_FLOAT16_T__ || defined(__FLT16_MAX__)
     assert_equal(
         pqxx::to_string(pgvector::HalfVector{{static_cast<pgvector::Half>(-1.234567890123f)}}),
         "[-1.234375]"
     );
-#else
-    assert_equal(pqxx::to_string(pgvector::HalfVector{{-1.234567890123f}}), "[-1.2345679]");
-#endif
 
     assert_exception<pqxx::conversion_overrun>(
         [] { pqxx::to_string(pgvector::HalfVector{std::vector<pgvector::Half>(16001)}); },
@@ -383,6 +486,52 @@ void test_sparsevec_from_string() {
     );
 }
 
+void test_fixed_to_string() {
+    assert_equal(pqxx::to_string(pgvector::FixedVector<3>{{1, 2, 3}}), "[1,2,3]");
+    assert_equal(pqxx::to_string(pgvector::FixedVector<1>{{-1.17549435e-38f}}), "[-1.1754944e-38]");
+    assert_equal(
+        pqxx::to_string(
+            pgvector::FixedHalfVector<2>{{1.5f, static_cast<pgvector::Half>(-1.234567890123f)}}
+        ),
+        "[1.5,-1.234375]"
+    );
+    assert_equal(pqxx::to_string(pgvector::FixedBitVector<4>{"1010"}), "1010");
+}
+
+void test_fixed_from_string() {
+    assert_equal(
+        pqxx::from_string<pgvector::FixedVector<3>>("[1,2,3]"), pgvector::FixedVector<3>{{1, 2, 3}}
+    );
+    assert_equal(
+        pqxx::from_string<pgvector::FixedHalfVector<3>>("[1,2,3]"),
+        pgvector::FixedHalfVector<3>{{1, 2, 3}}
+    );
+    assert_equal(
+        pqxx::from_string<pgvector::FixedBitVector<3>>("101"), pgvector::FixedBitVector<3>{"101"}
+    );
+
+    assert_exception<pqxx::conversion_error>(
+        [] { return pqxx::from_string<pgvector::FixedVector<3>>("[1,2]"); },
+        "Expected 3 dimensions, not 2"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { return pqxx::from_string<pgvector::FixedVector<3>>("[1,2,3,4]"); },
+        "Expected 3 dimensions, not 4"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { return pqxx::from_string<pgvector::FixedHalfVector<3>>("1,2,3"); },
+        "Malformed halfvec literal"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { return pqxx::from_string<pgvector::FixedBitVector<3>>("10"); },
+        "Expected 3 dimensions, not 2"
+    );
+    assert_exception<pqxx::conversion_error>(
+        [] { return pqxx::from_string<pgvector::FixedBitVector<3>>("102"); },
+        "Malformed bit literal"
+    );
+}
+
 void test_vector_to_buf() {
     std::array<char, 60> buf{};
     assert_equal(pqxx::to_buf(std::span<char>{buf}, pgvector::Vector{{1, 2, 3}}), "[1,2,3]");
@@ -465,9 +614,31 @@ void test_halfvec_size_buffer() {
     assert_equal(pqxx::size_buffer(pgvector::HalfVector{{1, 2, 3}}), 55u);
 }
 
+void test_multivector_size_buffer() {
+    std::vector<pgvector::Vector> tokens{pgvector::Vector{{1, 2, 3}}, pgvector::Vector{{4, 5, 6}}};
+    assert_equal(pqxx::size_buffer(pgvector::MultiVector{tokens}), 122u);
+}
+
 void test_sparsevec_size_buffer() {
     assert_equal(pqxx::size_buffer(pgvector::SparseVector{{1, 2, 3}}), 103u);
 }
+
+void test_fixed_size_buffer() {
+    using pqxx::string_traits;
+    static_assert(string_traits<pgvector::FixedVector<3>>::size_buffer({}) == 49);
+    static_assert(string_traits<pgvector::FixedHalfVector<3>>::size_buffer({}) == 49);
+    static_assert(string_traits<pgvector::FixedBitVector<3>>::size_buffer({}) == 3);
+
+    // the longest text for each element fills the buffer
+    std::array<char, 49> buf{};
+    pgvector::FixedVector<3> value{{-1.00058055e-36f, -1.00058055e-36f, -1.00058055e-36f}};
+    assert_equal(pqxx::to_buf(std::span<char>{buf}, value).size(), 49u);
+
+    assert_exception<pqxx::conversion_overrun>(
+        [] { return pqxx::to_buf(std::span<char>{}, pgvector::FixedVector<3>{}); },
+        "Not enough space in buffer for vector"
+    );
+}
 } // namespace
 
 void test_pqxx() {
@@ -479,16 +650,23 @@ void test_pqxx() {
     test_bit(conn);
     test_sparsevec(conn);
     test_sparsevec_nnz(conn);
+    test_fixed(conn);
+    test_multivector(conn);
     test_stream(conn);
     test_stream_to(conn);
     test_precision(conn);
 
     test_vector_to_string();
+    test_vector_view_to_string();
     test_vector_from_string();
+    test_multivector_to_string();
+    test_multivector_from_string();
     test_halfvec_to_string();
     test_halfvec_from_string();
     test_sparsevec_to_string();
     test_sparsevec_from_string();
+    test_fixed_to_string();
+    test_fixed_from_string();
 
     test_vector_to_buf();
     test_vector_into_buf();
@@ -499,5 +677,7 @@ void test_pqxx() {
 
     test_vector_size_buffer();
     test_halfvec_size_buffer();
+    test_multivector_size_buffer();
     test_sparsevec_size_buffer();
+    test_fixed_size_buffer();
 }
@@ -0,0 +1,76 @@
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/prune.hpp>
+#include <pgvector/sparsevec.hpp>
+
+#include "helper.hpp"
+
+using pgvector::Norm;
+using pgvector::SparseVector;
+
+namespace {
+SparseVector sparse(const std::vector<float>& values) {
+    return SparseVector{values};
+}
+
+void test_top_k() {
+    SparseVector vec = sparse({0.1f, 0, -4, 2, 0, 3, 0.5f});
+    assert_equal(pgvector::prune_top_k(vec, 2), sparse({0, 0, -4, 0, 0, 3, 0}));
+    assert_equal(pgvector::prune_top_k(vec, 3), sparse({0, 0, -4, 2, 0, 3, 0}));
+    assert_equal(pgvector::prune_top_k(vec, 5), vec);
+    assert_equal(pgvector::prune_top_k(vec, 10), vec);
+    assert_equal(pgvector::prune_top_k(vec, 0), sparse({0, 0, 0, 0, 0, 0, 0}));
+}
+
+void test_top_k_ties() {
+    SparseVector vec = sparse({1, 2, -1, 1, 2});
+    assert_equal(pgvector::prune_top_k(vec, 3), sparse({1, 2, 0, 0, 2}));
+    assert_equal(pgvector::prune_top_k(vec, 4), sparse({1, 2, -1, 0, 2}));
+}
+
+void test_top_k_nan() {
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    SparseVector vec = pgvector::prune_top_k(sparse({1, nan, 2}), 1);
+    assert_equal(vec.indices() == std::vector<int>{1}, true);
+}
+
+void test_mass() {
+    SparseVector vec = sparse({1, 0, 4, 2, 0, 3});
+    // total is 10
+    assert_equal(pgvector::prune_mass(vec, 0.4), sparse({0, 0, 4, 0, 0, 0}));
+    assert_equal(pgvector::prune_mass(vec, 0.5), sparse({0, 0, 4, 0, 0, 3}));
+    assert_equal(pgvector::prune_mass(vec, 0.9), sparse({0, 0, 4, 2, 0, 3}));
+    assert_equal(pgvector::prune_mass(vec, 1), vec);
+    assert_equal(pgvector::prune_mass(vec, 0), sparse({0, 0, 0, 0, 0, 0}));
+
+    // total is 30
+    assert_equal(pgvector::prune_mass(vec, 0.8, Norm::L2), sparse({0, 0, 4, 0, 0, 3}));
+    assert_equal(pgvector::prune_mass(vec, 0.9, Norm::L2), sparse({0, 0, 4, 2, 0, 3}));
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::prune_mass(vec, 1.5); }, "fraction must be between 0 and 1"
+    );
+}
+
+void test_threshold() {
+    SparseVector vec = sparse({0.1f, 0, -4, 2, 0, 3, 0.5f});
+    assert_equal(pgvector::prune_threshold(vec, 0.5f), sparse({0, 0, -4, 2, 0, 3, 0}));
+    assert_equal(pgvector::prune_threshold(vec, 0), vec);
+    assert_equal(pgvector::prune_threshold(vec, 10), sparse({0, 0, 0, 0, 0, 0, 0}));
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::prune_threshold(vec, -1); },
+        "threshold must be greater than or equal to 0"
+    );
+}
+} // namespace
+
+void test_prune() {
+    test_top_k();
+    test_top_k_ties();
+    test_top_k_nan();
+    test_mass();
+    test_threshold();
+}
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include <pgvector/batch.hpp>
+#include <pgvector/halfvec.hpp>
+#include <pgvector/math.hpp>
+#include <pgvector/reduce.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::HalfVector;
+using pgvector::Pca;
+using pgvector::Vector;
+using pgvector::VectorBatch;
+
+namespace {
+bool near(float a, float b, float tolerance) {
+    return std::fabs(a - b) <= tolerance;
+}
+
+// vectors with most variance along a few known directions
+VectorBatch<float> random_data(size_t rows, size_t dimensions, const std::vector<float>& scales) {
+    std::mt19937 gen{1};
+    std::normal_distribution<float> dist;
+    VectorBatch<float> batch{dimensions, rows};
+    for (size_t i = 0; i < rows; i++) {
+        std::span<float> row = batch[i];
+        for (size_t j = 0; j < dimensions; j++) {
+            row[j] = 0.01f * dist(gen) + 1;
+        }
+        for (size_t j = 0; j < scales.size(); j++) {
+            row[j * 3] += scales[j] * dist(gen);
+        }
+    }
+    return batch;
+}
+
+void test_truncate() {
+    Vector vec{{3, 4, 5, 6}};
+    assert_equal(pgvector::truncate(vec, 2), Vector{{0.6f, 0.8f}});
+    assert_equal(pgvector::truncate(vec, 2, {.normalize = false}), Vector{{3, 4}});
+    assert_equal(pgvector::truncate(vec, 4, {.normalize = false}), vec);
+
+    HalfVector half{{3, 4, 5}};
+    assert_equal(pgvector::truncate(half, 2, {.normalize = false}), HalfVector{{3, 4}});
+
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::truncate(vec, 5); }, "expected at least 5 dimensions, not 4"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { pgvector::truncate(vec, 0); }, "dimensions must be greater than 0"
+    );
+}
+
+void test_truncate_batch() {
+    VectorBatch<float> batch = random_data(3000, 64, {});
+    VectorBatch<float> result = pgvector::truncate(batch, 16, {.threads = 4});
+    assert_equal(result.dimensions(), 16u);
+    assert_equal(result.rows(), 3000u);
+    for (size_t i = 0; i < batch.rows(); i++) {
+        Vector expected = pgvector::truncate(Vector{batch[i]}, 16);
+        assert_equal(Vector{result[i]}, expected);
+    }
+}
+
+void test_pca() {
+    VectorBatch<float> data = random_data(2000, 20, {5, 3, 2});
+    Pca pca{data, 3};
+    assert_equal(pca.dimensions(), 20u);
+    assert_equal(pca.components().rows(), 3u);
+
+    // components are the directions with variance, largest first, and signed positive
+    for (size_t c = 0; c < 3; c++) {
+        std::span<const float> component = pca.components()[c];
+        assert_equal(near(component[c * 3], 1, 1e-3f), true);
+        assert_equal(near(pgvector::norm(component), 1, 1e-5f), true);
+    }
+    auto variance = pca.explained_variance();
+    assert_equal(near(variance[0], 25, 2), true);
+    assert_equal(near(variance[1], 9, 1), true);
+    assert_equal(near(variance[2], 4, 0.5f), true);
+    assert_equal(near(pca.mean()[1], 1, 1e-3f), true);
+
+    // projections have the variance of each component
+    VectorBatch<float> projected = pca.transform(data);
+    assert_equal(projected.dimensions(), 3u);
+    double sum = 0;
+    for (size_t i = 0; i < projected.rows(); i++) {
+        sum += projected[i][0] * projected[i][0];
+    }
+    assert_equal(near(static_cast<float>(sum / 1999), variance[0], 1e-2f), true);
+
+    Vector single = pca.transform(Vector{data[7]});
+    assert_equal(Vector{projected[7]}, single);
+}
+
+void test_pca_eigen() {
+    // the Householder and QL steps match a direct solution on a small matrix
+    VectorBatch<float> data{2};
+    data.push_back(std::vector<float>{1, 1});
+    data.push_back(std::vector<float>{-1, -1});
+    data.push_back(std::vector<float>{1, -1});
+    data.push_back(std::vector<float>{-1, 1});
+    data.push_back(std::vector<float>{2, 2});
+    data.push_back(std::vector<float>{-2, -2});
+    Pca pca{data, 2};
+    // covariance is [[12, 8], [8, 12]] / 5 with eigenvalues 4 and 0.8
+    assert_equal(near(pca.explained_variance()[0], 4, 1e-5f), true);
+    assert_equal(near(pca.explained_variance()[1], 0.8f, 1e-5f), true);
+    float r = std::sqrt(0.5f);
+    assert_equal(near(pca.components()[0][0], r, 1e-5f), true);
+    assert_equal(near(pca.components()[0][1], r, 1e-5f), true);
+    assert_equal(near(std::fabs(pca.components()[1][0]), r, 1e-5f), true);
+    assert_equal(near(pca.components()[1][0], -pca.components()[1][1], 1e-5f), true);
+}
+
+void test_pca_reproducible() {
+    VectorBatch<float> data = random_data(1500, 40, {4, 2});
+    Pca a{data, 5, {.threads = 1}};
+    Pca b{data, 5, {.threads = 3}};
+    assert_equal(std::ranges::equal(a.components()[4], b.components()[4]), true);
+    assert_equal(std::ranges::equal(a.explained_variance(), b.explained_variance()), true);
+
+    // stored components give the same projections
+    Pca c{a.components(), a.mean()};
+    assert_equal(c.explained_variance().empty(), true);
+    assert_equal(Vector{c.transform(data[3])}, Vector{a.transform(data[3])});
+}
+
+void test_pca_invalid() {
+    VectorBatch<float> data = random_data(10, 4, {});
+    assert_exception<std::invalid_argument>(
+        [&] { Pca(data, 0); }, "components must be greater than 0"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { Pca(data, 5); }, "components must be at most the number of dimensions"
+    );
+    assert_exception<std::invalid_argument>(
+        [] { Pca(VectorBatch<float>{4, 1}, 2); }, "expected at least 2 vectors"
+    );
+
+    Pca pca{data, 2};
+    assert_exception<std::invalid_argument>(
+        [&] { pca.transform(std::vector<float>{1, 2}); }, "expected 4 dimensions, not 2"
+    );
+    assert_exception<std::invalid_argument>(
+        [&] { Pca(pca.components(), std::vector<float>{1, 2}); }, "different vector dimensions"
+    );
+}
+} // namespace
+
+void test_reduce() {
+    test_truncate();
+    test_truncate_batch();
+    test_pca();
+    test_pca_eigen();
+    test_pca_reproducible();
+    test_pca_invalid();
+}
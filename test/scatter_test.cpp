@@ -0,0 +1,121 @@
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pgvector/neighbor.hpp>
+#include <pgvector/pqxx.hpp>
+#include <pgvector/scatter.hpp>
+#include <pgvector/vector.hpp>
+#include <pqxx/pqxx>
+
+#include "helper.hpp"
+
+using pgvector::Neighbor;
+using pgvector::ScatterGather;
+using pgvector::ScatterOptions;
+using pgvector::ShardStatus;
+
+namespace {
+// schemas on one server stand in for separate servers
+std::string shard(const std::string& schema) {
+    return "dbname=pgvector_cpp_test options=-csearch_path=" + schema;
+}
+
+void setup() {
+    pqxx::connection conn{"dbname=pgvector_cpp_test"};
+    pqxx::nontransaction tx{conn};
+    tx.exec("CREATE EXTENSION IF NOT EXISTS vector");
+    for (std::string schema : {"shard1", "shard2", "shard3"}) {
+        tx.exec("DROP SCHEMA IF EXISTS " + schema + " CASCADE");
+        tx.exec("CREATE SCHEMA " + schema);
+    }
+    tx.exec("CREATE TABLE shard1.items (id bigint, embedding vector(3))");
+    tx.exec("CREATE TABLE shard2.items (id bigint, embedding vector(3))");
+    tx.exec("INSERT INTO shard1.items VALUES (1, '[1,1,1]'), (3, '[3,3,3]'), (5, '[5,5,5]')");
+    tx.exec("INSERT INTO shard2.items VALUES (2, '[2,2,2]'), (4, '[4,4,4]'), (6, '[6,6,6]')");
+
+    // a shard that takes seconds to respond
+    tx.exec(
+        "CREATE FUNCTION shard3.slow() RETURNS boolean AS "
+        "'BEGIN PERFORM pg_sleep(2); RETURN true; END' LANGUAGE plpgsql"
+    );
+    tx.exec("CREATE VIEW shard3.items AS SELECT * FROM shard1.items WHERE shard3.slow()");
+}
+
+void test_search() {
+    ScatterGather search{{shard("shard1"), shard("shard2")}, "items"};
+    auto result = search.search(pgvector::Vector{{2, 2, 2}}, 3);
+    assert_equal(result.partial(), false);
+    assert_equal(result.neighbors.size(), 3u);
+    assert_equal(result.neighbors[0].id, 2);
+    assert_equal(result.neighbors[0].distance, 0.0f);
+    assert_equal(result.neighbors[1].distance, result.neighbors[2].distance);
+    assert_equal(result.neighbors[1].id, 1);
+    assert_equal(result.neighbors[2].id, 3);
+    assert_equal(result.shards.size(), 2u);
+    assert_equal(result.shards[0].neighbors.size(), 3u);
+    assert_equal(result.shards[1].neighbors[0].id, 2);
+
+    // connections are reused
+    result = search.search(pgvector::Vector{{6, 6, 6}}, 1);
+    assert_equal(result.neighbors.size(), 1u);
+    assert_equal(result.neighbors[0].id, 6);
+}
+
+void test_metric() {
+    ScatterGather search{
+        {shard("shard1"), shard("shard2")},
+        "items",
+        ScatterOptions{.metric = pgvector::Metric::InnerProduct}
+    };
+    auto result = search.search(pgvector::Vector{{1, 1, 1}}, 2);
+    assert_equal(result.neighbors[0], Neighbor{6, -18});
+    assert_equal(result.neighbors[1], Neighbor{5, -15});
+}
+
+void test_error() {
+    ScatterGather search{
+        {shard("shard1"), "dbname=pgvector_cpp_test port=1 connect_timeout=1"}, "items"
+    };
+    auto result = search.search(pgvector::Vector{{1, 1, 1}}, 2);
+    assert_equal(result.partial(), true);
+    assert_equal(result.shards[0].status == ShardStatus::Ok, true);
+    assert_equal(result.shards[1].status == ShardStatus::Error, true);
+    assert_equal(result.shards[1].error.empty(), false);
+    assert_equal(result.neighbors.size(), 2u);
+    assert_equal(result.neighbors[0].id, 1);
+}
+
+void test_timeout() {
+    ScatterGather search{
+        {shard("shard2"), shard("shard3")},
+        "items",
+        ScatterOptions{.timeout = std::chrono::milliseconds{500}}
+    };
+    auto start = std::chrono::steady_clock::now();
+    auto result = search.search(pgvector::Vector{{1, 1, 1}}, 2);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    assert_equal(elapsed < std::chrono::seconds{2}, true);
+    assert_equal(result.partial(), true);
+    assert_equal(result.shards[0].status == ShardStatus::Ok, true);
+    assert_equal(result.shards[1].status == ShardStatus::Timeout, true);
+    assert_equal(result.neighbors.size(), 2u);
+    assert_equal(result.neighbors[0].id, 2);
+}
+
+void test_shards() {
+    assert_exception<std::invalid_argument>(
+        [] { ScatterGather{{}, "items"}; }, "expected at least one shard"
+    );
+}
+} // namespace
+
+void test_scatter() {
+    setup();
+    test_search();
+    test_metric();
+    test_error();
+    test_timeout();
+    test_shards();
+}
@@ -1,3 +1,6 @@
+#include <cmath>
+#include <limits>
+#include <random>
 #include <span>
 #include <sstream>
 #include <stdexcept>
@@ -23,6 +26,51 @@ void test_constructor_span() {
     assert_equal(vec.dimensions(), 6);
 }
 
+void test_constructor_threshold() {
+    SparseVector vec{std::vector<float>{1, -0.1f, 2, 0.05f, -3, 0}, 0.1f};
+    assert_equal(vec.dimensions(), 6);
+    assert_equal(vec.indices() == std::vector<int>{0, 2, 4}, true);
+    assert_equal(vec.values() == std::vector<float>{1, 2, -3}, true);
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<float>{1}, -1}; },
+        "threshold must be greater than or equal to 0"
+    );
+}
+
+// covers the vectorized loops and remainders
+void test_constructor_large() {
+    std::mt19937 prng{1};
+    std::uniform_real_distribution<float> dist{-1, 1};
+    for (size_t n : {0, 7, 8, 15, 16, 17, 100, 30522}) {
+        std::vector<float> dense(n);
+        for (auto& v : dense) {
+            float r = dist(prng);
+            v = std::abs(r) < 0.9f ? 0 : r;
+        }
+        if (n > 10) {
+            dense[3] = -0.0f;
+            dense[9] = std::numeric_limits<float>::quiet_NaN();
+        }
+
+        for (float threshold : {0.0f, 0.95f}) {
+            SparseVector vec{dense, threshold};
+            std::vector<int> indices;
+            for (size_t i = 0; i < n; i++) {
+                if (!(std::abs(dense[i]) <= threshold)) {
+                    indices.push_back(static_cast<int>(i));
+                }
+            }
+            assert_equal(vec.indices() == indices, true);
+            assert_equal(vec.values().size(), indices.size());
+            for (size_t i = 0; i < indices.size(); i++) {
+                float expected = dense[static_cast<size_t>(indices[i])];
+                assert_equal(std::isnan(expected) || vec.values()[i] == expected, true);
+            }
+        }
+    }
+}
+
 void test_constructor_map() {
     std::unordered_map<int, float> map{{2, 2}, {4, 3}, {3, 0}, {0, 1}};
     SparseVector vec{map, 6};
@@ -43,6 +91,62 @@ void test_constructor_map() {
     );
 }
 
+void test_constructor_indices() {
+    std::vector<int> indices{0, 2, 3, 4};
+    std::vector<float> values{1, 2, 0, 3};
+    SparseVector vec{std::span<const int>{indices}, std::span<const float>{values}, 6};
+    assert_equal(vec.dimensions(), 6);
+    assert_equal(vec.indices() == std::vector<int>{0, 2, 4}, true);
+    assert_equal(vec.values() == std::vector<float>{1, 2, 3}, true);
+
+    SparseVector unsorted{std::vector<int>{4, 0, 2}, std::vector<float>{3, 1, 2}, 6};
+    assert_equal(unsorted, vec);
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{0, 2}, std::vector<float>{1}, 6}; },
+        "sparsevec indices and values must have the same size"
+    );
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{0, 6}, std::vector<float>{1, 2}, 6}; },
+        "sparsevec index out of bounds"
+    );
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{-1}, std::vector<float>{1}, 6}; },
+        "sparsevec index out of bounds"
+    );
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{1, 1}, std::vector<float>{1, 2}, 6}; },
+        "sparsevec cannot have duplicate indices"
+    );
+
+    // duplicates that are not adjacent until sorted, including zeros
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{3, 1, 3}, std::vector<float>{1, 2, 0}, 6}; },
+        "sparsevec cannot have duplicate indices"
+    );
+
+    assert_exception<std::invalid_argument>(
+        [] { SparseVector{std::vector<int>{}, std::vector<float>{}, -1}; },
+        "sparsevec cannot have negative dimensions"
+    );
+}
+
+void test_builder() {
+    pgvector::SparseVectorBuilder builder{6};
+    builder.reserve(3);
+    builder.push_back(0, 1);
+    builder.push_back(4, 3);
+    builder.push_back(2, 2);
+    SparseVector vec = builder.build();
+    assert_equal(vec, SparseVector{std::vector<float>{1, 0, 2, 0, 3, 0}});
+
+    // builder is cleared
+    assert_equal(builder.build(), SparseVector{std::vector<float>{0, 0, 0, 0, 0, 0}});
+}
+
 void test_constructor_empty() {
     SparseVector vec{std::vector<float>{}};
     assert_equal(vec.dimensions(), 0);
@@ -78,7 +182,11 @@ void test_sparsevec() {
     test_constructor_vector();
     test_constructor_span();
     test_constructor_empty();
+    test_constructor_threshold();
+    test_constructor_large();
     test_constructor_map();
+    test_constructor_indices();
+    test_builder();
     test_dimensions();
     test_indices();
     test_values();
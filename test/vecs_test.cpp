@@ -0,0 +1,112 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <pgvector/distance.hpp>
+#include <pgvector/vecs.hpp>
+#include <pgvector/vector.hpp>
+
+#include "helper.hpp"
+
+using pgvector::BvecsFile;
+using pgvector::FvecsFile;
+using pgvector::IvecsFile;
+
+namespace {
+template<typename T>
+void append_record(std::string& data, int32_t dimensions, const std::vector<T>& values) {
+    data.append(reinterpret_cast<const char*>(&dimensions), sizeof(dimensions));
+    data.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+std::string write_file(const std::string& name, const std::string& data) {
+    std::string path = "/tmp/pgvector_cpp_test_" + name;
+    std::ofstream file{path, std::ios::binary};
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return path;
+}
+
+void test_fvecs() {
+    std::string data;
+    append_record<float>(data, 3, {1, 2, 3});
+    append_record<float>(data, 3, {4, 5, 6});
+    FvecsFile file{write_file("test.fvecs", data)};
+    assert_equal(file.rows(), 2u);
+    assert_equal(file.dimensions(), 3u);
+    assert_equal(file.empty(), false);
+    assert_equal(pgvector::Vector{file[0]}, pgvector::Vector{{1, 2, 3}});
+    assert_equal(pgvector::Vector{file.row(1)}, pgvector::Vector{{4, 5, 6}});
+    assert_equal(pgvector::l2_distance(file[0], file[1]), 5.196152f);
+    assert_equal(pgvector::VectorView{file[1]}.dimensions(), 3u);
+
+    assert_exception<std::out_of_range>([&] { file.row(2); }, "record out of range");
+
+    FvecsFile moved{std::move(file)};
+    assert_equal(moved.rows(), 2u);
+    assert_equal(moved[1][2], 6.0f);
+}
+
+void test_bvecs() {
+    std::string data;
+    append_record<uint8_t>(data, 2, {1, 255});
+    BvecsFile file{write_file("test.bvecs", data), pgvector::VecsAccess::Random};
+    assert_equal(file.rows(), 1u);
+    assert_equal(static_cast<int>(file[0][1]), 255);
+}
+
+void test_ivecs() {
+    std::string data;
+    append_record<int32_t>(data, 2, {7, -1});
+    append_record<int32_t>(data, 2, {8, 9});
+    IvecsFile file{write_file("test.ivecs", data)};
+    assert_equal(file.rows(), 2u);
+    assert_equal(file[0][1], -1);
+    assert_equal(file[1][0], 8);
+}
+
+void test_empty() {
+    FvecsFile file{write_file("empty.fvecs", "")};
+    assert_equal(file.rows(), 0u);
+    assert_equal(file.empty(), true);
+}
+
+void test_invalid() {
+    std::string data;
+    append_record<float>(data, 3, {1, 2, 3});
+    std::string truncated = data.substr(0, data.size() - 1);
+    assert_exception<std::runtime_error>(
+        [&] { FvecsFile{write_file("truncated.fvecs", truncated)}; },
+        "invalid vecs file: truncated record"
+    );
+
+    std::string negative;
+    append_record<float>(negative, -1, {});
+    assert_exception<std::runtime_error>(
+        [&] { FvecsFile{write_file("negative.fvecs", negative)}; },
+        "invalid vecs file: dimensions must be greater than 0"
+    );
+
+    std::string inconsistent;
+    append_record<float>(inconsistent, 2, {1, 2});
+    append_record<float>(inconsistent, 1, {3, 4});
+    FvecsFile file{write_file("inconsistent.fvecs", inconsistent)};
+    assert_equal(file.rows(), 2u);
+    assert_exception<std::runtime_error>(
+        [&] { file.row(1); }, "invalid vecs file: record 1 has different dimensions"
+    );
+
+    assert_exception<std::runtime_error>([] { FvecsFile{"/tmp/pgvector_cpp_test_missing"}; });
+}
+} // namespace
+
+void test_vecs() {
+    test_fvecs();
+    test_bvecs();
+    test_ivecs();
+    test_empty();
+    test_invalid();
+}